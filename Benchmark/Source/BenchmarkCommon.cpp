@@ -0,0 +1,161 @@
+/*
+  ==============================================================================
+
+    BenchmarkCommon.cpp
+    Created: 20 Oct 2026 3:02:11am
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#include "BenchmarkCommon.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include "../../Source/RealtimeSafety.h"
+
+
+// a stage's allocation count is the difference between the counter before and after its
+// render loop; the bytes still allocated are kept too, so a structure's size is what it
+// leaves allocated once built. Where the realtime checker is compiled in, its malloc hooks
+// count every heap block, JUCE's HeapBlock, AudioBuffer and Array storage included;
+// elsewhere only operator new can be counted, which misses those
+#if JUCE_LINUX && (JUCE_DEBUG || DJ_REALTIME_CHECKS)
+ #define DJ_COUNT_MALLOC 1
+#else
+ #define DJ_COUNT_MALLOC 0
+#endif
+
+#if ! DJ_COUNT_MALLOC
+static std::atomic<juce::int64> allocationCount{ 0 };
+static std::atomic<juce::int64> allocatedBytes{ 0 };
+
+// each block is preceded by its size, in a header that keeps the block as aligned as malloc's
+static const std::size_t allocationHeader = alignof(std::max_align_t);
+
+void* operator new(std::size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (auto* block = static_cast<char*>(std::malloc(size + allocationHeader)))
+    {
+        *reinterpret_cast<std::size_t*>(block) = size;
+        allocatedBytes.fetch_add((juce::int64)size, std::memory_order_relaxed);
+        return block + allocationHeader;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    if (ptr != nullptr)
+    {
+        auto* block = static_cast<char*>(ptr) - allocationHeader;
+        allocatedBytes.fetch_sub((juce::int64)*reinterpret_cast<std::size_t*>(block), std::memory_order_relaxed);
+        std::free(block);
+    }
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    operator delete(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    operator delete(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+    operator delete(ptr);
+}
+#endif
+
+juce::int64 getAllocationCount()
+{
+   #if DJ_COUNT_MALLOC
+    return RealtimeSafety::getNumHeapAllocations();
+   #else
+    return allocationCount.load();
+   #endif
+}
+
+juce::int64 getAllocatedBytes()
+{
+   #if DJ_COUNT_MALLOC
+    return RealtimeSafety::getHeapBytesInUse();
+   #else
+    return allocatedBytes.load();
+   #endif
+}
+
+juce::String getAllocationCounting()
+{
+    return DJ_COUNT_MALLOC ? "malloc" : "operator new only, JUCE's malloc-based buffers are missed";
+}
+
+
+void measure(StageResult& result, double sampleRate, const std::function<juce::int64()>& work)
+{
+    const auto allocationsBefore = getAllocationCount();
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+
+    const juce::int64 samples = work();
+
+    result.cpuSeconds += juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+    result.allocations += getAllocationCount() - allocationsBefore;
+    result.audioSeconds += (double)samples / sampleRate;
+    ++result.runs;
+}
+
+void loadTrack(DJAudioPlayer& player, const juce::File& track)
+{
+    // the deck only opens MP3s through a seek index that's already built, so build it
+    // here rather than time the stages on an unindexed reader
+    if (track.hasFileExtension("mp3"))
+    {
+        Mp3SeekIndex::loadOrBuild(track);
+    }
+
+    // the deck keeps its last track when a load fails, so its length alone doesn't tell
+    const juce::URL url{ track };
+    player.loadURL(url);
+    if (player.getLoadedURL() != url || !(player.getLengthInSeconds() > 0))
+    {
+        std::cerr << "Can't load " << track.getFullPathName()
+                  << ", check this build has an MP3 decoder (JUCE_USE_MP3AUDIOFORMAT)" << std::endl;
+        std::exit(1);
+    }
+}
+
+void waitForDeviceCallback(double dueMs)
+{
+    while (juce::Time::getMillisecondCounterHiRes() < dueMs)
+    {
+        if (dueMs - juce::Time::getMillisecondCounterHiRes() > 1.5)
+        {
+            juce::Thread::sleep(1);
+        }
+        else
+        {
+            juce::Thread::yield();
+        }
+    }
+}
+
+juce::var latencyToJSON(double meanMs, double medianMs, double p99Ms, double maxMs)
+{
+    auto* object = new juce::DynamicObject();
+    object->setProperty("mean_ms", meanMs);
+    object->setProperty("median_ms", medianMs);
+    object->setProperty("p99_ms", p99Ms);
+    object->setProperty("max_ms", maxMs);
+    return juce::var(object);
+}
@@ -0,0 +1,72 @@
+/*
+  ==============================================================================
+
+    BenchmarkCommon.h
+    Created: 20 Oct 2026 3:02:11am
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <functional>
+#include "../../Source/DJAudioPlayer.h"
+
+
+/** Settings shared by every stage */
+struct BenchmarkSettings
+{
+    juce::Array<juce::File> tracks;
+    double sampleRate = 48000.0;
+    int blockSize = 256;
+    double secondsPerTrack = 10.0;
+};
+
+/** Measurements for one stage */
+struct StageResult
+{
+    juce::String name;
+    double audioSeconds = 0;
+    double cpuSeconds = 0;
+    juce::int64 allocations = 0;
+    int runs = 0;
+};
+
+
+/** @returns: heap allocations made so far */
+juce::int64 getAllocationCount();
+
+/** @returns: heap bytes allocated now */
+juce::int64 getAllocatedBytes();
+
+/** @returns: what the allocation figures in a report count, for whoever reads it */
+juce::String getAllocationCounting();
+
+/**
+ * Times a piece of work and counts its allocations into a result.
+ *
+ * @param result: where to add the measurements
+ * @param work: the work to measure, returns the number of samples it rendered
+ */
+void measure(StageResult& result, double sampleRate, const std::function<juce::int64()>& work);
+
+/**
+ * Loads a track into a deck, and gives up on the run if it didn't load: an empty deck
+ * renders silence faster than any track, which would pass for a result.
+ *
+ * @param player: the deck
+ * @param track: the file to load
+ */
+void loadTrack(DJAudioPlayer& player, const juce::File& track);
+
+/**
+ * Waits for the next callback of a device running at real-time pace.
+ *
+ * @param dueMs: when it's due, by Time::getMillisecondCounterHiRes()
+ */
+void waitForDeviceCallback(double dueMs);
+
+/** @returns: mean, median, 99th percentile and worst of a set of latencies as a JSON object */
+juce::var latencyToJSON(double meanMs, double medianMs, double p99Ms, double maxMs);
@@ -0,0 +1,191 @@
+/*
+  ==============================================================================
+
+    LibraryBenchmark.cpp
+    Created: 20 Oct 2026 3:27:39am
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#include "LibraryBenchmark.h"
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <vector>
+#include "BenchmarkCommon.h"
+#include "Song.h"
+#include "../../Source/TrackStore.h"
+
+
+// made-up tracks are spread like a real collection: a dozen per album, ten albums per artist
+static const int libraryTracksPerAlbum = 12;
+static const int libraryAlbumsPerArtist = 10;
+// every search is repeated to time it over more than one pass
+static const int librarySearchRuns = 20;
+
+/**
+ * Times a piece of work on a library.
+ *
+ * @param runs: how many times to do it
+ * @param work: the work, returning something derived from the library so it isn't optimised away
+ * @param check: set to what the work returned
+ * @returns: milliseconds per run
+ */
+static double timeLibraryWork(int runs, const std::function<juce::int64()>& work, juce::int64& check)
+{
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+    for (int run = 0; run < runs; ++run)
+    {
+        check = work();
+    }
+    return juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks) * 1000.0 / runs;
+}
+
+int runLibraryBenchmark(int numTracks)
+{
+    const auto root = juce::File::getSpecialLocation(juce::File::userMusicDirectory);
+    auto getTrack = [&root](int track)
+    {
+        const int album = track / libraryTracksPerAlbum;
+        return root.getChildFile("Artist " + juce::String(album / libraryAlbumsPerArtist))
+            .getChildFile("Album " + juce::String(album % libraryAlbumsPerArtist))
+            .getChildFile(juce::String(track % libraryTracksPerAlbum + 1).paddedLeft('0', 2)
+                + " Track " + juce::String(track) + " (Extended Mix).mp3");
+    };
+    auto getSeconds = [](int track)
+    {
+        return 150 + (track * 7919) % 360;
+    };
+    // the same queries for both: one that matches a single track, one every track and one none
+    const juce::StringArray queries{ "Track " + juce::String(numTracks / 2) + " ", "Extended", "No Such Track" };
+
+    auto makeStage = [numTracks](const juce::String& name, juce::int64 bytes, juce::int64 allocations,
+        double buildMs, double searchMs, double sortMs, double sumMs)
+    {
+        auto* object = new juce::DynamicObject();
+        object->setProperty("stage", name);
+        object->setProperty("tracks", numTracks);
+        object->setProperty("bytes_per_track", (double)bytes / numTracks);
+        object->setProperty("allocations_per_track", (double)allocations / numTracks);
+        object->setProperty("build_ms", buildMs);
+        object->setProperty("search_ms", searchMs);
+        object->setProperty("sort_by_name_ms", sortMs);
+        object->setProperty("sum_durations_ms", sumMs);
+        return juce::var(object);
+    };
+
+    juce::Array<juce::var> stages;
+    juce::int64 songsCheck[3] = {}, storeCheck[3] = {};
+
+    // the playlist as it was: a Song per track, with its duration as the text shown
+    {
+        const auto bytesBefore = getAllocatedBytes();
+        const auto allocationsBefore = getAllocationCount();
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+
+        std::vector<Song> songs;
+        for (int track = 0; track < numTracks; ++track)
+        {
+            Song song{ getTrack(track) };
+            const int seconds = getSeconds(track);
+            song.trackDuration = juce::String(seconds / 60) + ":" + juce::String(seconds % 60).paddedLeft('0', 2);
+            songs.push_back(song);
+        }
+
+        const double buildMs = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks) * 1000.0;
+        const auto bytes = getAllocatedBytes() - bytesBefore;
+        const auto allocations = getAllocationCount() - allocationsBefore;
+
+        const double searchMs = timeLibraryWork(librarySearchRuns, [&]
+        {
+            juce::int64 matches = 0;
+            for (const auto& query : queries)
+            {
+                for (const Song& song : songs)
+                {
+                    matches += song.songName.contains(query) ? 1 : 0;
+                }
+            }
+            return matches;
+        }, songsCheck[0]) / queries.size();
+        const double sortMs = timeLibraryWork(1, [&]
+        {
+            std::vector<int> rows((size_t)numTracks);
+            for (int row = 0; row < numTracks; ++row)
+            {
+                rows[(size_t)row] = row;
+            }
+            std::sort(rows.begin(), rows.end(), [&songs](int a, int b) { return songs[(size_t)a].songName < songs[(size_t)b].songName; });
+            return (juce::int64)rows.front();
+        }, songsCheck[1]);
+        const double sumMs = timeLibraryWork(librarySearchRuns, [&]
+        {
+            juce::int64 total = 0;
+            for (const Song& song : songs)
+            {
+                total += song.trackDuration.upToFirstOccurrenceOf(":", false, false).getIntValue() * 60
+                    + song.trackDuration.fromFirstOccurrenceOf(":", false, false).getIntValue();
+            }
+            return total;
+        }, songsCheck[2]);
+
+        stages.add(makeStage("library_songs", bytes, allocations, buildMs, searchMs, sortMs, sumMs));
+    }
+
+    // the playlist as it is now
+    {
+        const auto bytesBefore = getAllocatedBytes();
+        const auto allocationsBefore = getAllocationCount();
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+
+        TrackStore store;
+        for (int track = 0; track < numTracks; ++track)
+        {
+            store.add(getTrack(track), (float)getSeconds(track));
+        }
+
+        const double buildMs = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks) * 1000.0;
+        const auto bytes = getAllocatedBytes() - bytesBefore;
+        const auto allocations = getAllocationCount() - allocationsBefore;
+
+        const double searchMs = timeLibraryWork(librarySearchRuns, [&]
+        {
+            juce::int64 matches = 0;
+            for (const auto& query : queries)
+            {
+                for (int row = store.findName(query); row != -1; row = store.findName(query, row + 1))
+                {
+                    ++matches;
+                }
+            }
+            return matches;
+        }, storeCheck[0]) / queries.size();
+        const double sortMs = timeLibraryWork(1, [&]
+        {
+            return (juce::int64)store.getRowsSortedByName().front();
+        }, storeCheck[1]);
+        const double sumMs = timeLibraryWork(librarySearchRuns, [&]
+        {
+            juce::int64 total = 0;
+            for (int row = 0; row < store.size(); ++row)
+            {
+                total += (juce::int64)store.getDuration(row);
+            }
+            return total;
+        }, storeCheck[2]);
+
+        stages.add(makeStage("library_store", bytes, allocations, buildMs, searchMs, sortMs, sumMs));
+    }
+
+    // both must have found, sorted and added up the same
+    const bool matched = std::equal(std::begin(songsCheck), std::end(songsCheck), std::begin(storeCheck));
+
+    auto* report = new juce::DynamicObject();
+    report->setProperty("version", ProjectInfo::versionString);
+    report->setProperty("allocation_counting", getAllocationCounting());
+    report->setProperty("stages", stages);
+    report->setProperty("results_match", matched);
+    std::cout << juce::JSON::toString(juce::var(report)) << std::endl;
+    return matched ? 0 : 1;
+}
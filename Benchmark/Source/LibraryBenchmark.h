@@ -0,0 +1,23 @@
+/*
+  ==============================================================================
+
+    LibraryBenchmark.h
+    Created: 20 Oct 2026 3:27:39am
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+
+/**
+ * Builds a playlist of made-up tracks both ways and compares their memory and how fast
+ * they are to search, sort and add up. Nothing is read from disk.
+ *
+ * @param numTracks: tracks in the playlist
+ * @returns: the process exit code
+ */
+int runLibraryBenchmark(int numTracks);
@@ -0,0 +1,127 @@
+/*
+  ==============================================================================
+
+    Headless benchmark for the audio engine.
+
+    Renders the bundled tracks/ through the same DJAudioPlayer chain the app uses,
+    driven block by block as a null audio device would, and prints per-stage
+    timings as JSON so results can be compared between builds.
+
+    DJBenchmark [--tracks <dir>] [--sample-rate <hz>] [--block-size <samples>]
+                [--seconds <per track>] [--output <file.json>]
+
+    DJBenchmark --rt-check [--tracks <dir>] [--sample-rate <hz>] [--block-size <samples>]
+        plays both decks in real time through load, seek, speed and effect changes
+        and fails if the audio path allocated, waited on a lock or blocked; needs the
+        checker, which only the Debug and Checked configurations build in on Linux.
+        Release leaves it out, as its malloc hooks would slow every stage down
+
+    DJBenchmark --paint [--frames <count>]
+        paints the eight deck knobs frame after frame, the way both decks show them,
+        and prints the cost per frame with the knob frames scaled on every paint and
+        with them cached at the screen's pixel size
+
+    DJBenchmark --midi [--messages <count>] [--sample-rate <hz>] [--block-size <samples>]
+        moves a deck's pitch fader and presses its play button from a virtual MIDI
+        port, or straight into the controller where the platform has no virtual ports,
+        with the decks rendering at device pace, and prints how long each move and
+        press took to reach the deck, play through the app's 60 Hz dispatch
+
+    DJBenchmark --library [--count <tracks>]
+        builds a playlist of made-up tracks as a std::vector<Song> and as a TrackStore,
+        and prints the heap memory each takes per track and how long searching it,
+        sorting it by name and adding up its durations take; the memory is only
+        comparable where allocation_counting is malloc (Debug or Checked on Linux),
+        as operator new alone misses the TrackStore's StringArray and HashMap but
+        not the Song vector
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <iostream>
+#include "BenchmarkCommon.h"
+#include "LibraryBenchmark.h"
+#include "MidiLatencyHarness.h"
+#include "PaintBenchmark.h"
+#include "RealtimeCheck.h"
+#include "StageBenchmark.h"
+
+
+/** @returns: the value after an option, or the default if the option isn't there */
+static juce::String getOption(const juce::StringArray& args, const juce::String& option, const juce::String& defaultValue)
+{
+    const int index = args.indexOf(option);
+    return (index >= 0 && index + 1 < args.size()) ? args[index + 1] : defaultValue;
+}
+
+/** @returns: the tracks/ folder of the repository, looked for upwards from the working directory */
+static juce::File findTracksFolder()
+{
+    auto folder = juce::File::getCurrentWorkingDirectory();
+    for (int depth = 0; depth < 6; ++depth)
+    {
+        if (folder.getChildFile("tracks").isDirectory())
+        {
+            return folder.getChildFile("tracks");
+        }
+        folder = folder.getParentDirectory();
+    }
+    return {};
+}
+
+
+int main (int argc, char* argv[])
+{
+    juce::StringArray args;
+    for (int i = 1; i < argc; ++i)
+    {
+        args.add(argv[i]);
+    }
+
+    if (args.contains("--paint"))
+    {
+        return runPaintBenchmark(juce::jmax(1, getOption(args, "--frames", "600").getIntValue()));
+    }
+
+    if (args.contains("--library"))
+    {
+        return runLibraryBenchmark(juce::jmax(1, getOption(args, "--count", "100000").getIntValue()));
+    }
+
+    BenchmarkSettings settings;
+    settings.sampleRate = getOption(args, "--sample-rate", "48000").getDoubleValue();
+    settings.blockSize = getOption(args, "--block-size", "256").getIntValue();
+    settings.secondsPerTrack = getOption(args, "--seconds", "10").getDoubleValue();
+
+    if (args.contains("--midi") && settings.blockSize > 0 && settings.sampleRate > 0)
+    {
+        // the moves are told apart by fader position, so there can be as many as it has
+        return runMidiLatencyHarness(settings, juce::jlimit(1, 16384, getOption(args, "--messages", "2000").getIntValue()));
+    }
+
+    const auto tracksOption = getOption(args, "--tracks", {});
+    auto tracksFolder = tracksOption.isNotEmpty()
+        ? juce::File::getCurrentWorkingDirectory().getChildFile(tracksOption)
+        : findTracksFolder();
+    settings.tracks = tracksFolder.findChildFiles(juce::File::findFiles, false, "*.mp3");
+    settings.tracks.sort();
+
+    if (settings.tracks.isEmpty() || settings.blockSize <= 0 || settings.sampleRate <= 0)
+    {
+        std::cerr << "No tracks found, pass --tracks <dir>" << std::endl;
+        return 1;
+    }
+
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    if (args.contains("--rt-check"))
+    {
+        return runRealtimeCheck(formatManager, settings);
+    }
+
+    const auto outputOption = getOption(args, "--output", {});
+    return runStageBenchmark(formatManager, settings,
+        outputOption.isNotEmpty() ? juce::File::getCurrentWorkingDirectory().getChildFile(outputOption) : juce::File());
+}
@@ -0,0 +1,208 @@
+/*
+  ==============================================================================
+
+    MidiLatencyHarness.cpp
+    Created: 20 Oct 2026 3:18:52am
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#include "MidiLatencyHarness.h"
+#include <functional>
+#include <iostream>
+#include <vector>
+#include "../../Source/DeckRenderPool.h"
+#include "../../Source/MidiController.h"
+#include "../../Source/RealtimeSafety.h"
+
+
+// fader moves between presses of play, which takes effect on the message thread
+static const int midiMovesPerPlayPress = 50;
+
+/**
+ * Moves a pitch fader from its own thread, numbering each move by where it puts the fader,
+ * and presses and lets go of play every so often.
+ */
+class MidiFaderSender : public juce::Thread
+{
+public:
+    MidiFaderSender(int _numMessages, std::function<void(const juce::MidiMessage&)> _send)
+        : juce::Thread("MIDI sender"),
+          numMessages(_numMessages),
+          sentMs((size_t)_numMessages, 0.0),
+          playSentMs((size_t)getNumPlayMessages(_numMessages), 0.0),
+          send(std::move(_send))
+    {
+    }
+
+    /** @returns: how many play notes, on and off, go with a number of fader moves */
+    static int getNumPlayMessages(int numMoves)
+    {
+        return 2 * (numMoves / midiMovesPerPlayPress);
+    }
+
+    void run() override
+    {
+        juce::Random random(1234);
+        size_t playNote = 0;
+        for (int index = 0; index < numMessages && !threadShouldExit(); ++index)
+        {
+            sentMs[(size_t)index] = juce::Time::getMillisecondCounterHiRes();
+            send(juce::MidiMessage::pitchWheel(1, index));
+
+            // deck 1's play button, in the default mappings
+            if ((index + 1) % midiMovesPerPlayPress == 0)
+            {
+                playSentMs[playNote++] = juce::Time::getMillisecondCounterHiRes();
+                send(juce::MidiMessage::noteOn(1, 11, 1.0f));
+                playSentMs[playNote++] = juce::Time::getMillisecondCounterHiRes();
+                send(juce::MidiMessage::noteOff(1, 11));
+            }
+
+            // a hand on a fader sends a move every few milliseconds
+            juce::Thread::sleep(2 + random.nextInt(5));
+        }
+    }
+
+    const int numMessages;
+    std::vector<double> sentMs;       // when each move was sent, by its fader position
+    std::vector<double> playSentMs;   // when each play note was sent, in order
+
+private:
+    std::function<void(const juce::MidiMessage&)> send;
+};
+
+int runMidiLatencyHarness(const BenchmarkSettings& settings, int numMessages)
+{
+    juce::AudioFormatManager formatManager;
+    DJAudioPlayer deck1(formatManager);
+    DJAudioPlayer deck2(formatManager);
+    DeckRenderPool renderer;
+    renderer.addDeck(&deck1);
+    renderer.addDeck(&deck2);
+    renderer.prepareToPlay(settings.blockSize, settings.sampleRate);
+
+    MidiController controller;
+    controller.addDeck(&deck1);
+    controller.addDeck(&deck2);
+    controller.setMappings(MidiController::getDefaultMappings());
+
+    // a virtual port where the platform makes them, read back by the controller as any input would be
+    std::unique_ptr<juce::MidiOutput> port = juce::MidiOutput::createNewDevice("DJBenchmark controller");
+    std::unique_ptr<juce::MidiInput> input;
+    if (port != nullptr)
+    {
+        for (auto& device : juce::MidiInput::getAvailableDevices())
+        {
+            if (device.name == port->getName())
+            {
+                input = juce::MidiInput::openDevice(device.identifier, &controller);
+                break;
+            }
+        }
+    }
+
+    std::function<void(const juce::MidiMessage&)> send;
+    if (input != nullptr)
+    {
+        input->start();
+        send = [&port](const juce::MidiMessage& message) { port->sendMessageNow(message); };
+    }
+    else
+    {
+        send = [&controller](const juce::MidiMessage& message)
+        {
+            auto stamped = message;
+            stamped.setTimeStamp(juce::Time::getMillisecondCounterHiRes() * 0.001);
+            controller.handleIncomingMidiMessage(nullptr, stamped);
+        };
+    }
+
+    MidiFaderSender sender(numMessages, send);
+    const int numPlayMessages = MidiFaderSender::getNumPlayMessages(numMessages);
+    juce::Array<double> sentToApplied;
+    juce::Array<double> playSentToApplied;
+    controller.onControlApplied = [&](const MidiController::ControlEvent& event)
+    {
+        const int index = juce::roundToInt(event.value * 16383.0);
+        if (event.control == DJAudioPlayer::speedControl && juce::isPositiveAndBelow(index, numMessages))
+        {
+            sentToApplied.add(event.appliedMs - sender.sentMs[(size_t)index]);
+        }
+        else if (event.control == DJAudioPlayer::playControl && playSentToApplied.size() < numPlayMessages)
+        {
+            playSentToApplied.add(event.appliedMs - sender.playSentMs[(size_t)playSentToApplied.size()]);
+        }
+    };
+
+    juce::AudioBuffer<float> buffer(2, settings.blockSize);
+    const double blockMs = 1000.0 * settings.blockSize / settings.sampleRate;
+    const double dispatchMs = 1000.0 / MidiController::dispatchHz;
+    const double startMs = juce::Time::getMillisecondCounterHiRes();
+    double nextDispatchMs = startMs + dispatchMs;
+    sender.startThread();
+
+    // until the sender is done and the last move has had time to come through
+    double drainedByMs = 0;
+    for (juce::int64 block = 0; drainedByMs == 0 || juce::Time::getMillisecondCounterHiRes() < drainedByMs; ++block)
+    {
+        {
+            RealtimeSafety::ScopedRealtimeSection realtime;
+            controller.processBlock();
+            renderer.renderAndMix(juce::AudioSourceChannelInfo(&buffer, 0, settings.blockSize));
+        }
+        if (juce::Time::getMillisecondCounterHiRes() >= nextDispatchMs)
+        {
+            controller.dispatchAppliedControls();
+            nextDispatchMs += dispatchMs;
+        }
+
+        if (drainedByMs == 0 && !sender.isThreadRunning())
+        {
+            drainedByMs = juce::Time::getMillisecondCounterHiRes() + 200.0;
+        }
+        waitForDeviceCallback(startMs + (double)(block + 1) * blockMs);
+    }
+
+    if (input != nullptr)
+    {
+        input->stop();
+    }
+    renderer.releaseResources();
+
+    controller.dispatchAppliedControls();
+
+    auto endToEnd = [](juce::Array<double>& latencies)
+    {
+        if (latencies.isEmpty())
+        {
+            return latencyToJSON(0, 0, 0, 0);
+        }
+        latencies.sort();
+        double total = 0;
+        for (auto latency : latencies)
+        {
+            total += latency;
+        }
+        auto at = [&latencies](double fraction) { return latencies[juce::jmin(latencies.size() - 1, (int)(fraction * latencies.size()))]; };
+        return latencyToJSON(total / latencies.size(), at(0.5), at(0.99), latencies.getLast());
+    };
+    const auto inputLatency = controller.getLatencyStatistics();
+
+    auto* report = new juce::DynamicObject();
+    report->setProperty("version", ProjectInfo::versionString);
+    report->setProperty("port", input != nullptr ? "virtual" : "direct");
+    report->setProperty("sample_rate", settings.sampleRate);
+    report->setProperty("block_size", settings.blockSize);
+    report->setProperty("block_ms", blockMs);
+    report->setProperty("messages", numMessages + numPlayMessages);
+    report->setProperty("applied", inputLatency.count);
+    report->setProperty("dropped", controller.getNumDroppedEvents());
+    report->setProperty("input_to_applied", latencyToJSON(inputLatency.meanMs, inputLatency.medianMs, inputLatency.p99Ms, inputLatency.maxMs));
+    report->setProperty("sent_to_applied", endToEnd(sentToApplied));
+    report->setProperty("play_sent_to_applied", endToEnd(playSentToApplied));
+    std::cout << juce::JSON::toString(juce::var(report)) << std::endl;
+
+    return inputLatency.count == numMessages + numPlayMessages ? 0 : 1;
+}
@@ -0,0 +1,28 @@
+/*
+  ==============================================================================
+
+    MidiLatencyHarness.h
+    Created: 20 Oct 2026 3:18:52am
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "BenchmarkCommon.h"
+
+
+/**
+ * Measures MIDI controller latency without hardware: a thread moves deck 1's pitch fader
+ * and presses its play button through a virtual MIDI port while both decks render at
+ * device pace, and every control is timed from being sent, and from the input stamping
+ * it, to taking effect. Applied controls are followed up at the app's timer rate, so play
+ * includes the wait for the message thread.
+ *
+ * @param settings: the device's sample rate and block size
+ * @param numMessages: fader moves to send
+ * @returns: the process exit code, 1 if moves were lost
+ */
+int runMidiLatencyHarness(const BenchmarkSettings& settings, int numMessages);
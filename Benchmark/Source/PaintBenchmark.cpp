@@ -0,0 +1,131 @@
+/*
+  ==============================================================================
+
+    PaintBenchmark.cpp
+    Created: 20 Oct 2026 3:23:07am
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#include "PaintBenchmark.h"
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include "BenchmarkCommon.h"
+#include "../../Source/KnobsLookAndFeel.h"
+
+
+// the knobs of both decks, four each, at about the size they are in the window
+static const int paintNumKnobs = 8;
+static const int paintKnobSize = 72;
+
+/**
+ * Paints the knobs of both decks, four each, moving every knob between frames.
+ *
+ * @param name: stage name in the output
+ * @param scale: physical pixels per logical pixel, 2 for a high DPI screen
+ * @param paintKnob: draws one knob at x with a knob position from 0 to 1
+ * @returns: the stage's results as a JSON object
+ */
+static juce::var benchmarkKnobPaint(const juce::String& name, int numFrames, float scale,
+    const std::function<void(juce::Graphics&, int x, float position)>& paintKnob)
+{
+    juce::Image canvas(juce::Image::ARGB, juce::roundToInt(paintNumKnobs * paintKnobSize * scale), juce::roundToInt(paintKnobSize * scale), true);
+    juce::Graphics g(canvas);
+    g.addTransform(juce::AffineTransform::scale(scale));
+
+    auto paintFrame = [&](int frame)
+    {
+        g.fillAll(juce::Colours::black);
+        for (int knob = 0; knob < paintNumKnobs; ++knob)
+        {
+            paintKnob(g, knob * paintKnobSize, (float)((frame * 7 + knob * 13) % 100) / 99.0f);
+        }
+    };
+
+    // the first frame scales whatever it needs, so it's reported on its own
+    const auto firstStart = juce::Time::getHighResolutionTicks();
+    paintFrame(0);
+    const double firstFrameMs = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - firstStart) * 1000.0;
+
+    const auto allocationsBefore = getAllocationCount();
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+    for (int frame = 1; frame <= numFrames; ++frame)
+    {
+        paintFrame(frame);
+    }
+    const double seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+    const auto allocations = getAllocationCount() - allocationsBefore;
+
+    auto* object = new juce::DynamicObject();
+    object->setProperty("stage", name);
+    object->setProperty("frames", numFrames);
+    object->setProperty("knobs", paintNumKnobs);
+    object->setProperty("scale", scale);
+    object->setProperty("first_frame_ms", firstFrameMs);
+    object->setProperty("ms_per_frame", seconds * 1000.0 / numFrames);
+    object->setProperty("us_per_knob", seconds * 1.0e6 / ((double)numFrames * paintNumKnobs));
+    object->setProperty("allocations_per_frame", (double)allocations / numFrames);
+    return juce::var(object);
+}
+
+int runPaintBenchmark(int numFrames)
+{
+    // sliders need the default look and feel, which lives with the desktop
+    juce::ScopedJuceInitialiser_GUI gui;
+
+    // a stand-in for knob1.png, which only lives on the Desktop: 128 positions of 128 px
+    const int frameSize = 128;
+    const int numPositions = 128;
+    juce::Image filmstripImage(juce::Image::ARGB, frameSize, frameSize * numPositions, true);
+    {
+        juce::Graphics g(filmstripImage);
+        for (int position = 0; position < numPositions; ++position)
+        {
+            const auto frame = juce::Rectangle<float>(0.0f, (float)(position * frameSize), (float)frameSize, (float)frameSize).reduced(6.0f);
+            g.setGradientFill(juce::ColourGradient(juce::Colours::lightgrey, frame.getTopLeft(), juce::Colours::darkgrey, frame.getBottomRight(), false));
+            g.fillEllipse(frame);
+            const float angle = juce::jmap((float)position / (numPositions - 1), -2.4f, 2.4f);
+            g.setColour(juce::Colours::coral);
+            g.drawLine(juce::Line<float>(frame.getCentre(), frame.getCentre().getPointOnCircumference(frame.getWidth() * 0.4f, angle)), 6.0f);
+        }
+    }
+
+    KnobsLookAndFeel lookAndFeel;
+    juce::SharedResourcePointer<KnobFilmstrip> filmstrip;
+    filmstrip->setFilmstrip(filmstripImage);
+
+    juce::Slider slider(juce::Slider::Rotary, juce::Slider::NoTextBox);
+    slider.setRange(0.0, 1.0);
+    const auto rotary = slider.getRotaryParameters();
+
+    auto paintResampled = [&](juce::Graphics& g, int x, float position)
+    {
+        // what drawRotarySlider used to do: scale a frame out of the filmstrip every time
+        const int frameId = (int)std::ceil(position * (numPositions - 1));
+        g.drawImage(filmstripImage, x, 0, paintKnobSize, paintKnobSize, 0, frameId * frameSize, frameSize, frameSize);
+    };
+    auto paintCached = [&](juce::Graphics& g, int x, float position)
+    {
+        slider.setValue(position, juce::dontSendNotification);
+        lookAndFeel.drawRotarySlider(g, x, 0, paintKnobSize, paintKnobSize, (float)slider.valueToProportionOfLength(position),
+            rotary.startAngleRadians, rotary.endAngleRadians, slider);
+    };
+
+    juce::Array<juce::var> stages;
+    for (float scale : { 1.0f, 2.0f })
+    {
+        const auto suffix = "_x" + juce::String((int)scale);
+        stages.add(benchmarkKnobPaint("knobs_resampled" + suffix, numFrames, scale, paintResampled));
+        filmstrip->clearScaledFrames();
+        stages.add(benchmarkKnobPaint("knobs_cached" + suffix, numFrames, scale, paintCached));
+    }
+
+    auto* report = new juce::DynamicObject();
+    report->setProperty("version", ProjectInfo::versionString);
+    report->setProperty("allocation_counting", getAllocationCounting());
+    report->setProperty("stages", stages);
+    std::cout << juce::JSON::toString(juce::var(report)) << std::endl;
+    return 0;
+}
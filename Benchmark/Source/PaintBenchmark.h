@@ -0,0 +1,23 @@
+/*
+  ==============================================================================
+
+    PaintBenchmark.h
+    Created: 20 Oct 2026 3:23:07am
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+
+/**
+ * Measures knob painting, scaling the filmstrip on every paint as the knobs used to and
+ * through the shared cache of scaled frames, at normal and double pixel density.
+ *
+ * @param numFrames: frames to paint at each density
+ * @returns: the process exit code
+ */
+int runPaintBenchmark(int numFrames);
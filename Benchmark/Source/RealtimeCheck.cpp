@@ -0,0 +1,122 @@
+/*
+  ==============================================================================
+
+    RealtimeCheck.cpp
+    Created: 20 Oct 2026 3:14:28am
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#include "RealtimeCheck.h"
+#include <functional>
+#include <iostream>
+#include "../../Source/DeckRenderPool.h"
+#include "../../Source/MidiController.h"
+#include "../../Source/RealtimeSafety.h"
+
+
+int runRealtimeCheck(juce::AudioFormatManager& formatManager, const BenchmarkSettings& settings)
+{
+    if (!RealtimeSafety::isCheckerAvailable())
+    {
+        std::cerr << "The real-time safety checker isn't built in, use the Checked or Debug configuration on Linux" << std::endl;
+        return 2;
+    }
+
+    juce::TimeSliceThread readAheadThread("Deck read-ahead");
+    readAheadThread.startThread();
+
+    DJAudioPlayer deck1(formatManager, &readAheadThread);
+    DJAudioPlayer deck2(formatManager, &readAheadThread);
+    DeckRenderPool renderer;
+    renderer.addDeck(&deck1);
+    renderer.addDeck(&deck2);
+    renderer.prepareToPlay(settings.blockSize, settings.sampleRate);
+
+    // a controller too, its messages coming in between blocks as they would from a MIDI thread
+    MidiController controller;
+    controller.addDeck(&deck1);
+    controller.addDeck(&deck2);
+    controller.setMappings(MidiController::getDefaultMappings());
+    auto midi = [&controller](const juce::MidiMessage& message) { controller.handleIncomingMidiMessage(nullptr, message); };
+
+    auto track = [&settings](int index) { return settings.tracks[index % settings.tracks.size()]; };
+
+    // the set: second at which each change is made
+    struct Action
+    {
+        double time;
+        std::function<void()> apply;
+    };
+    const Action actions[] = {
+        { 0.0, [&] { loadTrack(deck1, track(0)); loadTrack(deck2, track(1)); deck1.start(); deck2.start(); } },
+        { 1.0, [&] { deck1.setSpeed(1.5); deck2.setSpeed(0.8); } },
+        { 2.0, [&] { deck1.setWetLevel(0.6f); deck2.setEffectEnabled(EffectsRack::echoEffect, true); } },
+        { 2.5, [&] { deck2.setEffectEnabled(EffectsRack::filterEffect, true); deck2.setEffectAmount(EffectsRack::filterEffect, 0.5f); } },
+        { 3.0, [&] { deck1.setPositionRelative(0.3); } },
+        { 3.5, [&] { deck2.setPosition(0.5); } },
+        { 4.0, [&] { renderer.setParallelRendering(true); } },
+        { 5.0, [&] { deck2.setFreeze(1.0f); deck1.setSpeed(DJAudioPlayer::maxSpeed); } },
+        { 6.0, [&] { deck1.stop(); deck2.setEffectEnabled(EffectsRack::flangerEffect, true); } },
+        { 7.0, [&] { deck1.start(); deck1.setSpeed(0.5); renderer.setParallelRendering(false); } },
+        { 7.5, [&] { loadTrack(deck2, track(2)); deck2.start(); } },
+        { 8.0, [&] { deck2.setPosition(juce::jmax(0.0, deck2.getLengthInSeconds() - 1.0)); } },
+        { 8.5, [&] { midi(juce::MidiMessage::noteOn(1, 54, 1.0f)); midi(juce::MidiMessage::controllerEvent(1, 22, 70));
+                     midi(juce::MidiMessage::pitchWheel(1, 12000)); midi(juce::MidiMessage::controllerEvent(1, 7, 90));
+                     midi(juce::MidiMessage::controllerEvent(1, 39, 20)); } },
+        { 9.0, [&] { midi(juce::MidiMessage::noteOff(1, 54)); midi(juce::MidiMessage::noteOn(2, 13, 1.0f)); } },
+        { 10.0, [&] { deck1.stop(); deck2.stop(); } }
+    };
+    const int numActions = juce::numElementsInArray(actions);
+    const double lengthSecs = 11.0;
+
+    juce::AudioBuffer<float> buffer(2, settings.blockSize);
+    const double blockMs = 1000.0 * settings.blockSize / settings.sampleRate;
+    const juce::int64 numBlocks = (juce::int64)(lengthSecs * settings.sampleRate / settings.blockSize);
+    const double startMs = juce::Time::getMillisecondCounterHiRes();
+    int nextAction = 0;
+
+    RealtimeSafety::clearViolations();
+    RealtimeSafety::setCheckingEnabled(true);
+
+    for (juce::int64 block = 0; block < numBlocks; ++block)
+    {
+        const double blockTime = (double)block * settings.blockSize / settings.sampleRate;
+        while (nextAction < numActions && actions[nextAction].time <= blockTime)
+        {
+            actions[nextAction++].apply();
+        }
+
+        {
+            RealtimeSafety::ScopedRealtimeSection realtime;
+            controller.processBlock();
+            renderer.renderAndMix(juce::AudioSourceChannelInfo(&buffer, 0, settings.blockSize));
+        }
+        controller.dispatchAppliedControls();
+
+        waitForDeviceCallback(startMs + (double)(block + 1) * blockMs);
+    }
+
+    RealtimeSafety::setCheckingEnabled(false);
+    renderer.setParallelRendering(false);
+    renderer.releaseResources();
+
+    auto* result = new juce::DynamicObject();
+    result->setProperty("blocks", numBlocks);
+    result->setProperty("allocations", RealtimeSafety::getNumViolations(RealtimeSafety::allocation));
+    result->setProperty("deallocations", RealtimeSafety::getNumViolations(RealtimeSafety::deallocation));
+    result->setProperty("contended_locks", RealtimeSafety::getNumViolations(RealtimeSafety::contendedLock));
+    result->setProperty("blocking_calls", RealtimeSafety::getNumViolations(RealtimeSafety::blockingCall));
+    result->setProperty("uncontended_locks", RealtimeSafety::getNumUncontendedLocks());
+    result->setProperty("decode_underruns", deck1.getNumDecodeUnderruns() + deck2.getNumDecodeUnderruns());
+    std::cout << juce::JSON::toString(juce::var(result)) << std::endl;
+
+    const auto violations = RealtimeSafety::getTotalViolations();
+    if (violations > 0)
+    {
+        std::cerr << RealtimeSafety::getReport() << std::endl;
+        return 1;
+    }
+    return 0;
+}
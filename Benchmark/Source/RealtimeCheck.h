@@ -0,0 +1,24 @@
+/*
+  ==============================================================================
+
+    RealtimeCheck.h
+    Created: 20 Oct 2026 3:14:28am
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "BenchmarkCommon.h"
+
+
+/**
+ * Plays both decks at device pace through a scripted set, the way the app drives them:
+ * control changes happen between blocks, rendering happens inside a realtime section with
+ * the real-time safety checker on, and the files are decoded by a read-ahead thread.
+ *
+ * @returns: the process exit code, 0 if nothing unsafe happened on the audio path
+ */
+int runRealtimeCheck(juce::AudioFormatManager& formatManager, const BenchmarkSettings& settings);
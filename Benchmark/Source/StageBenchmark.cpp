@@ -0,0 +1,266 @@
+/*
+  ==============================================================================
+
+    StageBenchmark.cpp
+    Created: 20 Oct 2026 3:09:45am
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#include "StageBenchmark.h"
+#include <functional>
+#include <iostream>
+#include "../../Source/DeckRenderPool.h"
+
+
+/**
+ * Pulls blocks from a source the way a null audio device would.
+ *
+ * @returns: the number of samples rendered
+ */
+static juce::int64 renderBlocks(juce::AudioSource& source, const BenchmarkSettings& settings)
+{
+    juce::AudioBuffer<float> buffer(2, settings.blockSize);
+    const juce::int64 total = (juce::int64)(settings.secondsPerTrack * settings.sampleRate);
+    juce::int64 rendered = 0;
+
+    while (rendered < total)
+    {
+        juce::AudioSourceChannelInfo info(&buffer, 0, settings.blockSize);
+        source.getNextAudioBlock(info);
+        rendered += settings.blockSize;
+    }
+    return rendered;
+}
+
+
+/** Creating a reader and setting the deck up for a track */
+static StageResult benchmarkLoad(juce::AudioFormatManager& formatManager, const BenchmarkSettings& settings)
+{
+    StageResult result;
+    result.name = "load";
+
+    DJAudioPlayer player(formatManager);
+    player.prepareToPlay(settings.blockSize, settings.sampleRate);
+    for (auto& track : settings.tracks)
+    {
+        measure(result, settings.sampleRate, [&]
+        {
+            loadTrack(player, track);
+            return (juce::int64)0;
+        });
+    }
+    player.releaseResources();
+    return result;
+}
+
+/** Jumping about a playing track, as the position slider and the skip buttons do */
+static StageResult benchmarkSeek(juce::AudioFormatManager& formatManager, const BenchmarkSettings& settings)
+{
+    const int seeksPerTrack = 32;
+
+    StageResult result;
+    result.name = "seek";
+    juce::Random random(1);
+
+    for (auto& track : settings.tracks)
+    {
+        DJAudioPlayer player(formatManager);
+        player.prepareToPlay(settings.blockSize, settings.sampleRate);
+        loadTrack(player, track);
+        player.start();
+
+        // each jump plays one block, so the time includes getting the first audio out
+        measure(result, settings.sampleRate, [&]
+        {
+            juce::AudioBuffer<float> buffer(2, settings.blockSize);
+            for (int seek = 0; seek < seeksPerTrack; ++seek)
+            {
+                player.setPosition(random.nextDouble() * player.getLengthInSeconds());
+                player.getNextAudioBlock(juce::AudioSourceChannelInfo(&buffer, 0, settings.blockSize));
+            }
+            return (juce::int64)seeksPerTrack * settings.blockSize;
+        });
+        player.releaseResources();
+    }
+    return result;
+}
+
+/** Decoding alone, straight from the reader */
+static StageResult benchmarkDecode(juce::AudioFormatManager& formatManager, const BenchmarkSettings& settings)
+{
+    StageResult result;
+    result.name = "decode";
+
+    for (auto& track : settings.tracks)
+    {
+        std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(track));
+        if (reader == nullptr)
+        {
+            continue;
+        }
+
+        juce::AudioBuffer<float> buffer((int)reader->numChannels, settings.blockSize);
+        const juce::int64 total = juce::jmin(reader->lengthInSamples,
+            (juce::int64)(settings.secondsPerTrack * reader->sampleRate));
+
+        StageResult fileResult;
+        measure(fileResult, reader->sampleRate, [&]
+        {
+            juce::int64 position = 0;
+            while (position < total)
+            {
+                reader->read(&buffer, 0, settings.blockSize, position, true, true);
+                position += settings.blockSize;
+            }
+            return position;
+        });
+
+        // decode time is reported against the file's own rate
+        result.audioSeconds += fileResult.audioSeconds;
+        result.cpuSeconds += fileResult.cpuSeconds;
+        result.allocations += fileResult.allocations;
+        ++result.runs;
+    }
+    return result;
+}
+
+/**
+ * The whole deck chain playing every track.
+ *
+ * @param name: stage name in the output
+ * @param configure: sets the deck up once it has started, so it can stop it again
+ */
+static StageResult benchmarkDeck(const juce::String& name,
+    juce::AudioFormatManager& formatManager,
+    const BenchmarkSettings& settings,
+    const std::function<void(DJAudioPlayer&)>& configure)
+{
+    StageResult result;
+    result.name = name;
+
+    for (auto& track : settings.tracks)
+    {
+        DJAudioPlayer player(formatManager);
+        player.prepareToPlay(settings.blockSize, settings.sampleRate);
+        loadTrack(player, track);
+        player.start();
+        configure(player);
+
+        measure(result, settings.sampleRate, [&] { return renderBlocks(player, settings); });
+        player.releaseResources();
+    }
+    return result;
+}
+
+/** Two decks playing at once, mixed by a DeckRenderPool */
+static StageResult benchmarkMix(const juce::String& name,
+    juce::AudioFormatManager& formatManager,
+    const BenchmarkSettings& settings,
+    bool parallel)
+{
+    StageResult result;
+    result.name = name;
+
+    for (int i = 0; i + 1 < settings.tracks.size(); i += 2)
+    {
+        DJAudioPlayer deck1(formatManager);
+        DJAudioPlayer deck2(formatManager);
+        DeckRenderPool renderer;
+        renderer.addDeck(&deck1);
+        renderer.addDeck(&deck2);
+        renderer.prepareToPlay(settings.blockSize, settings.sampleRate);
+        renderer.setParallelRendering(parallel);
+
+        loadTrack(deck1, settings.tracks[i]);
+        loadTrack(deck2, settings.tracks[i + 1]);
+        deck2.setSpeed(1.05);
+        deck1.setWetLevel(0.3f);
+        deck1.start();
+        deck2.start();
+
+        measure(result, settings.sampleRate, [&]
+        {
+            juce::AudioBuffer<float> buffer(2, settings.blockSize);
+            const juce::int64 total = (juce::int64)(settings.secondsPerTrack * settings.sampleRate);
+            juce::int64 rendered = 0;
+            while (rendered < total)
+            {
+                renderer.renderAndMix(juce::AudioSourceChannelInfo(&buffer, 0, settings.blockSize));
+                rendered += settings.blockSize;
+            }
+            return rendered;
+        });
+
+        renderer.setParallelRendering(false);
+        renderer.releaseResources();
+    }
+    return result;
+}
+
+
+/** @returns: a stage's results as a JSON object */
+static juce::var toJSON(const StageResult& result, double sampleRate)
+{
+    auto* object = new juce::DynamicObject();
+    const double samples = result.audioSeconds * sampleRate;
+
+    object->setProperty("stage", result.name);
+    object->setProperty("runs", result.runs);
+    object->setProperty("audio_seconds", result.audioSeconds);
+    object->setProperty("cpu_seconds", result.cpuSeconds);
+    object->setProperty("ns_per_sample", samples > 0 ? result.cpuSeconds * 1.0e9 / samples : 0.0);
+    object->setProperty("realtime_factor", result.cpuSeconds > 0 ? result.audioSeconds / result.cpuSeconds : 0.0);
+    object->setProperty("allocations", result.allocations);
+    return juce::var(object);
+}
+
+
+int runStageBenchmark(juce::AudioFormatManager& formatManager, const BenchmarkSettings& settings, const juce::File& outputFile)
+{
+    juce::Array<StageResult> results;
+    results.add(benchmarkLoad(formatManager, settings));
+    results.add(benchmarkDecode(formatManager, settings));
+    results.add(benchmarkSeek(formatManager, settings));
+
+    // the resampler runs on every deck, at every speed the knob allows
+    for (double ratio : { 0.5, 0.9, 1.0, 1.1, 2.0 })
+    {
+        results.add(benchmarkDeck("deck_dry_speed_" + juce::String(ratio, 2), formatManager, settings,
+            [ratio](DJAudioPlayer& player) { player.setWetLevel(0.0f); player.setSpeed(ratio); }));
+    }
+
+    results.add(benchmarkDeck("deck_reverb", formatManager, settings,
+        [](DJAudioPlayer& player) { player.setWetLevel(0.5f); }));
+    results.add(benchmarkDeck("deck_spectrum", formatManager, settings,
+        [](DJAudioPlayer& player) { player.setWetLevel(0.0f); player.getMeter().setSpectrumEnabled(true); }));
+    results.add(benchmarkDeck("deck_stopped", formatManager, settings,
+        [](DJAudioPlayer& player) { player.setWetLevel(0.5f); player.stop(); }));
+    results.add(benchmarkMix("mix_serial", formatManager, settings, false));
+    results.add(benchmarkMix("mix_parallel", formatManager, settings, true));
+
+    // machine readable report
+    auto* report = new juce::DynamicObject();
+    report->setProperty("version", ProjectInfo::versionString);
+    report->setProperty("sample_rate", settings.sampleRate);
+    report->setProperty("block_size", settings.blockSize);
+    report->setProperty("seconds_per_track", settings.secondsPerTrack);
+    report->setProperty("tracks", settings.tracks.size());
+    report->setProperty("allocation_counting", getAllocationCounting());
+
+    juce::Array<juce::var> stages;
+    for (auto& result : results)
+    {
+        stages.add(toJSON(result, settings.sampleRate));
+    }
+    report->setProperty("stages", stages);
+
+    const auto json = juce::JSON::toString(juce::var(report));
+    if (outputFile != juce::File())
+    {
+        outputFile.replaceWithText(json);
+    }
+    std::cout << json << std::endl;
+    return 0;
+}
@@ -0,0 +1,26 @@
+/*
+  ==============================================================================
+
+    StageBenchmark.h
+    Created: 20 Oct 2026 3:09:45am
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "BenchmarkCommon.h"
+
+
+/**
+ * Times each stage of the deck chain on the tracks, from loading and decoding to two
+ * decks mixed, and prints the results as JSON.
+ *
+ * @param formatManager: to read the tracks with
+ * @param settings: the tracks, and how to play them
+ * @param outputFile: where to save the JSON as well, or a default File not to
+ * @returns: the process exit code
+ */
+int runStageBenchmark(juce::AudioFormatManager& formatManager, const BenchmarkSettings& settings, const juce::File& outputFile);
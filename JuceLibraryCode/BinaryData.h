@@ -8,6 +8,15 @@
 
 namespace BinaryData
 {
+    extern const char*   forwardbutton_png;
+    const int            forwardbutton_pngSize = 12756;
+
+    extern const char*   playpause_png;
+    const int            playpause_pngSize = 17132;
+
+    extern const char*   rewind_png;
+    const int            rewind_pngSize = 12224;
+
     extern const char*   _01180813_1305_mp3;
     const int            _01180813_1305_mp3Size = 281486;
 
@@ -57,7 +66,7 @@ namespace BinaryData
     const int            twindrive_mp3Size = 10131600;
 
     // Number of elements in the namedResourceList and originalFileNames arrays.
-    const int namedResourceListSize = 16;
+    const int namedResourceListSize = 19;
 
     // Points to the start of a list of resource names.
     extern const char* namedResourceList[];
@@ -0,0 +1,177 @@
+/*
+  ==============================================================================
+
+    AdaptiveBufferSizer.cpp
+    Created: 19 Oct 2026 6:24:48pm
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#include "AdaptiveBufferSizer.h"
+
+
+AdaptiveBufferSizer::AdaptiveBufferSizer(AudioCallbackMonitor& _monitor, juce::AudioDeviceManager& _deviceManager)
+    : monitor(_monitor),
+      deviceManager(_deviceManager)
+{
+}
+
+AdaptiveBufferSizer::~AdaptiveBufferSizer()
+{
+    stopTimer();
+}
+
+void AdaptiveBufferSizer::setMode(Mode newMode)
+{
+    mode = newMode;
+    recommendedBufferSize = 0;
+    currentBufferSize = 0;
+
+    if (mode == off)
+    {
+        stopTimer();
+        status = "Off";
+    }
+    else
+    {
+        status = "Measuring...";
+        startTimer(1000);
+    }
+}
+
+AdaptiveBufferSizer::Mode AdaptiveBufferSizer::getMode() const
+{
+    return mode;
+}
+
+int AdaptiveBufferSizer::getRecommendedBufferSize() const
+{
+    return recommendedBufferSize;
+}
+
+juce::String AdaptiveBufferSizer::getStatus() const
+{
+    return status;
+}
+
+void AdaptiveBufferSizer::applyRecommendation()
+{
+    if (recommendedBufferSize <= 0)
+    {
+        return;
+    }
+
+    juce::AudioDeviceManager::AudioDeviceSetup setup;
+    deviceManager.getAudioDeviceSetup(setup);
+    setup.bufferSize = recommendedBufferSize;
+
+    const auto error = deviceManager.setAudioDeviceSetup(setup, true);
+    if (error.isNotEmpty())
+    {
+        DBG("Can't change the buffer size: " << error);
+        unstableSizes.addIfNotAlreadyThere(recommendedBufferSize);
+    }
+    recommendedBufferSize = 0;
+}
+
+void AdaptiveBufferSizer::timerCallback()
+{
+    auto* device = deviceManager.getCurrentAudioDevice();
+    if (device == nullptr || !device->isPlaying())
+    {
+        status = "No audio device";
+        return;
+    }
+
+    // a new device or size, whoever changed it: judge it from scratch
+    if (device->getCurrentBufferSizeSamples() != currentBufferSize)
+    {
+        restartMeasuring(*device);
+        return;
+    }
+
+    const auto snapshot = monitor.getSnapshot();
+    const int xRuns = device->getXRunCount() >= 0 ? device->getXRunCount() - xRunsAtStart : 0;
+    const double latencyMs = 1000.0 * currentBufferSize / device->getCurrentSampleRate();
+
+    // any dropout means this size is too small for this machine
+    if (snapshot.overruns > 0 || snapshot.lateCallbacks > 0 || xRuns > 0)
+    {
+        unstableSizes.addIfNotAlreadyThere(currentBufferSize);
+        recommendedBufferSize = findNeighbourSize(*device, true);
+        status = juce::String(currentBufferSize) + " samples dropped out";
+        if (recommendedBufferSize > 0)
+        {
+            status << ", try " << recommendedBufferSize;
+        }
+    }
+    else if (juce::Time::getMillisecondCounterHiRes() - measuringSince < measureSeconds * 1000.0)
+    {
+        status = juce::String(currentBufferSize) + " samples (" + juce::String(latencyMs, 1)
+            + " ms): measuring, peak load " + juce::String(juce::roundToInt(snapshot.peakLoad * 100.0)) + "%";
+        return;
+    }
+    else
+    {
+        // clean so far; is there room for the next size down?
+        const int smaller = findNeighbourSize(*device, false);
+        const double smallerPeriod = smaller / device->getCurrentSampleRate();
+        if (smaller > 0 && snapshot.peakCallbackSecs < headroom * smallerPeriod && snapshot.meanLoad < headroom)
+        {
+            recommendedBufferSize = smaller;
+            status = juce::String(currentBufferSize) + " samples is stable, try " + juce::String(smaller);
+        }
+        else
+        {
+            recommendedBufferSize = 0;
+            status = juce::String(currentBufferSize) + " samples (" + juce::String(latencyMs, 1)
+                + " ms) is the smallest stable size";
+        }
+    }
+
+    if (mode == automatic && recommendedBufferSize > 0)
+    {
+        applyRecommendation();
+    }
+}
+
+void AdaptiveBufferSizer::restartMeasuring(juce::AudioIODevice& device)
+{
+    currentBufferSize = device.getCurrentBufferSizeSamples();
+    xRunsAtStart = juce::jmax(0, device.getXRunCount());
+    measuringSince = juce::Time::getMillisecondCounterHiRes();
+    recommendedBufferSize = 0;
+    monitor.reset();
+    status = "Measuring " + juce::String(currentBufferSize) + " samples...";
+}
+
+int AdaptiveBufferSizer::findNeighbourSize(juce::AudioIODevice& device, bool larger) const
+{
+    auto sizes = device.getAvailableBufferSizes();
+    sizes.sort();
+
+    if (larger)
+    {
+        for (auto size : sizes)
+        {
+            if (size > currentBufferSize)
+            {
+                return size;
+            }
+        }
+    }
+    else
+    {
+        // only ever one step down; below a size that dropped out, nothing will be better
+        for (int i = sizes.size(); --i >= 0;)
+        {
+            const int size = sizes[i];
+            if (size < currentBufferSize)
+            {
+                return (size >= smallestBufferSize && !unstableSizes.contains(size)) ? size : 0;
+            }
+        }
+    }
+    return 0;
+}
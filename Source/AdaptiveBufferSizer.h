@@ -0,0 +1,92 @@
+/*
+  ==============================================================================
+
+    AdaptiveBufferSizer.h
+    Created: 19 Oct 2026 6:24:48pm
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include "AudioCallbackMonitor.h"
+
+
+/**
+ * Looks for the smallest buffer size the current device runs at without dropouts.
+ *
+ * Every few seconds it compares the callback timings from an AudioCallbackMonitor with
+ * the device's buffer sizes. A clean stretch with plenty of headroom suggests the next
+ * size down; any overrun, late callback or device xrun marks the size as unstable for
+ * the rest of the session and suggests the next size up. Depending on the mode the
+ * suggestion is only shown, or applied straight away.
+ */
+class AdaptiveBufferSizer : private juce::Timer
+{
+public:
+    enum Mode
+    {
+        off = 0,
+        recommend,
+        automatic
+    };
+
+    /**
+     * Constructor
+     *
+     * @param _monitor: the timings to judge the buffer size by
+     * @param _deviceManager: the device whose buffer size to change
+     */
+    AdaptiveBufferSizer(AudioCallbackMonitor& _monitor, juce::AudioDeviceManager& _deviceManager);
+
+    /** Destructor */
+    ~AdaptiveBufferSizer() override;
+
+    /**
+     * Sets what to do with the measurements. Message thread only.
+     *
+     * @param newMode: off, recommend a size, or switch to it automatically
+     */
+    void setMode(Mode newMode);
+
+    /** @returns: the current mode */
+    Mode getMode() const;
+
+    /** @returns: the buffer size worth switching to, or 0 if the current one is right */
+    int getRecommendedBufferSize() const;
+
+    /** @returns: a one-line description of what the sizer currently thinks */
+    juce::String getStatus() const;
+
+    /** Switches the device to the recommended buffer size, if there is one. */
+    void applyRecommendation();
+
+private:
+    // a size has to run cleanly this long before a smaller one is suggested
+    static constexpr double measureSeconds = 10.0;
+    // the slowest callback seen must fit in this share of the smaller size's period
+    static constexpr double headroom = 0.5;
+    static constexpr int smallestBufferSize = 32;
+
+    AudioCallbackMonitor& monitor;
+    juce::AudioDeviceManager& deviceManager;
+
+    Mode mode = off;
+    int currentBufferSize = 0;
+    int recommendedBufferSize = 0;
+    int xRunsAtStart = 0;
+    double measuringSince = 0;
+    juce::Array<int> unstableSizes;
+    juce::String status;
+
+    void timerCallback() override;
+
+    /** Starts a fresh measurement at the device's current size */
+    void restartMeasuring(juce::AudioIODevice& device);
+
+    /** @returns: the next size the device offers above or below the current one, or 0 */
+    int findNeighbourSize(juce::AudioIODevice& device, bool larger) const;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AdaptiveBufferSizer)
+};
@@ -0,0 +1,186 @@
+/*
+  ==============================================================================
+
+    AudioCallbackMonitor.cpp
+    Created: 19 Oct 2026 4:05:37pm
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#include "AudioCallbackMonitor.h"
+#include "RealtimeSafety.h"
+
+// a callback arriving this many buffer periods after the previous one means the device
+// ran dry in between, even if our own callbacks all finished in time
+static const double lateCallbackPeriods = 1.5;
+
+
+AudioCallbackMonitor::AudioCallbackMonitor()
+{
+    clearCounters();
+}
+
+void AudioCallbackMonitor::prepare(double sampleRate, int samplesPerBlockExpected)
+{
+    currentSampleRate = sampleRate;
+    bufferPeriod.store(sampleRate > 0 ? samplesPerBlockExpected / sampleRate : 0.0);
+    lastStartTicks = 0;
+    resetRequested.store(false);
+    clearCounters();
+}
+
+juce::int64 AudioCallbackMonitor::beginCallback()
+{
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+
+    if (resetRequested.exchange(false, std::memory_order_acquire))
+    {
+        clearCounters();
+        lastStartTicks = 0;
+    }
+
+    // gap since the previous callback started
+    if (lastStartTicks != 0 && currentSampleRate > 0)
+    {
+        const double interval = juce::Time::highResolutionTicksToSeconds(startTicks - lastStartTicks);
+        if (interval > lateCallbackPeriods * bufferPeriod.load(std::memory_order_relaxed))
+        {
+            lateCallbacks.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    lastStartTicks = startTicks;
+    return startTicks;
+}
+
+void AudioCallbackMonitor::endCallback(juce::int64 startTicks, int numSamples)
+{
+    if (currentSampleRate <= 0 || numSamples <= 0)
+    {
+        return;
+    }
+
+    const double elapsed = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+    const double period = numSamples / currentSampleRate;
+    const double load = elapsed / period;
+
+    // the device may call back with a different size than it promised
+    bufferPeriod.store(period, std::memory_order_relaxed);
+
+    callbacks.fetch_add(1, std::memory_order_relaxed);
+    lastLoad.store(load, std::memory_order_relaxed);
+    totalLoad.store(totalLoad.load(std::memory_order_relaxed) + load, std::memory_order_relaxed);
+    if (load > peakLoad.load(std::memory_order_relaxed))
+    {
+        peakLoad.store(load, std::memory_order_relaxed);
+    }
+    if (elapsed > peakCallbackSecs.load(std::memory_order_relaxed))
+    {
+        peakCallbackSecs.store(elapsed, std::memory_order_relaxed);
+    }
+    if (load > 1.0)
+    {
+        overruns.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    const int bucket = juce::jmin(numHistogramBuckets - 1, (int)(load / histogramBucketWidth));
+    histogram[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+void AudioCallbackMonitor::reset()
+{
+    resetRequested.store(true, std::memory_order_release);
+}
+
+AudioCallbackMonitor::Snapshot AudioCallbackMonitor::getSnapshot() const
+{
+    Snapshot snapshot;
+    snapshot.callbacks = callbacks.load();
+    snapshot.overruns = overruns.load();
+    snapshot.lateCallbacks = lateCallbacks.load();
+    snapshot.lastLoad = lastLoad.load();
+    snapshot.meanLoad = snapshot.callbacks > 0 ? totalLoad.load() / (double)snapshot.callbacks : 0.0;
+    snapshot.peakLoad = peakLoad.load();
+    snapshot.peakCallbackSecs = peakCallbackSecs.load();
+    snapshot.bufferPeriodSecs = bufferPeriod.load();
+
+    for (int i = 0; i < numHistogramBuckets; ++i)
+    {
+        snapshot.histogram[i] = histogram[i].load(std::memory_order_relaxed);
+    }
+    return snapshot;
+}
+
+bool AudioCallbackMonitor::writeReport(const juce::File& file, const juce::Array<DJAudioPlayer*>& decks,
+    juce::AudioIODevice* device) const
+{
+    const auto snapshot = getSnapshot();
+
+    auto* report = new juce::DynamicObject();
+    report->setProperty("time", juce::Time::getCurrentTime().toISO8601(true));
+    report->setProperty("sample_rate", currentSampleRate);
+    report->setProperty("buffer_period_ms", snapshot.bufferPeriodSecs * 1000.0);
+    report->setProperty("callbacks", snapshot.callbacks);
+    report->setProperty("overruns", snapshot.overruns);
+    report->setProperty("late_callbacks", snapshot.lateCallbacks);
+    report->setProperty("mean_load", snapshot.meanLoad);
+    report->setProperty("peak_load", snapshot.peakLoad);
+    report->setProperty("peak_callback_ms", snapshot.peakCallbackSecs * 1000.0);
+
+    if (device != nullptr)
+    {
+        report->setProperty("device", device->getName());
+        report->setProperty("device_buffer_size", device->getCurrentBufferSizeSamples());
+        report->setProperty("device_xruns", device->getXRunCount());
+    }
+
+    // bucket i holds callbacks that used between i and i+1 bucket widths of their period
+    juce::Array<juce::var> buckets;
+    for (auto count : snapshot.histogram)
+    {
+        buckets.add(count);
+    }
+    report->setProperty("load_histogram_bucket_width", histogramBucketWidth);
+    report->setProperty("load_histogram", buckets);
+
+    juce::Array<juce::var> deckReports;
+    for (auto* deck : decks)
+    {
+        auto* deckReport = new juce::DynamicObject();
+        for (int stage = 0; stage < DJAudioPlayer::numStages; ++stage)
+        {
+            const auto stats = deck->getStageStatistics((DJAudioPlayer::Stage)stage);
+            auto* stageReport = new juce::DynamicObject();
+            stageReport->setProperty("seconds", stats.secondsProcessing);
+            stageReport->setProperty("blocks_processed", stats.blocksProcessed);
+            stageReport->setProperty("blocks_skipped", stats.blocksSkipped);
+            deckReport->setProperty(stage == DJAudioPlayer::sourceStage ? "source" : "effects", juce::var(stageReport));
+        }
+        deckReport->setProperty("decode_underruns", deck->getNumDecodeUnderruns());
+        deckReports.add(juce::var(deckReport));
+    }
+    report->setProperty("decks", deckReports);
+
+    if (RealtimeSafety::isCheckerAvailable())
+    {
+        report->setProperty("realtime_violations", RealtimeSafety::getTotalViolations());
+        report->setProperty("realtime_report", RealtimeSafety::getReport());
+    }
+
+    return file.replaceWithText(juce::JSON::toString(juce::var(report)));
+}
+
+void AudioCallbackMonitor::clearCounters()
+{
+    callbacks.store(0, std::memory_order_relaxed);
+    overruns.store(0, std::memory_order_relaxed);
+    lateCallbacks.store(0, std::memory_order_relaxed);
+    lastLoad.store(0, std::memory_order_relaxed);
+    totalLoad.store(0, std::memory_order_relaxed);
+    peakLoad.store(0, std::memory_order_relaxed);
+    peakCallbackSecs.store(0, std::memory_order_relaxed);
+    for (auto& bucket : histogram)
+    {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,110 @@
+/*
+  ==============================================================================
+
+    AudioCallbackMonitor.h
+    Created: 19 Oct 2026 4:05:37pm
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <atomic>
+#include "DJAudioPlayer.h"
+
+
+/**
+ * Times every audio callback against its buffer period.
+ *
+ * The audio thread only adds to fixed arrays of atomic counters, so measuring costs two
+ * clock reads and a handful of relaxed stores per callback, with no allocation or locking.
+ * The message thread reads a snapshot whenever it likes, and can write everything out
+ * together with each deck's stage timings for looking at after a gig.
+ */
+class AudioCallbackMonitor
+{
+public:
+    // the load histogram covers 0-200% of the buffer period, anything slower goes in the last bucket
+    static constexpr int numHistogramBuckets = 41;
+    static constexpr double histogramBucketWidth = 0.05;
+
+    /** A consistent-enough copy of the counters, taken on the message thread */
+    struct Snapshot
+    {
+        juce::int64 callbacks = 0;
+        juce::int64 overruns = 0;       // callbacks that took longer than their buffer period
+        juce::int64 lateCallbacks = 0;  // callbacks that arrived well after the previous one was due
+        double lastLoad = 0;
+        double meanLoad = 0;
+        double peakLoad = 0;
+        double peakCallbackSecs = 0;
+        double bufferPeriodSecs = 0;
+        juce::int64 histogram[numHistogramBuckets] = {};
+    };
+
+    /** Constructor */
+    AudioCallbackMonitor();
+
+    /**
+     * Sets the device format and clears the counters. Called from prepareToPlay().
+     *
+     * @param sampleRate: the device sample rate
+     * @param samplesPerBlockExpected: the device block size
+     */
+    void prepare(double sampleRate, int samplesPerBlockExpected);
+
+    /**
+     * Marks the start of a callback. Audio thread only.
+     *
+     * @returns: the tick count to pass to endCallback()
+     */
+    juce::int64 beginCallback();
+
+    /**
+     * Marks the end of a callback and adds it to the counters. Audio thread only.
+     *
+     * @param startTicks: what beginCallback() returned
+     * @param numSamples: the number of samples the callback rendered
+     */
+    void endCallback(juce::int64 startTicks, int numSamples);
+
+    /** Asks the audio thread to clear the counters at its next callback. */
+    void reset();
+
+    /** @returns: a copy of the counters */
+    Snapshot getSnapshot() const;
+
+    /**
+     * Writes the counters, the device's own xrun count and every deck's stage timings to
+     * a JSON file.
+     *
+     * @param file: the file to write, overwritten if it exists
+     * @param decks: the decks whose stage timings to include
+     * @param device: the current audio device, or nullptr
+     * @returns: True if the file was written, else False
+     */
+    bool writeReport(const juce::File& file, const juce::Array<DJAudioPlayer*>& decks,
+        juce::AudioIODevice* device) const;
+
+private:
+    double currentSampleRate = 0;
+    std::atomic<double> bufferPeriod{ 0 };
+
+    std::atomic<bool> resetRequested{ false };
+    juce::int64 lastStartTicks = 0;
+
+    std::atomic<juce::int64> callbacks{ 0 };
+    std::atomic<juce::int64> overruns{ 0 };
+    std::atomic<juce::int64> lateCallbacks{ 0 };
+    std::atomic<double> lastLoad{ 0 };
+    std::atomic<double> totalLoad{ 0 };
+    std::atomic<double> peakLoad{ 0 };
+    std::atomic<double> peakCallbackSecs{ 0 };
+    std::atomic<juce::int64> histogram[numHistogramBuckets];
+
+    /** Zeroes the counters. Only called on the audio thread, or before the device starts. */
+    void clearCounters();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioCallbackMonitor)
+};
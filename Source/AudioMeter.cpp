@@ -0,0 +1,276 @@
+/*
+  ==============================================================================
+
+    AudioMeter.cpp
+    Created: 19 Oct 2026 7:41:26pm
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#include "AudioMeter.h"
+#include <cstring>
+
+// floor of the spectrum, anything quieter is drawn as nothing
+static const float spectrumFloorDb = -120.0f;
+
+const float AudioMeter::truePeakFilter[AudioMeter::numPhases][AudioMeter::numTaps] =
+{
+    {  0.0017089843750f,  0.0109863281250f, -0.0196533203125f,  0.0332031250000f, -0.0594482421875f,  0.1373291015625f,
+       0.9721679687500f, -0.1022949218750f,  0.0476074218750f, -0.0266113281250f,  0.0148925781250f, -0.0083007812500f },
+    { -0.0291748046875f,  0.0292968750000f, -0.0517578125000f,  0.0891113281250f, -0.1665039062500f,  0.4650878906250f,
+       0.7797851562500f, -0.2003173828125f,  0.1015625000000f, -0.0582275390625f,  0.0330810546875f, -0.0189208984375f },
+    { -0.0189208984375f,  0.0330810546875f, -0.0582275390625f,  0.1015625000000f, -0.2003173828125f,  0.7797851562500f,
+       0.4650878906250f, -0.1665039062500f,  0.0891113281250f, -0.0517578125000f,  0.0292968750000f, -0.0291748046875f },
+    { -0.0083007812500f,  0.0148925781250f, -0.0266113281250f,  0.0476074218750f, -0.1022949218750f,  0.9721679687500f,
+       0.1373291015625f, -0.0594482421875f,  0.0332031250000f, -0.0196533203125f,  0.0109863281250f,  0.0017089843750f }
+};
+
+
+AudioMeter::AudioMeter()
+{
+    fftInput.calloc(fftSize);
+    fftData.calloc(2 * fftSize);
+    std::fill(spectrumDecibels, spectrumDecibels + numSpectrumBins, spectrumFloorDb);
+}
+
+void AudioMeter::prepare(double _sampleRate, int _maxBlockSize)
+{
+    sampleRate = _sampleRate;
+    maxBlockSize = juce::jmax(1, _maxBlockSize);
+
+    oversamplerInput.setSize(numChannels, numTaps - 1 + maxBlockSize);
+    oversamplerInput.clear();
+    oversamplerOutput.calloc(maxBlockSize);
+
+    levels = {};
+    for (auto& value : meanSquare)
+    {
+        value = 0;
+    }
+    fftInputCount = 0;
+    std::fill(spectrumDecibels, spectrumDecibels + numSpectrumBins, spectrumFloorDb);
+}
+
+void AudioMeter::process(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    // blocks bigger than promised are measured in pieces rather than reallocating here
+    int done = 0;
+    while (done < numSamples && maxBlockSize > 0)
+    {
+        const int chunk = juce::jmin(numSamples - done, maxBlockSize);
+        processChunk(buffer, startSample + done, chunk);
+        done += chunk;
+    }
+}
+
+void AudioMeter::processChunk(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    const float rmsCoefficient = 1.0f - std::exp(-(float)(numSamples / sampleRate) / rmsWindowSecs);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        const float* samples = buffer.getReadPointer(juce::jmin(channel, buffer.getNumChannels() - 1), startSample);
+
+        const auto range = juce::FloatVectorOperations::findMinAndMax(samples, numSamples);
+        const float blockPeak = juce::jmax(-range.getStart(), range.getEnd());
+        levels.peak[channel] = juce::jmax(levels.peak[channel], blockPeak);
+
+        meanSquare[channel] += (sumOfSquares(samples, numSamples) / numSamples - meanSquare[channel]) * rmsCoefficient;
+        levels.rms[channel] = std::sqrt(meanSquare[channel]);
+
+        const float truePeak = juce::jmax(blockPeak, measureTruePeak(channel, samples, numSamples));
+        levels.truePeak[channel] = juce::jmax(levels.truePeak[channel], truePeak);
+        levels.maxTruePeak = juce::jmax(levels.maxTruePeak, truePeak);
+    }
+
+    if (spectrumEnabled.load(std::memory_order_relaxed))
+    {
+        pushSpectrumSamples(buffer.getReadPointer(0, startSample),
+            buffer.getReadPointer(juce::jmin(1, buffer.getNumChannels() - 1), startSample), numSamples);
+    }
+
+    publishLevels(numSamples);
+}
+
+void AudioMeter::processSilence(int numSamples)
+{
+    const float rmsCoefficient = 1.0f - std::exp(-(float)(numSamples / sampleRate) / rmsWindowSecs);
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        meanSquare[channel] -= meanSquare[channel] * rmsCoefficient;
+        levels.rms[channel] = std::sqrt(meanSquare[channel]);
+    }
+    // the oversampler would otherwise ring on with the last block's tail when sound resumes
+    oversamplerInput.clear();
+
+    if (spectrumEnabled.load(std::memory_order_relaxed))
+    {
+        pushSpectrumSamples(nullptr, nullptr, numSamples);
+    }
+
+    publishLevels(numSamples);
+}
+
+float AudioMeter::measureTruePeak(int channel, const float* samples, int numSamples)
+{
+    // the block goes after the history so each tap is just the input shifted back
+    float* input = oversamplerInput.getWritePointer(channel);
+    juce::FloatVectorOperations::copy(input + numTaps - 1, samples, numSamples);
+
+    float peak = 0;
+    for (int phase = 0; phase < numPhases; ++phase)
+    {
+        juce::FloatVectorOperations::clear(oversamplerOutput, numSamples);
+        for (int tap = 0; tap < numTaps; ++tap)
+        {
+            juce::FloatVectorOperations::addWithMultiply(oversamplerOutput.get(), input + numTaps - 1 - tap,
+                truePeakFilter[phase][tap], numSamples);
+        }
+        const auto range = juce::FloatVectorOperations::findMinAndMax(oversamplerOutput.get(), numSamples);
+        peak = juce::jmax(peak, -range.getStart(), range.getEnd());
+    }
+
+    // keep the end of this block as the history for the next
+    std::memmove(input, input + numSamples, sizeof(float) * (numTaps - 1));
+    return peak;
+}
+
+void AudioMeter::publishLevels(int numSamples)
+{
+    if (maxTruePeakResetPending.exchange(false, std::memory_order_relaxed))
+    {
+        levels.maxTruePeak = 0;
+    }
+
+    levelsBuffer.getWriteSlot() = levels;
+    levelsBuffer.publish();
+
+    // fall back ready for the next block, which holds whatever is louder
+    const float fall = juce::Decibels::decibelsToGain(-peakFallDbPerSec * (float)(numSamples / sampleRate));
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        levels.peak[channel] *= fall;
+        levels.truePeak[channel] *= fall;
+    }
+}
+
+void AudioMeter::pushSpectrumSamples(const float* left, const float* right, int numSamples)
+{
+    int done = 0;
+    while (done < numSamples)
+    {
+        const int count = juce::jmin(numSamples - done, fftSize - fftInputCount);
+        float* dest = fftInput + fftInputCount;
+
+        if (left != nullptr)
+        {
+            juce::FloatVectorOperations::copyWithMultiply(dest, left + done, 0.5f, count);
+            juce::FloatVectorOperations::addWithMultiply(dest, right + done, 0.5f, count);
+        }
+        else
+        {
+            juce::FloatVectorOperations::clear(dest, count);
+        }
+
+        fftInputCount += count;
+        done += count;
+
+        if (fftInputCount == fftSize)
+        {
+            computeSpectrum();
+
+            // windows overlap by half
+            juce::FloatVectorOperations::copy(fftInput.get(), fftInput + fftSize / 2, fftSize / 2);
+            fftInputCount = fftSize / 2;
+        }
+    }
+}
+
+void AudioMeter::computeSpectrum()
+{
+    juce::FloatVectorOperations::copy(fftData.get(), fftInput.get(), fftSize);
+    window.multiplyWithWindowingTable(fftData, (size_t)fftSize);
+    fft.performFrequencyOnlyForwardTransform(fftData, true);
+
+    // a full scale sine reads 0 dB: the Hann window halves the bin, the transform adds fftSize / 2
+    const float scale = 4.0f / fftSize;
+    const float fall = spectrumFallDbPerSec * (float)(fftSize / 2 / sampleRate);
+    for (int bin = 0; bin < numSpectrumBins; ++bin)
+    {
+        const float decibels = juce::Decibels::gainToDecibels(fftData[bin] * scale, spectrumFloorDb);
+        spectrumDecibels[bin] = juce::jmax(decibels, spectrumDecibels[bin] - fall);
+    }
+
+    auto& spectrum = spectrumBuffer.getWriteSlot();
+    juce::FloatVectorOperations::copy(spectrum.decibels, spectrumDecibels, numSpectrumBins);
+    spectrum.sampleRate = sampleRate;
+    spectrumBuffer.publish();
+}
+
+void AudioMeter::setSpectrumEnabled(bool shouldBeEnabled)
+{
+    spectrumEnabled.store(shouldBeEnabled, std::memory_order_relaxed);
+}
+
+bool AudioMeter::isSpectrumEnabled() const
+{
+    return spectrumEnabled.load(std::memory_order_relaxed);
+}
+
+void AudioMeter::resetMaxTruePeak()
+{
+    maxTruePeakResetPending.store(true, std::memory_order_relaxed);
+}
+
+bool AudioMeter::updateLevels()
+{
+    return levelsBuffer.update();
+}
+
+const AudioMeter::Levels& AudioMeter::getLevels() const
+{
+    return levelsBuffer.getReadSlot();
+}
+
+bool AudioMeter::updateSpectrum()
+{
+    return spectrumBuffer.update();
+}
+
+const AudioMeter::Spectrum& AudioMeter::getSpectrum() const
+{
+    return spectrumBuffer.getReadSlot();
+}
+
+float AudioMeter::sumOfSquares(const float* samples, int numSamples)
+{
+    float sum = 0;
+    int i = 0;
+
+   #if JUCE_USE_SIMD
+    using Register = juce::dsp::SIMDRegister<float>;
+    const int registerSize = (int)Register::size();
+
+    // scalar up to the first aligned sample, then whole registers
+    const float* aligned = Register::getNextSIMDAlignedPtr(const_cast<float*>(samples));
+    for (; i < numSamples && samples + i < aligned; ++i)
+    {
+        sum += samples[i] * samples[i];
+    }
+
+    auto accumulator = Register::expand(0.0f);
+    for (; i + registerSize <= numSamples; i += registerSize)
+    {
+        const auto values = Register::fromRawArray(samples + i);
+        accumulator += values * values;
+    }
+    sum += accumulator.sum();
+   #endif
+
+    for (; i < numSamples; ++i)
+    {
+        sum += samples[i] * samples[i];
+    }
+    return sum;
+}
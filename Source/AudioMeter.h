@@ -0,0 +1,219 @@
+/*
+  ==============================================================================
+
+    AudioMeter.h
+    Created: 19 Oct 2026 7:41:26pm
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <atomic>
+
+
+/**
+ * Hands the latest copy of a value from one writer thread to one reader thread without
+ * locking or waiting. The writer always has a slot of its own to fill, and publishing
+ * swaps it with the shared middle slot; the reader swaps the middle slot with its own
+ * whenever there is something new. Values the reader is too slow for are skipped.
+ */
+template <typename ValueType>
+class TripleBuffer
+{
+public:
+    /** @returns: the slot to fill before calling publish(). Writer only. */
+    ValueType& getWriteSlot()
+    {
+        return slots[writeIndex];
+    }
+
+    /** Makes the write slot the latest value. Writer only. */
+    void publish()
+    {
+        writeIndex = middle.exchange(writeIndex | freshFlag, std::memory_order_acq_rel) & indexMask;
+    }
+
+    /**
+     * Picks up the latest value, if one was published since the last call. Reader only.
+     *
+     * @returns: true if the read slot changed
+     */
+    bool update()
+    {
+        if ((middle.load(std::memory_order_relaxed) & freshFlag) == 0)
+        {
+            return false;
+        }
+        readIndex = middle.exchange(readIndex, std::memory_order_acq_rel) & indexMask;
+        return true;
+    }
+
+    /** @returns: the value picked up by the last update(). Reader only. */
+    const ValueType& getReadSlot() const
+    {
+        return slots[readIndex];
+    }
+
+private:
+    static constexpr int indexMask = 3;
+    static constexpr int freshFlag = 4;
+
+    ValueType slots[3] = {};
+    int writeIndex = 0;
+    int readIndex = 1;
+    std::atomic<int> middle{ 2 };
+};
+
+
+/**
+ * Measures a stereo signal for the meters: sample peak, RMS and true peak per channel,
+ * and optionally its spectrum.
+ *
+ * Everything is worked out on the audio thread with vectorised loops, as the block is
+ * produced, and handed to the UI through triple buffers. The peaks are held and fall
+ * back here too, so a display that only looks once a frame still sees every transient.
+ * True peak follows ITU-R BS.1770: the signal is oversampled four times with the
+ * polyphase filter from the standard and the peak taken from that.
+ */
+class AudioMeter
+{
+public:
+    static constexpr int numChannels = 2;
+    static constexpr int fftOrder = 11;
+    static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int numSpectrumBins = fftSize / 2;
+
+    /** Levels as linear gains, 1.0 being full scale */
+    struct Levels
+    {
+        float peak[numChannels] = {};     // held sample peak
+        float rms[numChannels] = {};      // RMS over rmsWindowSecs
+        float truePeak[numChannels] = {}; // held inter-sample peak
+        float maxTruePeak = 0;            // highest true peak since resetMaxTruePeak()
+    };
+
+    /** Magnitude spectrum of both channels summed to mono */
+    struct Spectrum
+    {
+        float decibels[numSpectrumBins] = {};
+        double sampleRate = 0;
+    };
+
+    /** Constructor */
+    AudioMeter();
+
+    /**
+     * Allocates the working buffers. Not called on the audio thread.
+     *
+     * @param sampleRate: the rate of the signal to meter
+     * @param maxBlockSize: the largest block process() is usually given
+     */
+    void prepare(double sampleRate, int maxBlockSize);
+
+    /**
+     * Measures a block. Audio thread only; the first two channels are metered and a
+     * mono buffer is metered on both.
+     *
+     * @param buffer: the signal
+     * @param startSample: first sample of the block in the buffer
+     * @param numSamples: length of the block
+     */
+    void process(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+
+    /**
+     * Lets the meters fall back over a block known to be silent, without measuring it.
+     *
+     * @param numSamples: length of the block
+     */
+    void processSilence(int numSamples);
+
+    /**
+     * Switches the spectrum analysis on or off. It costs an FFT every half window, so is
+     * off until something shows it.
+     *
+     * @param shouldBeEnabled: true to analyse the spectrum
+     */
+    void setSpectrumEnabled(bool shouldBeEnabled);
+
+    /** @returns: true if the spectrum is being analysed */
+    bool isSpectrumEnabled() const;
+
+    /** Clears the true peak clip indicator at the next block. */
+    void resetMaxTruePeak();
+
+    /**
+     * Picks up the latest levels. Only one thread, normally the message thread, may read them.
+     *
+     * @returns: true if they changed since the last call
+     */
+    bool updateLevels();
+
+    /** @returns: the levels picked up by the last updateLevels() */
+    const Levels& getLevels() const;
+
+    /**
+     * Picks up the latest spectrum. Only one thread may read it, which can be a different
+     * one from the levels reader.
+     *
+     * @returns: true if it changed since the last call
+     */
+    bool updateSpectrum();
+
+    /** @returns: the spectrum picked up by the last updateSpectrum() */
+    const Spectrum& getSpectrum() const;
+
+private:
+    // meter ballistics
+    static constexpr float peakFallDbPerSec = 20.0f;
+    static constexpr float rmsWindowSecs = 0.3f;
+    static constexpr float spectrumFallDbPerSec = 40.0f;
+
+    // BS.1770 4x oversampling filter, as four phases of twelve taps
+    static constexpr int numPhases = 4;
+    static constexpr int numTaps = 12;
+    static const float truePeakFilter[numPhases][numTaps];
+
+    double sampleRate = 44100.0;
+    int maxBlockSize = 0;
+
+    // audio thread state
+    Levels levels;
+    float meanSquare[numChannels] = {};
+    juce::AudioBuffer<float> oversamplerInput;  // numTaps - 1 samples of history, then the block
+    juce::HeapBlock<float> oversamplerOutput;
+
+    TripleBuffer<Levels> levelsBuffer;
+    std::atomic<bool> maxTruePeakResetPending{ false };
+
+    // spectrum
+    juce::dsp::FFT fft{ fftOrder };
+    juce::dsp::WindowingFunction<float> window{ (size_t)fftSize, juce::dsp::WindowingFunction<float>::hann };
+    juce::HeapBlock<float> fftInput;   // mono samples waiting for the next transform
+    juce::HeapBlock<float> fftData;    // 2 * fftSize, as the transform needs
+    int fftInputCount = 0;
+    float spectrumDecibels[numSpectrumBins];
+    std::atomic<bool> spectrumEnabled{ false };
+    TripleBuffer<Spectrum> spectrumBuffer;
+
+    /** Measures at most maxBlockSize samples */
+    void processChunk(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+
+    /** @returns: the largest magnitude of the oversampled signal, for one channel's chunk */
+    float measureTruePeak(int channel, const float* samples, int numSamples);
+
+    /** Lets the held peaks fall back by one block's worth and publishes the levels */
+    void publishLevels(int numSamples);
+
+    /** Adds mono samples to the FFT window, transforming and publishing whenever it fills up */
+    void pushSpectrumSamples(const float* left, const float* right, int numSamples);
+
+    /** Transforms the full window and publishes the result */
+    void computeSpectrum();
+
+    /** @returns: the sum of the squares of the samples, a register at a time where possible */
+    static float sumOfSquares(const float* samples, int numSamples);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioMeter)
+};
@@ -0,0 +1,119 @@
+/*
+  ==============================================================================
+
+    AudioSettingsPanel.cpp
+    Created: 19 Oct 2026 6:52:11pm
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#include "AudioSettingsPanel.h"
+
+
+AudioSettingsPanel::AudioSettingsPanel(juce::AudioDeviceManager& _deviceManager, AdaptiveBufferSizer& _bufferSizer)
+    : deviceManager(_deviceManager),
+      bufferSizer(_bufferSizer)
+{
+    addAndMakeVisible(deviceSelector);
+
+    addAndMakeVisible(adaptiveLabel);
+    addAndMakeVisible(adaptiveModeBox);
+    // item ids are the mode plus one, as combo box ids can't be 0
+    adaptiveModeBox.addItem("Off", AdaptiveBufferSizer::off + 1);
+    adaptiveModeBox.addItem("Recommend a size", AdaptiveBufferSizer::recommend + 1);
+    adaptiveModeBox.addItem("Switch automatically", AdaptiveBufferSizer::automatic + 1);
+    adaptiveModeBox.setSelectedId(bufferSizer.getMode() + 1, juce::dontSendNotification);
+    adaptiveModeBox.addListener(this);
+
+    addAndMakeVisible(applyButton);
+    applyButton.setColour(juce::TextButton::ColourIds::buttonColourId, juce::Colours::grey);
+    applyButton.addListener(this);
+
+    addAndMakeVisible(statusLabel);
+    addAndMakeVisible(latencyLabel);
+    addAndMakeVisible(cueOutputLabel);
+
+    setSize(500, 544);
+    timerCallback();
+    startTimer(500);
+}
+
+AudioSettingsPanel::~AudioSettingsPanel()
+{
+    stopTimer();
+}
+
+void AudioSettingsPanel::resized()
+{
+    auto area = getLocalBounds().reduced(10);
+
+    cueOutputLabel.setBounds(area.removeFromBottom(24));
+
+    auto latencyRow = area.removeFromBottom(24);
+    latencyLabel.setBounds(latencyRow);
+
+    auto statusRow = area.removeFromBottom(24);
+    applyButton.setBounds(statusRow.removeFromRight(70).reduced(0, 2));
+    statusLabel.setBounds(statusRow);
+
+    auto modeRow = area.removeFromBottom(28);
+    adaptiveLabel.setBounds(modeRow.removeFromLeft(120));
+    adaptiveModeBox.setBounds(modeRow.reduced(0, 2));
+
+    area.removeFromBottom(8);
+    deviceSelector.setBounds(area);
+}
+
+void AudioSettingsPanel::buttonClicked(juce::Button* button)
+{
+    if (button == &applyButton)
+    {
+        bufferSizer.applyRecommendation();
+        timerCallback();
+    }
+}
+
+void AudioSettingsPanel::comboBoxChanged(juce::ComboBox* comboBox)
+{
+    if (comboBox == &adaptiveModeBox)
+    {
+        bufferSizer.setMode((AdaptiveBufferSizer::Mode)(adaptiveModeBox.getSelectedId() - 1));
+        timerCallback();
+    }
+}
+
+void AudioSettingsPanel::timerCallback()
+{
+    statusLabel.setText(bufferSizer.getStatus(), juce::dontSendNotification);
+    applyButton.setEnabled(bufferSizer.getMode() == AdaptiveBufferSizer::recommend
+        && bufferSizer.getRecommendedBufferSize() > 0);
+
+    // what the audience hears behind the decks: our buffer plus whatever the driver adds
+    if (auto* device = deviceManager.getCurrentAudioDevice())
+    {
+        const double sampleRate = device->getCurrentSampleRate();
+        const int latencySamples = device->getCurrentBufferSizeSamples() + device->getOutputLatencyInSamples();
+        latencyLabel.setText("Output latency: " + juce::String(1000.0 * latencySamples / sampleRate, 1) + " ms ("
+            + device->getTypeName() + ")", juce::dontSendNotification);
+
+        // the cue bus goes to the third and fourth active outputs, whichever they are
+        const auto outputs = device->getActiveOutputChannels();
+        const auto names = device->getOutputChannelNames();
+        if (outputs.countNumberOfSetBits() >= 4)
+        {
+            const int left = outputs.findNextSetBit(outputs.findNextSetBit(outputs.findNextSetBit(0) + 1) + 1);
+            const int right = outputs.findNextSetBit(left + 1);
+            cueOutputLabel.setText("Headphone cue: " + names[left] + " / " + names[right], juce::dontSendNotification);
+        }
+        else
+        {
+            cueOutputLabel.setText("Headphone cue: enable four outputs to hear it", juce::dontSendNotification);
+        }
+    }
+    else
+    {
+        latencyLabel.setText("No audio device", juce::dontSendNotification);
+        cueOutputLabel.setText({}, juce::dontSendNotification);
+    }
+}
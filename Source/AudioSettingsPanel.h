@@ -0,0 +1,79 @@
+/*
+  ==============================================================================
+
+    AudioSettingsPanel.h
+    Created: 19 Oct 2026 6:52:11pm
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "AdaptiveBufferSizer.h"
+
+
+/**
+ * Audio device settings: backend, device, outputs, sample rate and buffer size, plus the
+ * adaptive buffer size mode and what it currently recommends.
+ */
+class AudioSettingsPanel : public juce::Component,
+    public juce::Button::Listener,
+    public juce::ComboBox::Listener,
+    public juce::Timer
+{
+public:
+    /**
+     * Constructor.
+
+        @param _deviceManager: the app's device manager
+        @param _bufferSizer: the app's adaptive buffer sizer
+     */
+    AudioSettingsPanel(juce::AudioDeviceManager& _deviceManager, AdaptiveBufferSizer& _bufferSizer);
+
+    /**
+     * Destructor.
+     */
+    ~AudioSettingsPanel() override;
+
+    /**
+     * Called when this component's size has been changed.
+     */
+    void resized() override;
+
+    /**
+     * Applies the recommended buffer size.
+     *
+     * @param button: the button that was clicked
+     */
+    void buttonClicked(juce::Button* button) override;
+
+    /**
+     * Changes the adaptive buffer size mode.
+     *
+     * @param comboBox: the combo box that changed
+     */
+    void comboBoxChanged(juce::ComboBox* comboBox) override;
+
+    /**
+     * Refreshes the latency, the headphone routing and the sizer's status.
+     */
+    void timerCallback() override;
+
+private:
+    juce::AudioDeviceManager& deviceManager;
+    AdaptiveBufferSizer& bufferSizer;
+
+    // up to four outputs: the master pair and the headphone cue pair
+    juce::AudioDeviceSelectorComponent deviceSelector{ deviceManager, 0, 0, 2, 4, true, false, true, false };
+
+    juce::Label adaptiveLabel{ {}, "Adaptive buffer:" };
+    juce::ComboBox adaptiveModeBox;
+    juce::TextButton applyButton{ "APPLY" };
+    juce::Label statusLabel;
+    juce::Label latencyLabel;
+    juce::Label cueOutputLabel;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioSettingsPanel)
+};
@@ -0,0 +1,502 @@
+/*
+  ==============================================================================
+
+    AutoDJ.cpp
+    Created: 19 Oct 2026 11:59:31pm
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#include "AutoDJ.h"
+#include "Mp3SeekIndex.h"
+#include <cmath>
+
+
+// how often the mix is checked on, and the incoming deck's phase corrected
+static const int timerIntervalMs = 20;
+// how long the incoming deck plays unheard before the crossfade, to be brought into phase
+static const double leadInSeconds = 4.0;
+// crossfade for tracks that can't be beat matched
+static const double fallbackFadeSeconds = 8.0;
+// the crossfade is over this long before the outgoing track ends
+static const double tailSeconds = 1.0;
+// decoded audio the incoming deck needs before it starts
+static const double minBufferedSeconds = 2.0;
+// furthest a track's speed is changed to match the other's tempo
+static const double maxTempoChange = 0.08;
+// phase error the incoming deck is seeked to correct, in real seconds
+static const double phaseToleranceSeconds = 0.004;
+// crossfader moves that aren't the mix itself
+static const double quickFadeSeconds = 0.05;
+static const double handBackSeconds = 0.5;
+
+
+AutoDJ::AutoDJ(DJAudioPlayer& _deck1, DJAudioPlayer& _deck2, DeckRenderPool& _mixer,
+    juce::AudioFormatManager& _formatManager)
+    : decks{ &_deck1, &_deck2 },
+      mixer(_mixer),
+      formatManager(_formatManager)
+{
+}
+
+AutoDJ::~AutoDJ()
+{
+    stopTimer();
+}
+
+void AutoDJ::setEnabled(bool shouldBeEnabled)
+{
+    if (shouldBeEnabled == enabled)
+    {
+        return;
+    }
+    enabled = shouldBeEnabled;
+
+    if (enabled)
+    {
+        if (state == idleState)
+        {
+            // whatever is playing carries on; with nothing playing the first track goes on the left
+            liveDeck = decks[0]->isPlaying() ? 0 : 1;
+            analyses[0].reset();
+            analyses[1].reset();
+            mixer.setCrossfader(getCrossfaderSide(decks[liveDeck]->isPlaying() ? liveDeck : 1 - liveDeck), handBackSeconds);
+
+            // the playing track's beat is needed to mix out of it
+            const auto liveURL = decks[liveDeck]->getLoadedURL();
+            if (decks[liveDeck]->isPlaying() && liveURL.isLocalFile())
+            {
+                const int deck = liveDeck;
+                juce::WeakReference<AutoDJ> weakThis(this);
+                spectralCache->request(liveURL.getLocalFile(), formatManager,
+                    [weakThis, deck, liveURL](std::shared_ptr<const SpectralWaveform> analysis)
+                    {
+                        if (weakThis != nullptr && weakThis->decks[deck]->getLoadedURL() == liveURL)
+                        {
+                            weakThis->analyses[deck] = analysis;
+                            if (weakThis->state == cuedState && weakThis->liveDeck == deck)
+                            {
+                                weakThis->planTransition();
+                            }
+                        }
+                    });
+            }
+
+            startTimer(timerIntervalMs);
+            prepareNext();
+        }
+        // otherwise a mix is still finishing from before, and carries on into the queue
+    }
+    else if (state == leadInState)
+    {
+        auto& next = *decks[1 - liveDeck];
+        next.stop();
+        deckChanged(1 - liveDeck, DJAudioPlayer::playControl);
+        goIdle();
+    }
+    else if (state != fadingState)
+    {
+        goIdle();
+    }
+    stateChanged();
+}
+
+bool AutoDJ::isEnabled() const
+{
+    return enabled;
+}
+
+void AutoDJ::addToQueue(const juce::File& track)
+{
+    queue.add(track);
+    if (state == lastTrackState)
+    {
+        prepareNext();
+    }
+    stateChanged();
+}
+
+void AutoDJ::clearQueue()
+{
+    queue.clear();
+    stateChanged();
+}
+
+const juce::Array<juce::File>& AutoDJ::getQueue() const
+{
+    return queue;
+}
+
+juce::String AutoDJ::getStatusText() const
+{
+    const juce::String next = nextTrack.getFileNameWithoutExtension();
+    switch (state)
+    {
+        case preparingState:
+            return "Preparing " + next;
+        case cuedState:
+            return "Next: " + next;
+        case leadInState:
+        case fadingState:
+            return "Mixing into " + next;
+        case lastTrackState:
+            return "Playing the last track";
+        default:
+            return "Auto-DJ off";
+    }
+}
+
+int AutoDJ::getNumLateTransitions() const
+{
+    return lateTransitions;
+}
+
+void AutoDJ::prepareNext()
+{
+    while (!queue.isEmpty())
+    {
+        const auto track = queue.removeAndReturn(0);
+        if (!track.existsAsFile())
+        {
+            DBG("Auto-DJ skipped missing " << track.getFullPathName());
+            continue;
+        }
+
+        nextTrack = track;
+        state = preparingState;
+        late = false;
+        const int request = ++prepareRequests;
+        juce::WeakReference<AutoDJ> weakThis(this);
+        scheduler->submit(TaskScheduler::deckLoadPriority, "index|" + track.getFullPathName(),
+            [weakThis, track, request](const std::function<bool()>&)
+            {
+                // the first load of an MP3 builds its seek index from the whole file, which
+                // mustn't happen on the message thread on slow storage
+                if (track.hasFileExtension("mp3"))
+                {
+                    Mp3SeekIndex::loadOrBuild(track);
+                }
+                juce::MessageManager::callAsync([weakThis, track, request]
+                    {
+                        if (weakThis == nullptr || weakThis->prepareRequests != request)
+                        {
+                            return;
+                        }
+                        weakThis->spectralCache->request(track, weakThis->formatManager,
+                            [weakThis, request](std::shared_ptr<const SpectralWaveform> analysis)
+                            {
+                                if (weakThis != nullptr && weakThis->prepareRequests == request)
+                                {
+                                    weakThis->loadPrepared(analysis);
+                                }
+                            });
+                    });
+            });
+        stateChanged();
+        return;
+    }
+
+    state = lastTrackState;
+    stateChanged();
+}
+
+void AutoDJ::loadPrepared(std::shared_ptr<const SpectralWaveform> analysis)
+{
+    const int incoming = 1 - liveDeck;
+    auto& next = *decks[incoming];
+    if (analysis == nullptr)
+    {
+        DBG("Auto-DJ can't read " << nextTrack.getFullPathName());
+        prepareNext();
+        return;
+    }
+
+    if (next.isPlaying())
+    {
+        next.stop();
+        deckChanged(incoming, DJAudioPlayer::playControl);
+    }
+    const juce::URL track{ nextTrack };
+    if (onLoad != nullptr)
+    {
+        onLoad(incoming, track);
+    }
+    else
+    {
+        next.loadURL(track);
+    }
+    if (next.getLoadedURL() != track || next.getLengthInSeconds() <= 0)
+    {
+        DBG("Auto-DJ can't load " << nextTrack.getFullPathName());
+        prepareNext();
+        return;
+    }
+
+    analyses[incoming] = analysis;
+    state = cuedState;
+    planTransition();
+    stateChanged();
+}
+
+void AutoDJ::planTransition()
+{
+    const int incoming = 1 - liveDeck;
+    auto& live = *decks[liveDeck];
+    auto& next = *decks[incoming];
+    const auto& liveAnalysis = analyses[liveDeck];
+    const auto& nextAnalysis = analyses[incoming];
+
+    // nothing to mix out of: the track starts from the top as soon as it's decoded
+    if (!live.isPlaying())
+    {
+        beatMatched = false;
+        next.setPosition(0);
+        return;
+    }
+
+    // match the tempo if it doesn't take too big a change in speed
+    const double liveSpeed = live.getSpeed();
+    const double liveBpm = liveAnalysis != nullptr ? liveAnalysis->getBeatsPerMinute() : 0;
+    const double nextBpm = nextAnalysis->getBeatsPerMinute();
+    incomingSpeed = 1.0;
+    beatMatched = false;
+    if (liveBpm > 0 && nextBpm > 0 && std::abs(liveBpm * liveSpeed / nextBpm - 1.0) <= maxTempoChange)
+    {
+        incomingSpeed = liveBpm * liveSpeed / nextBpm;
+        beatMatched = true;
+    }
+    if (next.getSpeed() != incomingSpeed)
+    {
+        next.setSpeed(incomingSpeed);
+        deckChanged(incoming, DJAudioPlayer::speedControl);
+    }
+
+    // the mix finishes just before the live track does, starting on a phrase if there's one
+    // late enough, or else on a beat
+    const double liveLength = live.getLengthInSeconds();
+    const double earliest = live.getPositionInSeconds() + leadInSeconds * liveSpeed;
+    fadeLength = beatMatched ? fadeBeats * 60.0 / liveBpm : fallbackFadeSeconds * liveSpeed;
+    const double latest = liveLength - tailSeconds - fadeLength;
+    fadeStart = latest;
+    if (liveBpm > 0)
+    {
+        const double beat = 60.0 / liveBpm;
+        const double first = liveAnalysis->getFirstBeatSeconds();
+        const double phrase = first + std::floor((latest - first) / (beat * fadeBeats)) * beat * fadeBeats;
+        fadeStart = phrase >= earliest ? phrase : first + std::floor((latest - first) / beat) * beat;
+    }
+    if (fadeStart < earliest)
+    {
+        // too near the end for the whole mix: a shorter one, as soon as the lead-in allows
+        fadeStart = liveAnalysis != nullptr ? liveAnalysis->getNextBeat(earliest) : earliest;
+        fadeLength = juce::jmax(0.0, liveLength - tailSeconds - fadeStart);
+    }
+
+    // the incoming track comes in on its first beat after the lead-in, and waits where the
+    // lead-in starts so that's what gets decoded
+    incomingBeat = nextAnalysis->getNextBeat(leadInSeconds * incomingSpeed);
+    next.setPosition(incomingBeat - leadInSeconds * incomingSpeed);
+}
+
+void AutoDJ::startLeadIn()
+{
+    const int incoming = 1 - liveDeck;
+    auto& live = *decks[liveDeck];
+    auto& next = *decks[incoming];
+
+    double livePosition = 0;
+    double incomingPosition = 0;
+    readPositions(livePosition, incomingPosition);
+    next.setPosition(juce::jmax(0.0, incomingBeat + (livePosition - fadeStart) / live.getSpeed() * incomingSpeed));
+    next.start();
+    deckChanged(incoming, DJAudioPlayer::playControl);
+
+    state = leadInState;
+    stateChanged();
+}
+
+void AutoDJ::alignIncoming()
+{
+    auto& live = *decks[liveDeck];
+    auto& next = *decks[1 - liveDeck];
+
+    double livePosition = 0;
+    double incomingPosition = 0;
+    readPositions(livePosition, incomingPosition);
+    const double expected = incomingBeat + (livePosition - fadeStart) / live.getSpeed() * incomingSpeed;
+    if (expected >= 0 && std::abs(incomingPosition - expected) > phaseToleranceSeconds * incomingSpeed)
+    {
+        next.setPosition(expected);
+    }
+}
+
+void AutoDJ::startNow()
+{
+    const int incoming = 1 - liveDeck;
+    auto& next = *decks[incoming];
+
+    mixer.setCrossfader(getCrossfaderSide(incoming), quickFadeSeconds);
+    if (!next.isPlaying())
+    {
+        next.start();
+        deckChanged(incoming, DJAudioPlayer::playControl);
+    }
+    finishTransition();
+}
+
+void AutoDJ::finishTransition()
+{
+    auto& old = *decks[liveDeck];
+    if (old.isPlaying())
+    {
+        old.stop();
+        deckChanged(liveDeck, DJAudioPlayer::playControl);
+    }
+    liveDeck = 1 - liveDeck;
+
+    if (enabled)
+    {
+        prepareNext();
+    }
+    else
+    {
+        goIdle();
+        stateChanged();
+    }
+}
+
+void AutoDJ::goIdle()
+{
+    state = idleState;
+    ++prepareRequests;
+    stopTimer();
+    mixer.setCrossfader(0.5f, handBackSeconds);
+}
+
+bool AutoDJ::isIncomingReady() const
+{
+    auto& next = *decks[1 - liveDeck];
+    const double left = next.getLengthInSeconds() - next.getPositionInSeconds();
+    return next.getSecondsBuffered() >= juce::jmin(minBufferedSeconds, left - 0.1);
+}
+
+void AutoDJ::readPositions(double& livePosition, double& incomingPosition) const
+{
+    // both move on a block at a time on the audio thread; if the live one moved while
+    // reading, a block went by in between, so read again
+    const auto& live = *decks[liveDeck];
+    const auto& next = *decks[1 - liveDeck];
+    for (int attempt = 0; attempt < 3; ++attempt)
+    {
+        livePosition = live.getPositionInSeconds();
+        incomingPosition = next.getPositionInSeconds();
+        if (live.getPositionInSeconds() == livePosition)
+        {
+            return;
+        }
+    }
+}
+
+float AutoDJ::getCrossfaderSide(int deck)
+{
+    return deck == 0 ? 0.0f : 1.0f;
+}
+
+void AutoDJ::deckChanged(int deck, DJAudioPlayer::Control control)
+{
+    if (onDeckChanged != nullptr)
+    {
+        onDeckChanged(deck, control);
+    }
+}
+
+void AutoDJ::stateChanged()
+{
+    if (onStateChanged != nullptr)
+    {
+        onStateChanged();
+    }
+}
+
+void AutoDJ::timerCallback()
+{
+    const int incoming = 1 - liveDeck;
+    auto& live = *decks[liveDeck];
+
+    switch (state)
+    {
+        case cuedState:
+        {
+            if (!live.isPlaying())
+            {
+                if (isIncomingReady())
+                {
+                    startNow();
+                }
+                break;
+            }
+
+            const double livePosition = live.getPositionInSeconds();
+            if (livePosition < fadeStart - leadInSeconds * live.getSpeed())
+            {
+                break;
+            }
+            if (isIncomingReady())
+            {
+                startLeadIn();
+                break;
+            }
+
+            // not decoded in time: once the planned beat has gone by, aim for a later one
+            if (!late)
+            {
+                late = true;
+                ++lateTransitions;
+                DBG("Auto-DJ: " << nextTrack.getFileName() << " isn't decoded in time for its mix");
+            }
+            if (livePosition >= fadeStart)
+            {
+                planTransition();
+            }
+            break;
+        }
+
+        case leadInState:
+            if (!live.isPlaying())
+            {
+                startNow();
+            }
+            else if (live.getPositionInSeconds() >= fadeStart)
+            {
+                mixer.setCrossfader(getCrossfaderSide(incoming), fadeLength / live.getSpeed());
+                state = fadingState;
+                stateChanged();
+            }
+            else if (beatMatched)
+            {
+                alignIncoming();
+            }
+            break;
+
+        case fadingState:
+            if (!live.isPlaying() || live.getPositionInSeconds() >= fadeStart + fadeLength)
+            {
+                finishTransition();
+            }
+            break;
+
+        case lastTrackState:
+            if (!live.isPlaying())
+            {
+                // played out
+                enabled = false;
+                goIdle();
+                stateChanged();
+            }
+            break;
+
+        default:
+            break;
+    }
+}
@@ -0,0 +1,184 @@
+/*
+  ==============================================================================
+
+    AutoDJ.h
+    Created: 19 Oct 2026 11:59:31pm
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <functional>
+#include <memory>
+#include "DJAudioPlayer.h"
+#include "DeckRenderPool.h"
+#include "SpectralWaveform.h"
+#include "TaskScheduler.h"
+
+
+/**
+ * Plays a queue of tracks on its own, mixing each into the next on the beat.
+ *
+ * As soon as a transition is over, the next track is prepared on the deck that just
+ * went quiet: its MP3 seek index is built and its beat is found in the background, then
+ * it's loaded and parked a few seconds before the beat it will come in on, so its
+ * read-ahead window fills long before it's needed. The mix only starts once that window
+ * is decoded; if storage is too slow for that, the mix moves to a later beat rather
+ * than starting on a gap.
+ *
+ * The incoming deck starts with the crossfader all the way over to the playing one,
+ * at the playing deck's tempo. While nobody can hear it, it's seeked back into phase
+ * every tick from both decks' positions, then the crossfader moves over across
+ * fadeBeats beats. Tracks without a steady beat are faded without matching.
+ *
+ * Runs on the message thread.
+ */
+class AutoDJ : private juce::Timer
+{
+public:
+    /**
+     * Constructor
+     *
+     * @param _deck1: the left deck, on the crossfader's left
+     * @param _deck2: the right deck
+     * @param _mixer: the renderer whose crossfader does the fades
+     * @param _formatManager: to analyse tracks with
+     */
+    AutoDJ(DJAudioPlayer& _deck1, DJAudioPlayer& _deck2, DeckRenderPool& _mixer,
+        juce::AudioFormatManager& _formatManager);
+
+    /** Destructor. Abandons any track being prepared. */
+    ~AutoDJ() override;
+
+    /**
+     * Takes over the decks, or hands them back. Taking over keeps whatever is playing and
+     * prepares the first queued track on the other deck; handing back lets a mix that has
+     * started finish first.
+     *
+     * @param shouldBeEnabled: true to play the queue
+     */
+    void setEnabled(bool shouldBeEnabled);
+
+    /** @returns: true while playing the queue */
+    bool isEnabled() const;
+
+    /**
+     * Adds a track to the end of the queue.
+     *
+     * @param track: the track
+     */
+    void addToQueue(const juce::File& track);
+
+    /** Empties the queue; a track already prepared on a deck still plays. */
+    void clearQueue();
+
+    /** @returns: the tracks still to be prepared, next first */
+    const juce::Array<juce::File>& getQueue() const;
+
+    /** @returns: what's happening, to show the user */
+    juce::String getStatusText() const;
+
+    /** @returns: how many mixes started late because the next track wasn't decoded in time */
+    int getNumLateTransitions() const;
+
+    /**
+     * Called to load a track into a deck, so whatever shows the deck follows. The player
+     * is loaded directly if this isn't set.
+     */
+    std::function<void(int deck, const juce::URL& track)> onLoad;
+
+    /** Called after starting or stopping a deck or changing its speed */
+    std::function<void(int deck, DJAudioPlayer::Control control)> onDeckChanged;
+
+    /** Called when the queue, the status or whether it's enabled changes */
+    std::function<void()> onStateChanged;
+
+    /** Beats the crossfade lasts */
+    static constexpr int fadeBeats = 16;
+
+private:
+    enum State
+    {
+        idleState = 0,      // not enabled
+        preparingState,     // next track being indexed and analysed
+        cuedState,          // next track loaded, waiting for its beat to come in on
+        leadInState,        // next track playing silently, being brought into phase
+        fadingState,        // crossfading
+        lastTrackState      // nothing left to queue, the playing track plays out
+    };
+
+    DJAudioPlayer* decks[2];
+    DeckRenderPool& mixer;
+    juce::AudioFormatManager& formatManager;
+    juce::SharedResourcePointer<SpectralWaveformCache> spectralCache;
+    juce::SharedResourcePointer<TaskScheduler> scheduler;
+
+    bool enabled = false;
+    State state = idleState;
+    juce::Array<juce::File> queue;
+    juce::File nextTrack;
+    int prepareRequests = 0;   // tells apart the latest preparation from abandoned ones
+    int lateTransitions = 0;
+    bool late = false;
+
+    int liveDeck = 0;   // the deck being heard; the other is the incoming one
+    std::shared_ptr<const SpectralWaveform> analyses[2];
+
+    // the planned mix, in each deck's track time
+    double fadeStart = 0;       // the live deck's beat the crossfade starts on
+    double fadeLength = 0;      // seconds of the live track it lasts
+    double incomingBeat = 0;    // the incoming deck's beat that lands on fadeStart
+    double incomingSpeed = 1;
+    bool beatMatched = false;
+
+    /** Prepares the first queued track on the incoming deck, or plays out the last one */
+    void prepareNext();
+
+    /** Loads a prepared track into the incoming deck and plans the mix into it */
+    void loadPrepared(std::shared_ptr<const SpectralWaveform> analysis);
+
+    /** Works out when the mix starts and where the incoming track comes in */
+    void planTransition();
+
+    /** Starts the incoming deck, unheard, lined up with the live one */
+    void startLeadIn();
+
+    /** Seeks the incoming deck back into phase with the live one */
+    void alignIncoming();
+
+    /** Starts the incoming deck at once, as the live one has stopped */
+    void startNow();
+
+    /** Stops the old deck and makes the incoming one live */
+    void finishTransition();
+
+    /** Stops following the decks and puts the crossfader back in the middle */
+    void goIdle();
+
+    /** @returns: true if the incoming deck has enough decoded to start */
+    bool isIncomingReady() const;
+
+    /**
+     * Reads both decks' positions at the same block.
+     *
+     * @param livePosition: the live deck's, in seconds
+     * @param incomingPosition: the incoming deck's, in seconds
+     */
+    void readPositions(double& livePosition, double& incomingPosition) const;
+
+    /** @returns: the crossfader position that has only this deck on it */
+    static float getCrossfaderSide(int deck);
+
+    /** Calls onDeckChanged, if set */
+    void deckChanged(int deck, DJAudioPlayer::Control control);
+
+    /** Calls onStateChanged, if set */
+    void stateChanged();
+
+    void timerCallback() override;
+
+    JUCE_DECLARE_WEAK_REFERENCEABLE(AutoDJ)
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AutoDJ)
+};
@@ -0,0 +1,187 @@
+/*
+  ==============================================================================
+
+    AutomationTimeline.cpp
+    Created: 19 Oct 2026 1:55:31pm
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#include "AutomationTimeline.h"
+
+
+void AutomationTimeline::addEvent(const Event& event)
+{
+    // events nearly always arrive in order, so search back from the end
+    int index = events.size();
+    while (index > 0 && events.getReference(index - 1).timeInSecs > event.timeInSecs)
+    {
+        --index;
+    }
+    events.insert(index, event);
+}
+
+const juce::Array<AutomationTimeline::Event>& AutomationTimeline::getEvents() const
+{
+    return events;
+}
+
+double AutomationTimeline::getLengthInSeconds() const
+{
+    return events.isEmpty() ? 0.0 : events.getLast().timeInSecs;
+}
+
+bool AutomationTimeline::isEmpty() const
+{
+    return events.isEmpty();
+}
+
+void AutomationTimeline::clear()
+{
+    events.clear();
+}
+
+bool AutomationTimeline::saveToFile(const juce::File& file) const
+{
+    juce::XmlElement root("AUTOMATION");
+
+    for (auto& event : events)
+    {
+        auto* element = root.createNewChildElement("EVENT");
+        element->setAttribute("time", event.timeInSecs);
+        element->setAttribute("deck", event.deck);
+        element->setAttribute("type", getTypeName(event.type));
+        element->setAttribute("value", event.value);
+        if (event.effect >= 0)
+        {
+            element->setAttribute("effect", event.effect);
+        }
+        if (event.file.isNotEmpty())
+        {
+            element->setAttribute("file", event.file);
+        }
+        if (event.rampSecs > 0)
+        {
+            element->setAttribute("ramp", event.rampSecs);
+        }
+    }
+    return root.writeTo(file);
+}
+
+bool AutomationTimeline::loadFromFile(const juce::File& file)
+{
+    auto root = juce::XmlDocument::parse(file);
+    if (root == nullptr || !root->hasTagName("AUTOMATION"))
+    {
+        DBG("Not an automation file: " << file.getFullPathName());
+        return false;
+    }
+
+    events.clear();
+    for (auto* element : root->getChildWithTagNameIterator("EVENT"))
+    {
+        Event event;
+        event.timeInSecs = element->getDoubleAttribute("time");
+        event.deck = element->getIntAttribute("deck");
+        event.value = element->getDoubleAttribute("value");
+        event.effect = element->getIntAttribute("effect", -1);
+        event.file = element->getStringAttribute("file");
+        event.rampSecs = element->getDoubleAttribute("ramp");
+
+        const auto typeName = element->getStringAttribute("type");
+        int type = 0;
+        while (type < numEventTypes && typeName != getTypeName((EventType)type))
+        {
+            ++type;
+        }
+        if (type == numEventTypes)
+        {
+            DBG("Skipping unknown automation event: " << typeName);
+            continue;
+        }
+        event.type = (EventType)type;
+        addEvent(event);
+    }
+    return true;
+}
+
+const char* AutomationTimeline::getTypeName(EventType type)
+{
+    switch (type)
+    {
+        case loadEvent:          return "load";
+        case startEvent:         return "start";
+        case stopEvent:          return "stop";
+        case gainEvent:          return "gain";
+        case speedEvent:         return "speed";
+        case positionEvent:      return "position";
+        case wetEvent:           return "wet";
+        case freezeEvent:        return "freeze";
+        case effectEnabledEvent: return "effectEnabled";
+        case effectAmountEvent:  return "effectAmount";
+        case reverseEvent:       return "reverse";
+        case effectSlotEvent:    return "effectSlot";
+        case crossfaderEvent:    return "crossfader";
+        case scratchEvent:       return "scratch";
+        case scratchMoveEvent:   return "scratchMove";
+        default:                 return "";
+    }
+}
+
+
+void AutomationRecorder::setSampleRate(double sampleRate)
+{
+    clockSampleRate.store(sampleRate);
+}
+
+void AutomationRecorder::advanceClock(int numSamples)
+{
+    samplesRendered.fetch_add(numSamples, std::memory_order_relaxed);
+}
+
+void AutomationRecorder::start()
+{
+    const juce::ScopedLock sl(lock);
+    timeline.clear();
+    startSample = samplesRendered.load();
+    recording = true;
+}
+
+void AutomationRecorder::stop()
+{
+    const juce::ScopedLock sl(lock);
+    recording = false;
+}
+
+bool AutomationRecorder::isRecording() const
+{
+    const juce::ScopedLock sl(lock);
+    return recording;
+}
+
+void AutomationRecorder::record(int deck, AutomationTimeline::EventType type, double value,
+    int effect, const juce::String& file, double rampSecs)
+{
+    const juce::ScopedLock sl(lock);
+    if (!recording)
+    {
+        return;
+    }
+
+    AutomationTimeline::Event event;
+    event.timeInSecs = (double)(samplesRendered.load() - startSample) / clockSampleRate.load();
+    event.deck = deck;
+    event.type = type;
+    event.value = value;
+    event.effect = effect;
+    event.file = file;
+    event.rampSecs = rampSecs;
+    timeline.addEvent(event);
+}
+
+AutomationTimeline AutomationRecorder::getTimeline() const
+{
+    const juce::ScopedLock sl(lock);
+    return timeline;
+}
@@ -0,0 +1,152 @@
+/*
+  ==============================================================================
+
+    AutomationTimeline.h
+    Created: 19 Oct 2026 1:55:31pm
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <atomic>
+
+
+/**
+ * A recorded session: every deck action with the time it happened, so the session can be
+ * played back without the audio device, e.g. by the OfflineRenderer.
+ */
+class AutomationTimeline
+{
+public:
+    /** What happened */
+    enum EventType
+    {
+        loadEvent = 0,
+        startEvent,
+        stopEvent,
+        gainEvent,
+        speedEvent,
+        positionEvent,
+        wetEvent,
+        freezeEvent,
+        effectEnabledEvent,
+        effectAmountEvent,
+        reverseEvent,
+        effectSlotEvent,
+        crossfaderEvent,
+        scratchEvent,
+        scratchMoveEvent,
+        numEventTypes
+    };
+
+    /** One deck action */
+    struct Event
+    {
+        double timeInSecs = 0;
+        int deck = 0;       // -1 for the mixer's crossfader
+        EventType type = startEvent;
+        double value = 0;   // the slot the effect moved to, for effect slot events; 1 for a hand
+                            // put on the platter and 0 for letting go, or seconds moved, for scratches
+        int effect = -1;    // EffectsRack::EffectType for the effect events
+        juce::String file;  // full path for load events
+        double rampSecs = 0; // how long the crossfader took to get there
+    };
+
+    /**
+     * Adds an event, keeping the events in time order.
+     *
+     * @param event: the event to add
+     */
+    void addEvent(const Event& event);
+
+    /** @returns: all the events, in time order */
+    const juce::Array<Event>& getEvents() const;
+
+    /** @returns: the time of the last event */
+    double getLengthInSeconds() const;
+
+    /** @returns: true if nothing has been recorded */
+    bool isEmpty() const;
+
+    /** Removes all the events */
+    void clear();
+
+    /**
+     * Writes the timeline as XML.
+     *
+     * @param file: the file to write
+     * @returns: True if the file was written, else False
+     */
+    bool saveToFile(const juce::File& file) const;
+
+    /**
+     * Replaces the timeline with one saved by saveToFile().
+     *
+     * @param file: the file to read
+     * @returns: True if the file was read, else False
+     */
+    bool loadFromFile(const juce::File& file);
+
+private:
+    juce::Array<Event> events;
+
+    static const char* getTypeName(EventType type);
+};
+
+
+/**
+ * Timestamps deck actions against the number of samples the device has rendered and
+ * collects them into an AutomationTimeline.
+ */
+class AutomationRecorder
+{
+public:
+    /**
+     * Sets the rate the clock counts at. Called from prepareToPlay().
+     *
+     * @param sampleRate: the device sample rate
+     */
+    void setSampleRate(double sampleRate);
+
+    /**
+     * Moves the clock on. Called on the audio thread after each block.
+     *
+     * @param numSamples: size of the block just rendered
+     */
+    void advanceClock(int numSamples);
+
+    /** Clears the timeline and starts recording from now */
+    void start();
+
+    /** Stops recording; the timeline is kept */
+    void stop();
+
+    /** @returns: true while recording */
+    bool isRecording() const;
+
+    /**
+     * Adds an event at the current time, if recording.
+     *
+     * @param deck: index of the deck the action happened on
+     * @param type: what happened
+     * @param value: the new value, if any
+     * @param effect: the effect concerned, for effect events
+     * @param file: the file loaded, for load events
+     * @param rampSecs: how long the move takes, for crossfader events
+     */
+    void record(int deck, AutomationTimeline::EventType type, double value = 0,
+        int effect = -1, const juce::String& file = {}, double rampSecs = 0);
+
+    /** @returns: a copy of what has been recorded so far */
+    AutomationTimeline getTimeline() const;
+
+private:
+    juce::CriticalSection lock;
+    AutomationTimeline timeline;
+    std::atomic<juce::int64> samplesRendered{ 0 };
+    std::atomic<double> clockSampleRate{ 44100.0 };
+    juce::int64 startSample = 0;
+    bool recording = false;
+};
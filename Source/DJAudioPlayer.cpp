@@ -9,16 +9,57 @@
 */
 
 #include "DJAudioPlayer.h"
+#include <cmath>
 
-DJAudioPlayer::DJAudioPlayer(juce::AudioFormatManager& _formatManager)
-    : formatManager(_formatManager)
+
+// how long the platter takes to catch up with the hand while scratching
+static const double scratchFollowSeconds = 0.02;
+
+// decoded samples the platter needs beyond the span it plays over, for interpolating
+static const int platterMarginSamples = 8;
+
+// the speed knob's range, which a controller's pitch fader covers too
+static const double minKnobSpeed = 0.2;
+static const double maxKnobSpeed = 2.0;
+
+/**
+ * Maps a controller's speed fader onto the speed knob's range, with normal speed in the
+ * middle of the fader rather than a little under it.
+ *
+ * @param value: 0 to 1
+ */
+static double getSpeedForControl(double value)
 {
-    // Set default reverb settings
-    reverbParameters.roomSize = 0;
-    reverbParameters.damping = 0;
-    reverbParameters.wetLevel = 0;
-    reverbParameters.dryLevel = 1.0;
-    reverbSource.setParameters(reverbParameters);
+    value = juce::jlimit(0.0, 1.0, value);
+    return value < 0.5 ? juce::jmap(value, 0.0, 0.5, minKnobSpeed, 1.0)
+                       : juce::jmap(value, 0.5, 1.0, 1.0, maxKnobSpeed);
+}
+
+/**
+ * 4-point Hermite interpolation.
+ *
+ * @param y: four samples in a row
+ * @param x: 0 to 1 between y[1] and y[2]
+ */
+static float interpolateHermite(const float* y, float x)
+{
+    const float c1 = 0.5f * (y[2] - y[0]);
+    const float c2 = y[0] - 2.5f * y[1] + 2.0f * y[2] - 0.5f * y[3];
+    const float c3 = 0.5f * (y[3] - y[0]) + 1.5f * (y[1] - y[2]);
+    return ((c3 * x + c2) * x + c1) * x + y[1];
+}
+
+
+DJAudioPlayer::DJAudioPlayer(juce::AudioFormatManager& _formatManager, juce::TimeSliceThread* _readAheadThread)
+    : formatManager(_formatManager),
+      readAheadThread(_readAheadThread)
+{
+    for (int stage = 0; stage < numStages; ++stage)
+    {
+        stageTicks[stage] = 0;
+        stageBlocksProcessed[stage] = 0;
+        stageBlocksSkipped[stage] = 0;
+    }
 };
 
 DJAudioPlayer::~DJAudioPlayer() {
@@ -27,37 +68,210 @@ DJAudioPlayer::~DJAudioPlayer() {
 
 void DJAudioPlayer::prepareToPlay(int samplesPerBlockExpected, double sampleRate)
 {
-    transportSource.prepareToPlay(samplesPerBlockExpected, sampleRate);
+    deviceSampleRate = sampleRate;
+
+    // the resampler sizes its buffers for the ratio it has when prepared, and reallocates
+    // on the audio thread if the ratio goes up later; prepare it for the fastest speed of
+    // the highest rate file
+    const double maxRatio = maxSpeed * juce::jmax(1.0, maxFileSampleRate / sampleRate);
+    resampleSource.setResamplingRatio(maxRatio);
     resampleSource.prepareToPlay(samplesPerBlockExpected, sampleRate);
-    reverbSource.prepareToPlay(samplesPerBlockExpected, sampleRate);
+    updateResamplingRatio();
+    resampleSource.setResamplingRatio(resamplingRatio.load());
+
+    // the resampler would prepare the transport at maxRatio times the device rate; it doesn't
+    // resample, so it's prepared here once at the device rate, for the most it's asked for
+    transportSource.prepareToPlay(juce::roundToInt(samplesPerBlockExpected * maxRatio), sampleRate);
+    effectsRack.prepareToPlay(samplesPerBlockExpected, sampleRate);
+    meter.prepare(sampleRate, samplesPerBlockExpected);
+    blocksSinceStopped = 0;
+
+    // room for a block at the fastest the platter turns, on the highest rate file
+    platterChunkSize = juce::jmax(1, samplesPerBlockExpected);
+    maxPlatterRate = juce::jmax(maxScratchRate, maxSpeed) * juce::jmax(1.0, maxFileSampleRate / sampleRate);
+    platterBuffer.setSize(2, (int)std::ceil(platterChunkSize * maxPlatterRate) + platterMarginSamples);
+    platterActive = false;
 };
 
 void DJAudioPlayer::getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill)
 {
-    reverbSource.getNextAudioBlock(bufferToFill);
+    // source stage. Reversed or scratched, the platter plays the track. Otherwise the
+    // transport does; stopped it only outputs silence, but it fades out over the block
+    // after stop() so give it a couple of blocks before skipping it
+    auto stageStart = juce::Time::getHighResolutionTicks();
+    bool silent = false;
+
+    // speed changes reach the resampler here, so the lock it keeps its ratio under is
+    // only ever taken on this thread
+    const double ratio = resamplingRatio.load(std::memory_order_relaxed);
+    if (ratio != resampleSource.getResamplingRatio())
+    {
+        resampleSource.setResamplingRatio(ratio);
+    }
+
+    if (scratching.load(std::memory_order_acquire) || reverse.load(std::memory_order_relaxed))
+    {
+        silent = !renderPlatter(bufferToFill);
+        blocksSinceStopped = 0;
+        recordStage(sourceStage, !silent, stageStart);
+    }
+    else
+    {
+        if (platterActive)
+        {
+            stopPlatter();
+        }
+
+        if (transportSource.isPlaying())
+        {
+            blocksSinceStopped = 0;
+        }
+        else if (blocksSinceStopped < 2)
+        {
+            ++blocksSinceStopped;
+        }
+
+        if (blocksSinceStopped < 2)
+        {
+            resampleSource.getNextAudioBlock(bufferToFill);
+            recordStage(sourceStage, true, stageStart);
+        }
+        else
+        {
+            bufferToFill.clearActiveBufferRegion();
+            silent = true;
+            recordStage(sourceStage, false, stageStart);
+        }
+    }
+
+    // effects stage. Dry effects are bypassed, and the whole rack is skipped on silent
+    // input once any tail has died away
+    stageStart = juce::Time::getHighResolutionTicks();
+    silent = effectsRack.process(*bufferToFill.buffer, bufferToFill.startSample, bufferToFill.numSamples, silent);
+    recordStage(effectsStage, effectsRack.didProcessLastBlock(), stageStart);
+
+    if (silent)
+    {
+        meter.processSilence(bufferToFill.numSamples);
+    }
+    else
+    {
+        meter.process(*bufferToFill.buffer, bufferToFill.startSample, bufferToFill.numSamples);
+    }
+
+    outputSilent.store(silent, std::memory_order_relaxed);
+
+    // where the playhead got to, for the UI to carry on from until the next block
+    auto& report = playheadReports.getWriteSlot();
+    report.positionSecs = getPositionInSeconds();
+    report.lengthSecs = getLengthInSeconds();
+    if (platterActive)
+    {
+        report.rate = platterRate / getFileToDeviceRatio();
+    }
+    else
+    {
+        report.rate = transportSource.isPlaying() ? resampleSource.getResamplingRatio() / getFileToDeviceRatio() : 0.0;
+    }
+    report.ticks = juce::Time::getHighResolutionTicks();
+    playheadReports.publish();
 };
 
 void DJAudioPlayer::releaseResources()
 {
     transportSource.releaseResources();
     resampleSource.releaseResources();
-    reverbSource.releaseResources();
 };
 
 void DJAudioPlayer::loadURL(juce::URL audioURL)
 {
-    // takes audio url input string, passes it to formatManager, and creates a Reader
-    auto* reader = formatManager.createReaderFor(audioURL.createInputStream(false));
+    // MP3 files are read through a seek index, so jumps don't decode their way there;
+    // anything else takes audio url input string, passes it to formatManager, and creates a Reader
+    juce::AudioFormatReader* reader = nullptr;
+    bool needsSeekIndex = false;
+    if (audioURL.isLocalFile())
+    {
+        // building an index reads the whole file, so only one that's saved is used here;
+        // otherwise the track opens unindexed and the index is built in the background
+        const auto file = audioURL.getLocalFile();
+        reader = IndexedMp3Reader::create(file, formatManager, false);
+        needsSeekIndex = reader == nullptr && file.hasFileExtension("mp3");
+    }
+    if (reader == nullptr)
+    {
+        reader = formatManager.createReaderFor(audioURL.createInputStream(false));
+    }
     // check if it successfully created the reader aka the file is readable
     if (reader != nullptr) 
     {
-        std::unique_ptr<juce::AudioFormatReaderSource> newSource(new juce::AudioFormatReaderSource(reader, true));
-        transportSource.setSource(newSource.get(), 0, nullptr, reader->sampleRate);
-        readerSource.reset(newSource.release());
-
+        setReader(reader);
+        loadedURL = audioURL;
+        recordEvent(AutomationTimeline::loadEvent, 0, -1, audioURL.getLocalFile().getFullPathName());
+        if (needsSeekIndex)
+        {
+            buildSeekIndex(audioURL.getLocalFile());
+        }
     }
 };
 
+void DJAudioPlayer::setReader(juce::AudioFormatReader* reader)
+{
+    std::unique_ptr<ReadAheadAudioSource> newSource(new ReadAheadAudioSource(reader, readAheadThread));
+    std::unique_ptr<ReadAheadAudioSource> oldSource;
+    {
+        // the platter reads the source outside the transport, so swap it under its lock;
+        // the old one is deleted after, as that waits for its decoding to stop
+        const juce::SpinLock::ScopedLockType lock(sourceLock);
+
+        // no source rate, so the transport doesn't resample: the resampler after it converts
+        // the file's rate to the device's along with the speed, in one pass
+        transportSource.setSource(newSource.get(), 0, nullptr, 0);
+        oldSource = std::move(readerSource);
+        readerSource = std::move(newSource);
+        fileSampleRate.store(reader->sampleRate);
+    }
+    updateResamplingRatio();
+}
+
+void DJAudioPlayer::buildSeekIndex(const juce::File& track)
+{
+    juce::WeakReference<DJAudioPlayer> weakThis(this);
+    scheduler->submit(TaskScheduler::deckLoadPriority, "index|" + track.getFullPathName(),
+        [weakThis, track](const std::function<bool()>&)
+        {
+            if (Mp3SeekIndex::loadOrBuild(track) == nullptr)
+            {
+                return;
+            }
+            juce::MessageManager::callAsync([weakThis, track]
+                {
+                    if (weakThis != nullptr)
+                    {
+                        weakThis->seekIndexBuilt(track);
+                    }
+                });
+        });
+}
+
+void DJAudioPlayer::seekIndexBuilt(const juce::File& track)
+{
+    // swapping the reader stops the transport, so a track that's already playing keeps
+    // its unindexed reader; the next load of it uses the index
+    if (loadedURL != juce::URL(track) || transportSource.isPlaying() || scratching.load())
+    {
+        return;
+    }
+
+    auto* reader = IndexedMp3Reader::create(track, formatManager, false);
+    if (reader == nullptr)
+    {
+        return;
+    }
+    const double position = transportSource.getCurrentPosition();
+    setReader(reader);
+    transportSource.setPosition(position);
+}
+
 void DJAudioPlayer::setGain(double gain)
 {
     if (gain <= 0 || gain > 1.0) {
@@ -68,13 +282,15 @@ void DJAudioPlayer::setGain(double gain)
         }
     }
     else {
-        transportSource.setGain(gain);
+        faderGain.store((float)gain, std::memory_order_relaxed);
+        currentGain = gain;
+        recordEvent(AutomationTimeline::gainEvent, gain);
     }
 };
 
 void DJAudioPlayer::setSpeed(double ratio)
 {
-    if (ratio < 0 || ratio > 3.0 || ratio == 0) {
+    if (ratio < 0 || ratio > maxSpeed || ratio == 0) {
         if (ratio < 0)
         {
             // Set minimum to avoid error
@@ -82,13 +298,199 @@ void DJAudioPlayer::setSpeed(double ratio)
         }
     }
     else {
-        resampleSource.setResamplingRatio(ratio);
+        currentSpeed = ratio;
+        updateResamplingRatio();
+        recordEvent(AutomationTimeline::speedEvent, ratio);
     }
 };
 
+double DJAudioPlayer::getSpeed() const
+{
+    return currentSpeed;
+}
+
+void DJAudioPlayer::setReverse(bool shouldPlayBackwards)
+{
+    reverse.store(shouldPlayBackwards, std::memory_order_relaxed);
+    recordEvent(AutomationTimeline::reverseEvent, shouldPlayBackwards ? 1.0 : 0.0);
+}
+
+bool DJAudioPlayer::isReverse() const
+{
+    return reverse.load(std::memory_order_relaxed);
+}
+
+void DJAudioPlayer::beginScratch()
+{
+    touchPlatter();
+    recordEvent(AutomationTimeline::scratchEvent, 1.0);
+}
+
+void DJAudioPlayer::scratchMove(double deltaSeconds)
+{
+    movePlatter(deltaSeconds);
+    recordEvent(AutomationTimeline::scratchMoveEvent, deltaSeconds);
+}
+
+void DJAudioPlayer::endScratch()
+{
+    releasePlatter();
+    recordEvent(AutomationTimeline::scratchEvent, 0.0);
+}
+
+void DJAudioPlayer::touchPlatter()
+{
+    // the audio thread anchors the hand at the platter's position when it sees a new scratch
+    scratchMovedSecs.store(0.0, std::memory_order_relaxed);
+    scratchesStarted.fetch_add(1, std::memory_order_release);
+    scratching.store(true, std::memory_order_release);
+}
+
+void DJAudioPlayer::movePlatter(double deltaSeconds)
+{
+    // the mouse and a controller's jog wheel can both be moving it
+    double moved = scratchMovedSecs.load(std::memory_order_relaxed);
+    while (!scratchMovedSecs.compare_exchange_weak(moved, moved + deltaSeconds, std::memory_order_relaxed))
+    {
+    }
+}
+
+void DJAudioPlayer::releasePlatter()
+{
+    scratching.store(false, std::memory_order_release);
+}
+
+bool DJAudioPlayer::isScratching() const
+{
+    return scratching.load(std::memory_order_relaxed);
+}
+
+void DJAudioPlayer::applyControl(Control control, double value)
+{
+    const bool pressed = value > 0.5;
+    switch (control)
+    {
+        case cueControl:
+            if (pressed)
+            {
+                cueEnabled.store(!cueEnabled.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            }
+            break;
+        case reverseControl:
+            if (pressed)
+            {
+                reverse.store(!reverse.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            }
+            break;
+        case gainControl:
+            faderGain.store((float)juce::jlimit(0.0, 1.0, value), std::memory_order_relaxed);
+            break;
+        case speedControl:
+            resamplingRatio.store(getSpeedForControl(value) * getFileToDeviceRatio(), std::memory_order_relaxed);
+            break;
+        case wetControl:
+            effectsRack.setEffectAmount(EffectsRack::reverbEffect, (float)juce::jlimit(0.0, 1.0, value));
+            break;
+        case freezeControl:
+            effectsRack.getReverb().setFreeze((float)juce::jlimit(0.0, 1.0, value));
+            break;
+        case filterControl:
+            effectsRack.setEffectAmount(EffectsRack::filterEffect, (float)juce::jlimit(-1.0, 1.0, value * 2.0 - 1.0));
+            break;
+        case jogTouchControl:
+            if (pressed)
+            {
+                touchPlatter();
+            }
+            else
+            {
+                releasePlatter();
+            }
+            break;
+        case jogTurnControl:
+            // an untouched platter spins freely, so turning it only scratches while held
+            if (isScratching())
+            {
+                movePlatter(value);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+void DJAudioPlayer::controlApplied(Control control, double value)
+{
+    switch (control)
+    {
+        case playControl:
+            if (value > 0.5)
+            {
+                if (isPlaying())
+                {
+                    stop();
+                }
+                else
+                {
+                    start();
+                }
+            }
+            break;
+        case reverseControl:
+            if (value > 0.5)
+            {
+                recordEvent(AutomationTimeline::reverseEvent, isReverse() ? 1.0 : 0.0);
+            }
+            break;
+        case gainControl:
+            currentGain = juce::jlimit(0.0, 1.0, value);
+            recordEvent(AutomationTimeline::gainEvent, currentGain);
+            break;
+        case speedControl:
+            currentSpeed = getSpeedForControl(value);
+            recordEvent(AutomationTimeline::speedEvent, currentSpeed);
+            break;
+        case wetControl:
+            recordEvent(AutomationTimeline::wetEvent, juce::jlimit(0.0, 1.0, value));
+            break;
+        case freezeControl:
+            recordEvent(AutomationTimeline::freezeEvent, juce::jlimit(0.0, 1.0, value));
+            break;
+        case filterControl:
+            // the filter starts switched off, and switching it on changes the rack's layout,
+            // which only this thread can do; the amount was set on the audio thread already
+            if (!effectsRack.isEffectEnabled(EffectsRack::filterEffect))
+            {
+                setEffectEnabled(EffectsRack::filterEffect, true);
+            }
+            recordEvent(AutomationTimeline::effectAmountEvent, juce::jlimit(-1.0, 1.0, value * 2.0 - 1.0), EffectsRack::filterEffect);
+            break;
+        case jogTouchControl:
+            jogTouched = value > 0.5;
+            recordEvent(AutomationTimeline::scratchEvent, jogTouched ? 1.0 : 0.0);
+            break;
+        case jogTurnControl:
+            // followed up in the order they came in, so this is whether the hand was down for it
+            if (jogTouched)
+            {
+                recordEvent(AutomationTimeline::scratchMoveEvent, value);
+            }
+            break;
+        default:
+            // the cue isn't part of the mix
+            break;
+    }
+}
+
+bool DJAudioPlayer::isPlaying() const
+{
+    return transportSource.isPlaying();
+}
+
 void DJAudioPlayer::setPosition(double posInSecs)
 {
-    transportSource.setPosition(posInSecs);
+    transportSource.setNextReadPosition((juce::int64)(posInSecs * fileSampleRate.load()));
+    recordEvent(AutomationTimeline::positionEvent, posInSecs);
 };
 
 void DJAudioPlayer::setPositionRelative(double pos)
@@ -101,7 +503,7 @@ void DJAudioPlayer::setPositionRelative(double pos)
         }
     }
     else {
-        double posInSecs = transportSource.getLengthInSeconds() * pos;
+        double posInSecs = getLengthInSeconds() * pos;
         setPosition(posInSecs);
     }
 }
@@ -109,27 +511,48 @@ void DJAudioPlayer::setPositionRelative(double pos)
 void DJAudioPlayer::start()
 {
     transportSource.start();
+    recordEvent(AutomationTimeline::startEvent);
 };
 
 void DJAudioPlayer::stop()
 {
     transportSource.stop();
+    recordEvent(AutomationTimeline::stopEvent);
 };
 
 
 double DJAudioPlayer::getPositionRelative()
 {
     // check for division by zero otherwise get error
-    if (transportSource.getLengthInSeconds() != 0) {
+    if (getLengthInSeconds() != 0) {
         // if we dont divide, it will return the position in seconds which is not relative
-        return transportSource.getCurrentPosition() / transportSource.getLengthInSeconds();
+        return getPositionInSeconds() / getLengthInSeconds();
     }
+    return 0.0;
 }
 
 
 double DJAudioPlayer::getLengthInSeconds()
 {
-    return transportSource.getLengthInSeconds();
+    const double rate = fileSampleRate.load();
+    return rate > 0 ? transportSource.getTotalLength() / rate : 0.0;
+}
+
+double DJAudioPlayer::getPositionInSeconds() const
+{
+    const double rate = fileSampleRate.load();
+    return rate > 0 ? transportSource.getNextReadPosition() / rate : 0.0;
+}
+
+double DJAudioPlayer::getFileToDeviceRatio() const
+{
+    const double rate = fileSampleRate.load();
+    return (rate > 0 && deviceSampleRate > 0) ? rate / deviceSampleRate : 1.0;
+}
+
+void DJAudioPlayer::updateResamplingRatio()
+{
+    resamplingRatio.store(currentSpeed * getFileToDeviceRatio(), std::memory_order_relaxed);
 }
 
 
@@ -137,8 +560,8 @@ void DJAudioPlayer::setFreeze(float freezeAmt)
 {
     if (freezeAmt >= 0 && freezeAmt <= 1.0)
     {
-        reverbParameters.freezeMode = freezeAmt;
-        reverbSource.setParameters(reverbParameters);
+        effectsRack.getReverb().setFreeze(freezeAmt);
+        recordEvent(AutomationTimeline::freezeEvent, freezeAmt);
     }
 }
 
@@ -146,7 +569,303 @@ void DJAudioPlayer::setWetLevel(float wetLevel)
 {
     if (wetLevel >= 0 && wetLevel <= 1.0)
     {
-        reverbParameters.wetLevel = wetLevel;
-        reverbSource.setParameters(reverbParameters);
+        effectsRack.setEffectAmount(EffectsRack::reverbEffect, wetLevel);
+        recordEvent(AutomationTimeline::wetEvent, wetLevel);
+    }
+}
+
+void DJAudioPlayer::setEffectEnabled(EffectsRack::EffectType type, bool shouldBeEnabled)
+{
+    effectsRack.setEffectEnabled(type, shouldBeEnabled);
+    recordEvent(AutomationTimeline::effectEnabledEvent, shouldBeEnabled ? 1.0 : 0.0, type);
+}
+
+void DJAudioPlayer::setEffectAmount(EffectsRack::EffectType type, float amount)
+{
+    effectsRack.setEffectAmount(type, amount);
+    recordEvent(AutomationTimeline::effectAmountEvent, amount, type);
+}
+
+void DJAudioPlayer::moveEffect(EffectsRack::EffectType type, int slot)
+{
+    auto order = effectsRack.getEffectOrder();
+    slot = juce::jlimit(0, order.size() - 1, slot);
+    order.removeFirstMatchingValue(type);
+    order.insert(slot, type);
+    effectsRack.setEffectOrder(order);
+    recordEvent(AutomationTimeline::effectSlotEvent, slot, type);
+}
+
+EffectsRack& DJAudioPlayer::getEffectsRack()
+{
+    return effectsRack;
+}
+
+void DJAudioPlayer::setAutomationRecorder(AutomationRecorder* _recorder, int _deckIndex)
+{
+    recorder = _recorder;
+    deckIndex = _deckIndex;
+}
+
+void DJAudioPlayer::recordCurrentState()
+{
+    if (loadedURL.isEmpty())
+    {
+        return;
+    }
+
+    // replayed in this order, so the track is loaded before it is positioned or started
+    recordEvent(AutomationTimeline::loadEvent, 0, -1, loadedURL.getLocalFile().getFullPathName());
+    recordEvent(AutomationTimeline::gainEvent, currentGain);
+    recordEvent(AutomationTimeline::speedEvent, currentSpeed);
+    recordEvent(AutomationTimeline::wetEvent, effectsRack.getEffect(EffectsRack::reverbEffect).getAmount());
+    recordEvent(AutomationTimeline::freezeEvent, effectsRack.getReverb().getFreeze());
+    recordEvent(AutomationTimeline::reverseEvent, isReverse() ? 1.0 : 0.0);
+
+    // moving each effect to its slot in turn, from the first, rebuilds any order
+    const auto order = effectsRack.getEffectOrder();
+    for (int slot = 0; slot < order.size(); ++slot)
+    {
+        recordEvent(AutomationTimeline::effectSlotEvent, slot, order[slot]);
+    }
+
+    for (int type = 0; type < EffectsRack::numEffectTypes; ++type)
+    {
+        auto effect = (EffectsRack::EffectType)type;
+        recordEvent(AutomationTimeline::effectEnabledEvent, effectsRack.isEffectEnabled(effect) ? 1.0 : 0.0, type);
+        recordEvent(AutomationTimeline::effectAmountEvent, effectsRack.getEffect(effect).getAmount(), type);
+    }
+
+    recordEvent(AutomationTimeline::positionEvent, getPositionInSeconds());
+    if (transportSource.isPlaying())
+    {
+        recordEvent(AutomationTimeline::startEvent);
+    }
+    if (isScratching())
+    {
+        recordEvent(AutomationTimeline::scratchEvent, 1.0);
+    }
+}
+
+void DJAudioPlayer::recordEvent(AutomationTimeline::EventType type, double value, int effect, const juce::String& file)
+{
+    if (recorder != nullptr)
+    {
+        recorder->record(deckIndex, type, value, effect, file);
+    }
+}
+
+float DJAudioPlayer::getGain() const
+{
+    return faderGain.load(std::memory_order_relaxed);
+}
+
+void DJAudioPlayer::setCueEnabled(bool shouldBeCued)
+{
+    cueEnabled.store(shouldBeCued, std::memory_order_relaxed);
+}
+
+bool DJAudioPlayer::isCueEnabled() const
+{
+    return cueEnabled.load(std::memory_order_relaxed);
+}
+
+bool DJAudioPlayer::isOutputSilent() const
+{
+    return outputSilent.load(std::memory_order_relaxed);
+}
+
+DJAudioPlayer::StageStatistics DJAudioPlayer::getStageStatistics(Stage stage) const
+{
+    StageStatistics stats;
+    stats.secondsProcessing = juce::Time::highResolutionTicksToSeconds(stageTicks[stage].load());
+    stats.blocksProcessed = stageBlocksProcessed[stage].load();
+    stats.blocksSkipped = stageBlocksSkipped[stage].load();
+    return stats;
+}
+
+DJAudioPlayer::PlayheadReport DJAudioPlayer::getPlayheadReport()
+{
+    playheadReports.update();
+    return playheadReports.getReadSlot();
+}
+
+double DJAudioPlayer::PlayheadReport::getPositionAt(juce::int64 nowTicks) const
+{
+    const double elapsed = juce::Time::highResolutionTicksToSeconds(nowTicks - ticks);
+    return juce::jlimit(0.0, lengthSecs, positionSecs + rate * juce::jmax(0.0, elapsed));
+}
+
+AudioMeter& DJAudioPlayer::getMeter()
+{
+    return meter;
+}
+
+bool DJAudioPlayer::renderPlatter(const juce::AudioSourceChannelInfo& bufferToFill)
+{
+    // a track being swapped in: sit this block out rather than wait for it
+    const juce::SpinLock::ScopedTryLockType lock(sourceLock);
+    if (!lock.isLocked() || readerSource == nullptr || platterChunkSize == 0)
+    {
+        bufferToFill.clearActiveBufferRegion();
+        return false;
+    }
+    auto& source = *readerSource;
+
+    // carry on from the playhead: where the transport left it, or where a seek put it
+    const auto playhead = source.getNextReadPosition();
+    if (!platterActive || playhead != platterHandedOver)
+    {
+        platterPosition = (double)playhead;
     }
+    if (!platterActive)
+    {
+        // the platter starts off turning as fast as the deck was playing
+        platterRate = transportSource.isPlaying() ? resampleSource.getResamplingRatio() : 0.0;
+        platterActive = true;
+    }
+
+    bool audible = false;
+    for (int offset = 0; offset < bufferToFill.numSamples; offset += platterChunkSize)
+    {
+        const int numSamples = juce::jmin(platterChunkSize, bufferToFill.numSamples - offset);
+        audible = renderPlatterChunk(source, *bufferToFill.buffer, bufferToFill.startSample + offset, numSamples) || audible;
+    }
+
+    // the reader source keeps the playhead, so positions, seeks and the decoder's window follow
+    platterHandedOver = (juce::int64)platterPosition;
+    source.setNextReadPosition(platterHandedOver);
+    source.setDirection(scratching.load(std::memory_order_relaxed) ? ReadAheadAudioSource::both : ReadAheadAudioSource::backward);
+    return audible;
+}
+
+bool DJAudioPlayer::renderPlatterChunk(ReadAheadAudioSource& source, juce::AudioBuffer<float>& dest, int startSample, int numSamples)
+{
+    const double fileToDevice = getFileToDeviceRatio();
+    const double length = (double)source.getTotalLength();
+
+    // the rate to get to by the end of the chunk: following the hand, or turned by the motor
+    double wantedRate = 0;
+    if (scratching.load(std::memory_order_acquire))
+    {
+        const int started = scratchesStarted.load(std::memory_order_acquire);
+        if (started != scratchesSeen)
+        {
+            scratchesSeen = started;
+            scratchAnchor = platterPosition;
+        }
+
+        // closing the gap to the hand over a few milliseconds smooths out jerky mouse moves
+        const double target = scratchAnchor + scratchMovedSecs.load(std::memory_order_relaxed) * fileSampleRate.load();
+        wantedRate = juce::jlimit(-maxScratchRate * fileToDevice, maxScratchRate * fileToDevice,
+            (target - platterPosition) / (scratchFollowSeconds * deviceSampleRate));
+    }
+    else if (transportSource.isPlaying())
+    {
+        wantedRate = -resampleSource.getResamplingRatio();
+    }
+    wantedRate = juce::jlimit(-maxPlatterRate, maxPlatterRate, wantedRate);
+
+    // the rate ramps across the chunk; a first pass finds the span of the file it covers
+    const double rateStep = (wantedRate - platterRate) / numSamples;
+    double position = platterPosition;
+    double lowest = position;
+    double highest = position;
+    for (int i = 1; i <= numSamples; ++i)
+    {
+        position = juce::jlimit(0.0, length, position + platterRate + rateStep * i);
+        lowest = juce::jmin(lowest, position);
+        highest = juce::jmax(highest, position);
+    }
+
+    if (highest == lowest)
+    {
+        // standing still, or held against the start or end of the track
+        platterRate = wantedRate;
+        for (int channel = 0; channel < dest.getNumChannels(); ++channel)
+        {
+            dest.clear(channel, startSample, numSamples);
+        }
+        return false;
+    }
+
+    const auto first = (juce::int64)std::floor(lowest) - 1;
+    const int span = (int)((juce::int64)std::floor(highest) + 3 - first);
+    source.readDecoded(first, platterBuffer, span);
+
+    // then again, interpolating between the decoded samples
+    for (int channel = 0; channel < dest.getNumChannels(); ++channel)
+    {
+        const float* decoded = platterBuffer.getReadPointer(juce::jmin(channel, platterBuffer.getNumChannels() - 1));
+        float* output = dest.getWritePointer(channel, startSample);
+        position = platterPosition;
+        for (int i = 1; i <= numSamples; ++i)
+        {
+            position = juce::jlimit(0.0, length, position + platterRate + rateStep * i);
+            const double whole = std::floor(position);
+            output[i - 1] = interpolateHermite(decoded + ((juce::int64)whole - first - 1), (float)(position - whole));
+        }
+    }
+
+    platterPosition = position;
+    platterRate = wantedRate;
+    return true;
+}
+
+void DJAudioPlayer::stopPlatter()
+{
+    platterActive = false;
+
+    const juce::SpinLock::ScopedTryLockType lock(sourceLock);
+    if (lock.isLocked() && readerSource != nullptr)
+    {
+        readerSource->setDirection(ReadAheadAudioSource::forward);
+    }
+
+    // the resampler still holds audio from before the platter took over
+    resampleSource.flushBuffers();
+}
+
+int DJAudioPlayer::getNumDecodeUnderruns() const
+{
+    return readerSource != nullptr ? readerSource->getNumUnderruns() : 0;
+}
+
+double DJAudioPlayer::getSecondsBuffered() const
+{
+    return readerSource != nullptr ? readerSource->getSecondsDecodedAhead() : 0.0;
+}
+
+juce::URL DJAudioPlayer::getLoadedURL() const
+{
+    return loadedURL;
+}
+
+void DJAudioPlayer::recordStage(Stage stage, bool processed, juce::int64 startTicks)
+{
+    stageTicks[stage].fetch_add(juce::Time::getHighResolutionTicks() - startTicks, std::memory_order_relaxed);
+    if (processed)
+    {
+        stageBlocksProcessed[stage].fetch_add(1, std::memory_order_relaxed);
+    }
+    else
+    {
+        stageBlocksSkipped[stage].fetch_add(1, std::memory_order_relaxed);
+    }
+}
+DJAudioPlayer::TransportFeed::TransportFeed(juce::AudioTransportSource& _transport) : transport(_transport)
+{
+}
+
+void DJAudioPlayer::TransportFeed::prepareToPlay(int, double)
+{
+}
+
+void DJAudioPlayer::TransportFeed::releaseResources()
+{
+}
+
+void DJAudioPlayer::TransportFeed::getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill)
+{
+    transport.getNextAudioBlock(bufferToFill);
 }
@@ -9,17 +9,70 @@
 */
 
 #pragma once
-#include "../JuceLibraryCode/JuceHeader.h"
+#include <JuceHeader.h>
+#include <atomic>
+#include "EffectsRack.h"
+#include "AutomationTimeline.h"
+#include "ReadAheadAudioSource.h"
+#include "AudioMeter.h"
+#include "Mp3SeekIndex.h"
+#include "TaskScheduler.h"
 
 class DJAudioPlayer : public juce::AudioSource {
 public:
+    /** The processing stages of the deck chain, in signal order */
+    enum Stage
+    {
+        sourceStage = 0, // decoding and resampling
+        effectsStage,
+        numStages
+    };
+
+    /** Processing counters for one stage, collected on the audio thread */
+    struct StageStatistics
+    {
+        double secondsProcessing = 0;
+        juce::int64 blocksProcessed = 0;
+        juce::int64 blocksSkipped = 0;
+    };
+
+    /** Where the audio thread last left the playhead, to draw it from between blocks */
+    struct PlayheadReport
+    {
+        double positionSecs = 0;
+        double lengthSecs = 0;
+        double rate = 0;         // seconds of track per second, 0 while stopped
+        juce::int64 ticks = 0;   // high resolution ticks when the block was rendered
+
+        /** @returns: where the playhead should be by now, assuming it kept going */
+        double getPositionAt(juce::int64 nowTicks) const;
+    };
+
+    /** The deck controls a hardware controller can move, see applyControl() */
+    enum Control
+    {
+        playControl = 0,   // pressed: play or pause
+        cueControl,        // pressed: headphone cue on or off
+        reverseControl,    // pressed: reverse on or off
+        gainControl,       // 0 to 1
+        speedControl,      // 0 to 1 across the speed knob's range, normal speed in the middle
+        wetControl,        // 0 to 1
+        freezeControl,     // 0 to 1
+        filterControl,     // 0 to 1, no filtering in the middle
+        jogTouchControl,   // 1 when the platter is touched, 0 when let go
+        jogTurnControl,    // seconds of track to move the platter by
+        numControls
+    };
+
     /**
      * Constructor
      *
      * @param _formatManager: object for keeping a list of available audio formats, and for 
                               deciding which one to use to open a given file.
+     * @param _readAheadThread: thread to decode files on ahead of playback, or nullptr to
+                                decode on the thread that renders the deck (offline use)
      */
-    DJAudioPlayer(juce::AudioFormatManager& _formatManager);
+    DJAudioPlayer(juce::AudioFormatManager& _formatManager, juce::TimeSliceThread* _readAheadThread = nullptr);
 
     /**
      * Destructor
@@ -57,11 +110,26 @@ public:
 
     /**
      * Sets the volume output of the player.
+     * The fader is applied where the deck is mixed into the master, so the
+     * rendered block stays pre-fader for the cue bus.
      *
      * @param gain: 0 <= double <= 1
      */
     void setGain(double gain);
 
+    /** @returns: the fader gain to mix the deck into the master at */
+    float getGain() const;
+
+    /**
+     * Sends the deck to the headphone cue bus, or takes it off.
+     *
+     * @param shouldBeCued: true to pre-listen to this deck
+     */
+    void setCueEnabled(bool shouldBeCued);
+
+    /** @returns: true if the deck is on the cue bus */
+    bool isCueEnabled() const;
+
     /**
      * Controls the playback speed of the song. 
      * Controlled by a slider created in DeckGUI. 
@@ -71,6 +139,65 @@ public:
      */
     void setSpeed(double ratio);
 
+    /** @returns: the speed last set, 1 for normal */
+    double getSpeed() const;
+
+    /**
+     * Plays the track backwards at the deck's speed, or forwards again.
+     *
+     * @param shouldPlayBackwards: true for reverse
+     */
+    void setReverse(bool shouldPlayBackwards);
+
+    /** @returns: true if the deck plays backwards */
+    bool isReverse() const;
+
+    /**
+     * Puts a hand on the platter. Until endScratch() the track follows scratchMove() at
+     * whatever rate and direction the hand moves, and stands still when the hand does.
+     * The scratch is recorded for automation, move by move.
+     */
+    void beginScratch();
+
+    /**
+     * Moves the platter under the hand, from mouse drags or a jog wheel.
+     *
+     * @param deltaSeconds: how far to move the track, negative to pull it back
+     */
+    void scratchMove(double deltaSeconds);
+
+    /** Lets go of the platter, so the deck plays on as it did before the scratch. */
+    void endScratch();
+
+    /** @returns: true while a hand is on the platter */
+    bool isScratching() const;
+
+    /**
+     * Moves a control from a hardware controller. Called on the audio thread before the
+     * deck renders, so the move is heard in the next block: it only stores to atomics and
+     * never locks, allocates or records. Speed is handed to the resampler when the block
+     * starts. Pressing play does nothing here, as the transport can only be started and
+     * stopped from another thread, and the filter only sets its amount; controlApplied()
+     * does the rest.
+     *
+     * @param control: what was moved
+     * @param value: where to, see Control
+     */
+    void applyControl(Control control, double value);
+
+    /**
+     * Follows up a control applyControl() moved. Called on the message thread after it:
+     * starts or stops the deck for play, switches the filter on the first time it's moved,
+     * and records the new state for automation.
+     *
+     * @param control: what was moved
+     * @param value: the value given to applyControl()
+     */
+    void controlApplied(Control control, double value);
+
+    /** @returns: true if the transport is playing */
+    bool isPlaying() const;
+
     /**
      * Changes the current playback position in the source stream.
      *
@@ -103,18 +230,223 @@ public:
      */
     double getLengthInSeconds();
 
+    /**
+     * @returns: where the transport is in the track, from its read position in file samples.
+     *           It moves a block at a time, so two decks read between the same two blocks
+     *           are at the same moment.
+     */
+    double getPositionInSeconds() const;
+
     /** Sets the amount of reverb freeze */
     void setFreeze(float freezeAmt);
 
     /** Sets the amount of reverb wetLevel */
     void setWetLevel(float wetLevel);
 
+    /**
+     * Switches an effect in the deck's rack on or off.
+     *
+     * @param type: the effect
+     * @param shouldBeEnabled: true to switch it on
+     */
+    void setEffectEnabled(EffectsRack::EffectType type, bool shouldBeEnabled);
+
+    /**
+     * Sets the main control of an effect in the deck's rack.
+     *
+     * @param type: the effect
+     * @param amount: see DeckEffect::setAmount()
+     */
+    void setEffectAmount(EffectsRack::EffectType type, float amount);
+
+    /**
+     * Moves an effect to another place in the rack's order, the others keeping theirs.
+     *
+     * @param type: the effect
+     * @param slot: where in the order it should run, 0 for first
+     */
+    void moveEffect(EffectsRack::EffectType type, int slot);
+
+    /** @returns: the deck's effects chain */
+    EffectsRack& getEffectsRack();
+
+    /**
+     * Sends every later action on this deck to a recorder.
+     *
+     * @param _recorder: the recorder, or nullptr to stop sending
+     * @param _deckIndex: index the events are recorded under
+     */
+    void setAutomationRecorder(AutomationRecorder* _recorder, int _deckIndex);
+
+    /** Records the events needed to bring a fresh deck to this deck's current state */
+    void recordCurrentState();
+
+    /** @returns: true if the last rendered block was pure silence, so it can be left out of the mix */
+    bool isOutputSilent() const;
+
+    /**
+     * Gets how much work a stage of the chain has done and how often it was skipped.
+     *
+     * @param stage: the stage to query
+     */
+    StageStatistics getStageStatistics(Stage stage) const;
+
+    /**
+     * Picks up the latest playhead report from the audio thread. Only one thread, normally
+     * the message thread, may call this.
+     */
+    PlayheadReport getPlayheadReport();
+
+    /** @returns: the deck's meter, measuring its output before the fader */
+    AudioMeter& getMeter();
+
+    /** @returns: number of blocks the read-ahead thread didn't decode in time, for the current track */
+    int getNumDecodeUnderruns() const;
+
+    /** @returns: seconds of the track decoded ahead of the playhead, 0 with no track loaded */
+    double getSecondsBuffered() const;
+
+    /** @returns: the track last loaded, empty if none */
+    juce::URL getLoadedURL() const;
+
+    /** Fastest speed setSpeed() accepts */
+    static constexpr double maxSpeed = 3.0;
+
+    /** Fastest the platter turns while scratching, in seconds of track per second */
+    static constexpr double maxScratchRate = 4.0;
+
 private:
+    /** Feeds the transport to the resampler, leaving the transport for the player to prepare */
+    class TransportFeed : public juce::AudioSource
+    {
+    public:
+        TransportFeed(juce::AudioTransportSource& _transport);
+        void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
+        void releaseResources() override;
+        void getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill) override;
+
+    private:
+        juce::AudioTransportSource& transport;
+    };
+
     juce::AudioFormatManager& formatManager;
-    std::unique_ptr<juce::AudioFormatReaderSource> readerSource;
+    juce::TimeSliceThread* readAheadThread;
+    // builds the seek index of MP3s loaded without one
+    juce::SharedResourcePointer<TaskScheduler> scheduler;
+    std::unique_ptr<ReadAheadAudioSource> readerSource;
     juce::AudioTransportSource transportSource;
-    juce::ResamplingAudioSource resampleSource{ &transportSource, false, 2 };
+    TransportFeed transportFeed{ transportSource };
+    // the only resampler on the deck: file rate to device rate, times the speed
+    juce::ResamplingAudioSource resampleSource{ &transportFeed, false, 2 };
+
+    // the resampler's ratio, given to it by the audio thread at the start of each block
+    std::atomic<double> resamplingRatio{ 1.0 };
+
+    // highest file rate the resampler is prepared for without reallocating
+    static constexpr double maxFileSampleRate = 192000.0;
+    double deviceSampleRate = 0;
+    std::atomic<double> fileSampleRate{ 0 };
+
+    EffectsRack effectsRack;
+    AudioMeter meter;
+
+    // current state, for recordCurrentState()
+    juce::URL loadedURL;
+    double currentGain = 1.0;
+    double currentSpeed = 1.0;
+
+    // read by the mixer on the audio thread
+    std::atomic<float> faderGain{ 1.0f };
+    std::atomic<bool> cueEnabled{ false };
+
+    AutomationRecorder* recorder = nullptr;
+    bool jogTouched = false;   // the controller's platter, as controlApplied() last heard
+    int deckIndex = 0;
+
+    // the platter: plays at any rate, backwards included, reading the decoded window
+    // directly instead of going through the transport and resampler. Used while reversed
+    // or scratching; the rest is only touched on the audio thread
+    std::atomic<bool> reverse{ false };
+    std::atomic<bool> scratching{ false };
+    std::atomic<int> scratchesStarted{ 0 };
+    std::atomic<double> scratchMovedSecs{ 0 };  // since the hand went down
+    juce::SpinLock sourceLock;                  // keeps the reader source alive while the platter reads it
+
+    juce::AudioBuffer<float> platterBuffer;     // the decoded audio one chunk of output plays over
+    int platterChunkSize = 0;
+    double maxPlatterRate = 0;                  // file samples per output sample platterBuffer has room for
+    bool platterActive = false;
+    int scratchesSeen = 0;
+    double platterPosition = 0;                 // in file samples
+    double platterRate = 0;                     // file samples per output sample
+    double scratchAnchor = 0;                   // platterPosition when the hand went down
+    juce::int64 platterHandedOver = -1;         // the playhead last given to the reader source
+
+    /**
+     * Plays a block from the platter. Audio thread.
+     *
+     * @returns: false if the platter stood still and the block is silent
+     */
+    bool renderPlatter(const juce::AudioSourceChannelInfo& bufferToFill);
+
+    /** Plays one chunk of at most platterChunkSize samples, see renderPlatter() */
+    bool renderPlatterChunk(ReadAheadAudioSource& source, juce::AudioBuffer<float>& dest, int startSample, int numSamples);
+
+    /** Hands playback back to the transport at the platter's position. Audio thread. */
+    void stopPlatter();
+
+    /**
+     * Plays from a new reader, in place of the track's current one.
+     *
+     * @param reader: the track, now owned by the player
+     */
+    void setReader(juce::AudioFormatReader* reader);
+
+    /**
+     * Builds an MP3's seek index on the scheduler, then moves the deck onto it.
+     *
+     * @param track: the MP3 just loaded
+     */
+    void buildSeekIndex(const juce::File& track);
+
+    /**
+     * Reopens the track through its new index, if it's still loaded and not playing.
+     *
+     * @param track: the MP3 whose index was built
+     */
+    void seekIndexBuilt(const juce::File& track);
+
+    /** Puts a hand on the platter without recording it. Any thread. */
+    void touchPlatter();
+
+    /** Moves the platter under the hand without recording it. Any thread. */
+    void movePlatter(double deltaSeconds);
+
+    /** Lets go of the platter without recording it. Any thread. */
+    void releasePlatter();
+
+    /** Passes an event on to the recorder, if any */
+    void recordEvent(AutomationTimeline::EventType type, double value = 0, int effect = -1,
+        const juce::String& file = {});
+
+    /** @returns: file samples per device sample at normal speed */
+    double getFileToDeviceRatio() const;
+
+    /** Sets the resampler to convert the file's rate and apply the speed in the one ratio */
+    void updateResamplingRatio();
+
+    TripleBuffer<PlayheadReport> playheadReports;
+
+    // idle detection
+    int blocksSinceStopped = 0;
+    std::atomic<bool> outputSilent{ true };
+
+    std::atomic<juce::int64> stageTicks[numStages];
+    std::atomic<juce::int64> stageBlocksProcessed[numStages];
+    std::atomic<juce::int64> stageBlocksSkipped[numStages];
+
+    /** Adds a block's timing to a stage's counters */
+    void recordStage(Stage stage, bool processed, juce::int64 startTicks);
 
-    juce::ReverbAudioSource reverbSource{ &resampleSource, false };
-    juce::Reverb::Parameters reverbParameters;
+    JUCE_DECLARE_WEAK_REFERENCEABLE(DJAudioPlayer)
 };
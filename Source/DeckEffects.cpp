@@ -0,0 +1,335 @@
+/*
+  ==============================================================================
+
+    DeckEffects.cpp
+    Created: 19 Oct 2026 11:02:17am
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#include "DeckEffects.h"
+
+// how long amount changes take to settle, also longer than juce::Reverb's own 10ms ramp
+static const double amountRampSecs = 0.02;
+
+// juce::Reverb doubles its dry level, so this passes the deck at unity gain: the level it
+// has when the reverb is bypassed while dry, so the bypass doesn't jump the level
+static const float reverbDryLevel = 0.5f;
+
+
+DeckEffect::DeckEffect(const juce::String& _name) : name(_name)
+{
+}
+
+const juce::String& DeckEffect::getName() const
+{
+    return name;
+}
+
+void DeckEffect::setAmount(float newAmount)
+{
+    amount.store(juce::jlimit(-1.0f, 1.0f, newAmount));
+}
+
+float DeckEffect::getAmount() const
+{
+    return amount.load();
+}
+
+void DeckEffect::updateParameters(bool enabled)
+{
+    smoothedAmount.setTargetValue(enabled ? amount.load(std::memory_order_relaxed) : 0.0f);
+}
+
+bool DeckEffect::isActive() const
+{
+    return smoothedAmount.getTargetValue() != 0.0f || smoothedAmount.isSmoothing();
+}
+
+void DeckEffect::prepare(double _sampleRate, int maxBlockSize)
+{
+    sampleRate = _sampleRate;
+    smoothedAmount.reset(sampleRate, amountRampSecs);
+    smoothedAmount.setCurrentAndTargetValue(0.0f);
+    reset();
+}
+
+
+FilterEffect::FilterEffect() : DeckEffect("Filter")
+{
+}
+
+void FilterEffect::process(juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    // the cutoff only moves once per block, plenty for a hand-turned knob
+    const float value = smoothedAmount.skip(numSamples);
+    const double nyquistLimit = sampleRate * 0.45;
+
+    juce::IIRCoefficients coefficients;
+    if (value < 0)
+    {
+        // 20kHz down to 20Hz over ten octaves
+        const double cutoff = juce::jmin(nyquistLimit, 20000.0 * std::pow(2.0, value * 10.0));
+        coefficients = juce::IIRCoefficients::makeLowPass(sampleRate, cutoff, 0.9);
+    }
+    else
+    {
+        const double cutoff = juce::jmin(nyquistLimit, 20.0 * std::pow(2.0, value * 10.0));
+        coefficients = juce::IIRCoefficients::makeHighPass(sampleRate, cutoff, 0.9);
+    }
+
+    for (int channel = 0; channel < juce::jmin(2, buffer.getNumChannels()); ++channel)
+    {
+        filters[channel].setCoefficients(coefficients);
+        filters[channel].processSamples(buffer.getWritePointer(channel, startSample), numSamples);
+    }
+}
+
+void FilterEffect::reset()
+{
+    for (auto& filter : filters)
+    {
+        filter.reset();
+    }
+}
+
+
+DelayEffect::DelayEffect(const juce::String& _name, double _delaySecs, float _feedback)
+    : DeckEffect(_name),
+      delaySecs(_delaySecs),
+      feedback(_feedback)
+{
+}
+
+void DelayEffect::prepare(double _sampleRate, int maxBlockSize)
+{
+    delaySamples = juce::jmax(1, (int)(delaySecs * _sampleRate));
+    delayLine.setSize(2, delaySamples);
+    DeckEffect::prepare(_sampleRate, maxBlockSize);
+}
+
+void DelayEffect::process(juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    const int numChannels = juce::jmin(2, buffer.getNumChannels());
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float wet = smoothedAmount.getNextValue();
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            float* line = delayLine.getWritePointer(channel);
+            float* samples = buffer.getWritePointer(channel, startSample);
+
+            // the line is exactly delaySamples long, so the oldest sample sits at the write position
+            const float delayed = line[writePosition];
+            line[writePosition] = samples[i] + delayed * feedback;
+            samples[i] += delayed * wet;
+        }
+        writePosition = (writePosition + 1) % delaySamples;
+    }
+}
+
+void DelayEffect::reset()
+{
+    delayLine.clear();
+    writePosition = 0;
+}
+
+
+EchoEffect::EchoEffect() : DelayEffect("Echo", 0.5, 0.55f)
+{
+}
+
+void EchoEffect::process(juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    if (buffer.getNumChannels() < 2)
+    {
+        DelayEffect::process(buffer, startSample, numSamples);
+        return;
+    }
+
+    float* left = buffer.getWritePointer(0, startSample);
+    float* right = buffer.getWritePointer(1, startSample);
+    float* lineLeft = delayLine.getWritePointer(0);
+    float* lineRight = delayLine.getWritePointer(1);
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float wet = smoothedAmount.getNextValue();
+        const float delayedLeft = lineLeft[writePosition];
+        const float delayedRight = lineRight[writePosition];
+
+        // repeats bounce between the channels and lose some top end on each pass
+        dampingState[0] += 0.4f * (delayedRight - dampingState[0]);
+        dampingState[1] += 0.4f * (delayedLeft - dampingState[1]);
+        lineLeft[writePosition] = left[i] + dampingState[0] * feedback;
+        lineRight[writePosition] = right[i] + dampingState[1] * feedback;
+
+        left[i] += delayedLeft * wet;
+        right[i] += delayedRight * wet;
+        writePosition = (writePosition + 1) % delaySamples;
+    }
+}
+
+void EchoEffect::reset()
+{
+    DelayEffect::reset();
+    dampingState[0] = dampingState[1] = 0.0f;
+}
+
+
+FlangerEffect::FlangerEffect() : DeckEffect("Flanger")
+{
+}
+
+void FlangerEffect::prepare(double _sampleRate, int maxBlockSize)
+{
+    // 1-6ms sweep, plus headroom for the interpolation
+    delayLine.setSize(2, (int)(0.01 * _sampleRate) + 2);
+    DeckEffect::prepare(_sampleRate, maxBlockSize);
+}
+
+void FlangerEffect::process(juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    const int numChannels = juce::jmin(2, buffer.getNumChannels());
+    const int lineLength = delayLine.getNumSamples();
+    const double lfoIncrement = juce::MathConstants<double>::twoPi * 0.2 / sampleRate;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float depth = smoothedAmount.getNextValue();
+        const double delay = (0.0035 + 0.0025 * std::sin(lfoPhase)) * sampleRate;
+        lfoPhase += lfoIncrement;
+        if (lfoPhase >= juce::MathConstants<double>::twoPi)
+        {
+            lfoPhase -= juce::MathConstants<double>::twoPi;
+        }
+
+        double readPosition = writePosition - delay;
+        if (readPosition < 0)
+        {
+            readPosition += lineLength;
+        }
+        const int index = (int)readPosition;
+        const float fraction = (float)(readPosition - index);
+        const int nextIndex = (index + 1) % lineLength;
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            float* line = delayLine.getWritePointer(channel);
+            float* samples = buffer.getWritePointer(channel, startSample);
+
+            const float delayed = line[index] + fraction * (line[nextIndex] - line[index]);
+            line[writePosition] = samples[i] + delayed * 0.5f;
+            samples[i] = samples[i] * (1.0f - 0.5f * depth) + delayed * 0.5f * depth;
+        }
+        writePosition = (writePosition + 1) % lineLength;
+    }
+}
+
+void FlangerEffect::reset()
+{
+    delayLine.clear();
+    writePosition = 0;
+    lfoPhase = 0;
+}
+
+
+BitcrusherEffect::BitcrusherEffect() : DeckEffect("Crush")
+{
+}
+
+void BitcrusherEffect::process(juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    // 16 bits at no sample rate reduction is transparent, 4 bits held over 8 samples is not
+    const float value = smoothedAmount.skip(numSamples);
+    const float bits = 16.0f - 12.0f * std::abs(value);
+    const float step = 2.0f / std::pow(2.0f, bits);
+    const int holdLength = 1 + (int)(7.0f * std::abs(value));
+    const int numChannels = juce::jmin(2, buffer.getNumChannels());
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const bool takeSample = holdCounter == 0;
+        holdCounter = (holdCounter + 1) % holdLength;
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            float* samples = buffer.getWritePointer(channel, startSample);
+            if (takeSample)
+            {
+                heldSample[channel] = step * std::floor(samples[i] / step + 0.5f);
+            }
+            samples[i] = heldSample[channel];
+        }
+    }
+}
+
+void BitcrusherEffect::reset()
+{
+    heldSample[0] = heldSample[1] = 0.0f;
+    holdCounter = 0;
+}
+
+
+ReverbEffect::ReverbEffect() : DeckEffect("Reverb")
+{
+    // Set default reverb settings
+    reverbParameters.roomSize = 0;
+    reverbParameters.damping = 0;
+    reverbParameters.wetLevel = 0;
+    reverbParameters.dryLevel = reverbDryLevel;
+    reverb.setParameters(reverbParameters);
+}
+
+bool ReverbEffect::hasInfiniteTail() const
+{
+    return reverbParameters.freezeMode >= 0.5f;
+}
+
+void ReverbEffect::prepare(double _sampleRate, int maxBlockSize)
+{
+    reverb.setSampleRate(_sampleRate);
+    DeckEffect::prepare(_sampleRate, maxBlockSize);
+}
+
+void ReverbEffect::process(juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    // juce::Reverb ramps its own wet gain, so just hand it the target
+    const float wetLevel = smoothedAmount.getTargetValue();
+    const float freezeMode = freeze.load(std::memory_order_relaxed);
+    if (wetLevel != reverbParameters.wetLevel || freezeMode != reverbParameters.freezeMode)
+    {
+        reverbParameters.wetLevel = wetLevel;
+        reverbParameters.freezeMode = freezeMode;
+        reverb.setParameters(reverbParameters);
+    }
+    smoothedAmount.skip(numSamples);
+
+    if (buffer.getNumChannels() > 1)
+    {
+        reverb.processStereo(buffer.getWritePointer(0, startSample),
+            buffer.getWritePointer(1, startSample),
+            numSamples);
+    }
+    else
+    {
+        reverb.processMono(buffer.getWritePointer(0, startSample), numSamples);
+    }
+}
+
+void ReverbEffect::reset()
+{
+    reverb.reset();
+}
+
+void ReverbEffect::setFreeze(float freezeAmt)
+{
+    freeze.store(freezeAmt);
+}
+
+float ReverbEffect::getFreeze() const
+{
+    return freeze.load();
+}
@@ -0,0 +1,198 @@
+/*
+  ==============================================================================
+
+    DeckEffects.h
+    Created: 19 Oct 2026 11:02:17am
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <atomic>
+
+
+/**
+ * Base class for the effects in a deck's EffectsRack.
+ *
+ * Every effect has one main "amount" control, set from any thread and picked up by the
+ * audio thread at the start of each block. The amount is smoothed, and a disabled effect
+ * fades its amount to zero, so switching effects on and off mid-set doesn't click.
+ * All memory an effect needs is allocated in prepare(), never in process().
+ */
+class DeckEffect
+{
+public:
+    /**
+     * Constructor
+     *
+     * @param _name: name shown on the deck
+     */
+    DeckEffect(const juce::String& _name);
+
+    /** Destructor */
+    virtual ~DeckEffect() = default;
+
+    /** @returns: the effect name */
+    const juce::String& getName() const;
+
+    /**
+     * Sets the main control of the effect. Can be called from any thread.
+     *
+     * @param newAmount: 0 <= float <= 1, or -1 <= float <= 1 for bipolar effects
+     */
+    void setAmount(float newAmount);
+
+    /** @returns: the main control value last set */
+    float getAmount() const;
+
+    /**
+     * Picks up the latest amount. Called on the audio thread at the start of each block.
+     *
+     * @param enabled: false to fade the effect out
+     */
+    void updateParameters(bool enabled);
+
+    /** @returns: true if the effect currently changes the signal and has to be processed */
+    bool isActive() const;
+
+    /** @returns: true if the effect keeps sounding forever on silent input, e.g. a frozen reverb */
+    virtual bool hasInfiniteTail() const { return false; }
+
+    /**
+     * Allocates the effect's buffers. Called before playback starts, never on the audio thread.
+     *
+     * @param _sampleRate: the device sample rate
+     * @param maxBlockSize: the largest block process() will be called with
+     */
+    virtual void prepare(double _sampleRate, int maxBlockSize);
+
+    /**
+     * Processes a block in place. Called on the audio thread.
+     *
+     * @param buffer: the deck's audio
+     * @param startSample: first sample to process
+     * @param numSamples: number of samples to process
+     */
+    virtual void process(juce::AudioBuffer<float>& buffer, int startSample, int numSamples) = 0;
+
+    /** Clears any delay lines or filter state. */
+    virtual void reset() = 0;
+
+protected:
+    double sampleRate = 44100.0;
+    juce::SmoothedValue<float> smoothedAmount;
+
+private:
+    juce::String name;
+    std::atomic<float> amount{ 0.0f };
+};
+
+
+/** DJ-style filter: negative amounts sweep a low-pass down, positive amounts sweep a high-pass up */
+class FilterEffect : public DeckEffect
+{
+public:
+    FilterEffect();
+    void process(juce::AudioBuffer<float>& buffer, int startSample, int numSamples) override;
+    void reset() override;
+
+private:
+    juce::IIRFilter filters[2];
+};
+
+
+/** Feedback delay; the amount is the wet level */
+class DelayEffect : public DeckEffect
+{
+public:
+    /**
+     * Constructor
+     *
+     * @param _name: name shown on the deck
+     * @param _delaySecs: delay time
+     * @param _feedback: proportion of the delayed signal fed back into the line
+     */
+    DelayEffect(const juce::String& _name = "Delay", double _delaySecs = 0.25, float _feedback = 0.35f);
+    void prepare(double _sampleRate, int maxBlockSize) override;
+    void process(juce::AudioBuffer<float>& buffer, int startSample, int numSamples) override;
+    void reset() override;
+
+protected:
+    double delaySecs;
+    float feedback;
+    juce::AudioBuffer<float> delayLine;
+    int delaySamples = 1;
+    int writePosition = 0;
+};
+
+
+/** Ping-pong echo with darkening repeats; the amount is the wet level */
+class EchoEffect : public DelayEffect
+{
+public:
+    EchoEffect();
+    void process(juce::AudioBuffer<float>& buffer, int startSample, int numSamples) override;
+    void reset() override;
+
+private:
+    float dampingState[2] = { 0.0f, 0.0f };
+};
+
+
+/** Flanger: a short delay swept by a slow LFO; the amount is the depth */
+class FlangerEffect : public DeckEffect
+{
+public:
+    FlangerEffect();
+    void prepare(double _sampleRate, int maxBlockSize) override;
+    void process(juce::AudioBuffer<float>& buffer, int startSample, int numSamples) override;
+    void reset() override;
+
+private:
+    juce::AudioBuffer<float> delayLine;
+    int writePosition = 0;
+    double lfoPhase = 0;
+};
+
+
+/** Bit depth and sample rate reduction; the amount sets how crushed the signal is */
+class BitcrusherEffect : public DeckEffect
+{
+public:
+    BitcrusherEffect();
+    void process(juce::AudioBuffer<float>& buffer, int startSample, int numSamples) override;
+    void reset() override;
+
+private:
+    float heldSample[2] = { 0.0f, 0.0f };
+    int holdCounter = 0;
+};
+
+
+/** juce::Reverb; the amount is the wet level, the dry signal always passes at unity gain */
+class ReverbEffect : public DeckEffect
+{
+public:
+    ReverbEffect();
+    bool hasInfiniteTail() const override;
+    void prepare(double _sampleRate, int maxBlockSize) override;
+    void process(juce::AudioBuffer<float>& buffer, int startSample, int numSamples) override;
+    void reset() override;
+
+    /**
+     * Sets the amount of reverb freeze. Can be called from any thread.
+     *
+     * @param freezeAmt: 0 <= float <= 1, frozen above 0.5
+     */
+    void setFreeze(float freezeAmt);
+
+    /** @returns: the freeze amount last set */
+    float getFreeze() const;
+
+private:
+    juce::Reverb reverb;
+    juce::Reverb::Parameters reverbParameters;
+    std::atomic<float> freeze{ 0.0f };
+};
@@ -10,17 +10,25 @@
 
 #include <JuceHeader.h>
 #include "DeckGUI.h"
+#include <cmath>
 
 
 DeckGUI::DeckGUI(int _id,
     DJAudioPlayer* _player,
-    juce::AudioFormatManager& formatManagerToUse,
-    juce::AudioThumbnailCache& cacheToUse
+    juce::AudioFormatManager& formatManagerToUse
 ) : id(_id),
     player(_player),
-    waveformDisplay(formatManagerToUse, cacheToUse)
+    waveformDisplay(formatManagerToUse),
+    scrollingWaveform(formatManagerToUse)
 {
     addAndMakeVisible(waveformDisplay);
+    addAndMakeVisible(scrollingWaveform);
+    scrollingWaveform.onScratchStart = [this] { player->beginScratch(); };
+    scrollingWaveform.onScratchMove = [this](double seconds) { player->scratchMove(seconds); };
+    scrollingWaveform.onScratchEnd = [this] { player->endScratch(); };
+    addChildComponent(spectrumDisplay);
+    addAndMakeVisible(levelMeter);
+    levelMeter.onSpectrumToggled = [this](bool enabled) { spectrumDisplay.setVisible(enabled); };
     addAndMakeVisible(wetSlider);
     addAndMakeVisible(freezeSlider);
     addAndMakeVisible(volSlider);
@@ -95,6 +103,32 @@ DeckGUI::DeckGUI(int _id,
     freezeSlider.setRange(0.0, 1.0);
     freezeSlider.setNumDecimalPlacesToDisplay(2);
 
+    // effects rack switches
+    auto& rack = player->getEffectsRack();
+    for (int type = 0; type < EffectsRack::numEffectTypes; ++type)
+    {
+        auto* button = effectButtons.add(new juce::TextButton(rack.getEffect((EffectsRack::EffectType)type).getName()));
+        button->setColour(juce::TextButton::buttonOnColourId, juce::Colours::coral);
+        button->setTooltip("Click to switch on/off, shift-click to move earlier in the chain");
+        button->addListener(this);
+        addAndMakeVisible(button);
+    }
+    updateEffectButtons();
+
+    addAndMakeVisible(cueButton);
+    cueButton.setClickingTogglesState(true);
+    cueButton.setColour(juce::TextButton::buttonColourId, juce::Colours::grey);
+    cueButton.setColour(juce::TextButton::buttonOnColourId, juce::Colours::coral);
+    cueButton.setTooltip("Click to pre-listen to this deck on the headphone outputs (3/4)");
+    cueButton.addListener(this);
+
+    addAndMakeVisible(reverseButton);
+    reverseButton.setClickingTogglesState(true);
+    reverseButton.setColour(juce::TextButton::buttonColourId, juce::Colours::grey);
+    reverseButton.setColour(juce::TextButton::buttonOnColourId, juce::Colours::coral);
+    reverseButton.setTooltip("Click to play the deck backwards. Drag the waveform above to scratch");
+    reverseButton.addListener(this);
+
     // track controls - button images
     playButton.setImages(true, true, true,
         playPauseImage, 1.0f, juce::Colours::coral,
@@ -110,14 +144,10 @@ DeckGUI::DeckGUI(int _id,
         rewindButtonImage, 1.0f, juce::Colours::coral,
         rewindButtonImage, 1.0f, juce::Colour(0x33000000),
         rewindButtonImage, 1.0f, juce::Colour(0x55000000));
-
-    // every 300 miliseconds
-    startTimer(300);
 }
 
 DeckGUI::~DeckGUI()
 {
-    stopTimer();
 }
 
 void DeckGUI::paint(juce::Graphics& g)
@@ -130,13 +160,30 @@ void DeckGUI::paint(juce::Graphics& g)
 void DeckGUI::resized()
 {
     double rowH = getHeight() / 20;
-    waveformDisplay.setBounds(0, 0, getWidth(), 4 * rowH);
+    // close-up scrolling around the playhead, and the whole track under it
+    scrollingWaveform.setBounds(0, 0, getWidth(), 2.5 * rowH);
+    waveformDisplay.setBounds(0, 2.5 * rowH, getWidth(), 1.5 * rowH);
+    spectrumDisplay.setBounds(0, 0, getWidth(), 4 * rowH);
     posSlider.setBounds(0, 4 * rowH, getWidth(), rowH);
+
+    // effect switches, in the order the rack runs them
+    auto order = player->getEffectsRack().getEffectOrder();
+    for (int slot = 0; slot < order.size(); ++slot)
+    {
+        effectButtons[order[slot]]->setBounds(slot * getWidth() / order.size(), 5 * rowH,
+            getWidth() / order.size(), rowH);
+    }
     
-    wetSlider.setBounds(0, 6 * rowH, getWidth() / 2,4 * rowH);
-    freezeSlider.setBounds(getWidth() / 2, 6 * rowH, getWidth() / 2, 4 * rowH);
-    volSlider.setBounds(0, 11 * rowH, getWidth() / 2, 4 * rowH);
-    speedSlider.setBounds(getWidth() / 2, 11 * rowH, getWidth() / 2, 4 * rowH);
+    // knobs, with the level meter down their right-hand side
+    const int meterWidth = 16;
+    const int knobsWidth = getWidth() - meterWidth;
+    wetSlider.setBounds(0, 6 * rowH, knobsWidth / 2, 4 * rowH);
+    freezeSlider.setBounds(knobsWidth / 2, 6 * rowH, knobsWidth / 2, 4 * rowH);
+    volSlider.setBounds(0, 11 * rowH, knobsWidth / 2, 4 * rowH);
+    speedSlider.setBounds(knobsWidth / 2, 11 * rowH, knobsWidth / 2, 4 * rowH);
+    levelMeter.setBounds(knobsWidth, 6 * rowH, meterWidth, 9 * rowH);
+    cueButton.setBounds(getWidth() / 4, 15.25 * rowH, getWidth() / 4, rowH);
+    reverseButton.setBounds(getWidth() / 2, 15.25 * rowH, getWidth() / 4, rowH);
 
     rewindButton.setBounds(0, 16.5 * rowH, getWidth() / 4, 3 * rowH);
     playButton.setBounds(getWidth() / 4, 16.5 * rowH, 2 * getWidth() / 4, 3 * rowH);
@@ -176,6 +223,45 @@ void DeckGUI::buttonClicked(juce::Button* button)
             player->setPositionRelative(player->getPositionRelative() - 0.05);
         }
     }
+    else if (button == &cueButton)
+    {
+        player->setCueEnabled(cueButton.getToggleState());
+    }
+    else if (button == &reverseButton)
+    {
+        player->setReverse(reverseButton.getToggleState());
+    }
+    else if (effectButtons.contains(button))
+    {
+        auto& rack = player->getEffectsRack();
+        auto type = (EffectsRack::EffectType)effectButtons.indexOf(button);
+
+        if (juce::ModifierKeys::currentModifiers.isShiftDown())
+        {
+            // swap with the effect before it
+            int slot = rack.getEffectOrder().indexOf(type);
+            if (slot > 0)
+            {
+                player->moveEffect(type, slot - 1);
+            }
+        }
+        else
+        {
+            player->setEffectEnabled(type, !rack.isEffectEnabled(type));
+        }
+        updateEffectButtons();
+    }
+}
+
+void DeckGUI::updateEffectButtons()
+{
+    auto& rack = player->getEffectsRack();
+    for (int type = 0; type < effectButtons.size(); ++type)
+    {
+        effectButtons[type]->setToggleState(rack.isEffectEnabled((EffectsRack::EffectType)type),
+            juce::NotificationType::dontSendNotification);
+    }
+    resized();
 }
 
 
@@ -212,19 +298,67 @@ void DeckGUI::filesDropped(const juce::StringArray& files, int x, int y)
 {
     if (files.size() == 1)
     {
-        player->loadURL(juce::URL{ juce::File{ files[0] } });
+        loadFile(juce::URL{ juce::File{ files[0] } });
     }
 }
 
-void DeckGUI::timerCallback()
+void DeckGUI::controlMoved(DJAudioPlayer::Control control)
 {
-    waveformDisplay.setPositionRelative(player->getPositionRelative());
-    posSlider.setValue(player->getPositionRelative());
+    auto& rack = player->getEffectsRack();
+    switch (control)
+    {
+        case DJAudioPlayer::playControl:
+            isOn = player->isPlaying();
+            playButton.setToggleState(isOn, juce::dontSendNotification);
+            break;
+        case DJAudioPlayer::cueControl:
+            cueButton.setToggleState(player->isCueEnabled(), juce::dontSendNotification);
+            break;
+        case DJAudioPlayer::reverseControl:
+            reverseButton.setToggleState(player->isReverse(), juce::dontSendNotification);
+            break;
+        case DJAudioPlayer::gainControl:
+            volSlider.setValue(player->getGain(), juce::dontSendNotification);
+            break;
+        case DJAudioPlayer::speedControl:
+            speedSlider.setValue(player->getSpeed(), juce::dontSendNotification);
+            break;
+        case DJAudioPlayer::wetControl:
+            wetSlider.setValue(rack.getEffect(EffectsRack::reverbEffect).getAmount(), juce::dontSendNotification);
+            break;
+        case DJAudioPlayer::freezeControl:
+            freezeSlider.setValue(rack.getReverb().getFreeze(), juce::dontSendNotification);
+            break;
+        default:
+            // the filter has no knob, and the jog wheel shows on the waveforms
+            break;
+    }
+}
+
+void DeckGUI::updatePlayhead()
+{
+    const auto report = player->getPlayheadReport();
+    if (report.lengthSecs <= 0)
+    {
+        return;
+    }
+
+    const double position = report.getPositionAt(juce::Time::getHighResolutionTicks());
+    const double relative = position / report.lengthSecs;
+    waveformDisplay.setPositionRelative(relative);
+    scrollingWaveform.setPosition(position);
+
+    // the slider only moves when it would show, and never out from under the mouse
+    if (!posSlider.isMouseButtonDown() && std::abs(relative - posSlider.getValue()) * posSlider.getWidth() >= 1.0)
+    {
+        posSlider.setValue(relative, juce::dontSendNotification);
+    }
 }
 
 void DeckGUI::loadFile(juce::URL audioURL)
 {
     player->loadURL(audioURL);
     waveformDisplay.loadURL(audioURL);
+    scrollingWaveform.loadURL(audioURL);
 
 }
@@ -13,14 +13,16 @@
 #include <JuceHeader.h>
 #include "DJAudioPlayer.h"
 #include "WaveformDisplay.h"
+#include "ScrollingWaveform.h"
+#include "LevelMeterComponent.h"
+#include "SpectrumDisplay.h"
 #include "KnobsLookAndFeel.h"
 
 
 class DeckGUI : public juce::Component,
     public juce::Button::Listener,
     public juce::Slider::Listener,
-    public juce::FileDragAndDropTarget,
-    public juce::Timer
+    public juce::FileDragAndDropTarget
 {
 public:
     /**
@@ -29,12 +31,10 @@ public:
         @param _id: unique id for the object
         @param _player: unique player for the deck
         @param formatManagerToUse: shared AudioFormatManager object
-        @param cacheToUse: shared AudioThumbnailCache
      */
     DeckGUI(int _id,
         DJAudioPlayer* player,
-        juce::AudioFormatManager& formatManagerToUse,
-        juce::AudioThumbnailCache& cacheToUse
+        juce::AudioFormatManager& formatManagerToUse
     );
 
     /**
@@ -94,12 +94,13 @@ public:
      * @param y: the mouse y position, relative to this component
      */
     void filesDropped(const juce::StringArray& files, int x, int y) override;
-    
+
     /**
-     * Pure virtual function.
-     * The user-defined callback routine that actually gets called periodically.
+     * Shows a control a MIDI controller or the Auto-DJ moved, without sending it back to the player.
+     *
+     * @param control: the control that moved
      */
-    void timerCallback() override;
+    void controlMoved(DJAudioPlayer::Control control);
 
 private:
 
@@ -120,32 +121,50 @@ private:
     juce::Slider freezeSlider;
     juce::Slider volSlider;
 
+    // one switch per effect in the deck's rack, laid out in processing order
+    juce::OwnedArray<juce::TextButton> effectButtons;
+
+    /** Shows the rack's on/off state on the effect buttons and lays them out in rack order */
+    void updateEffectButtons();
+
+    // pre-listen to the deck on the headphone outputs
+    juce::TextButton cueButton{ "CUE" };
+
+    // play the deck backwards
+    juce::TextButton reverseButton{ "REV" };
+
     juce::SharedResourcePointer<juce::TooltipWindow> sharedTooltip;
 
     DJAudioPlayer* player;
     WaveformDisplay waveformDisplay;
+    ScrollingWaveform scrollingWaveform;
+
+    // the deck's levels before the fader, and its spectrum over the waveform when asked for
+    LevelMeterComponent levelMeter{ player->getMeter() };
+    SpectrumDisplay spectrumDisplay{ player->getMeter() };
+
+    // moves the playhead every frame, carrying on from the audio thread's last report
+    juce::VBlankAttachment vBlank{ this, [this] { updatePlayhead(); } };
+
+    /** Puts the playhead where it should be by now on the waveforms and the position slider */
+    void updatePlayhead();
 
     void loadFile(juce::URL audioURL);
     // allow access from PlaylistComponent to private members of this class DeckGUI
     friend class PlaylistComponent; 
 
-    // play button
+    // transport button images, compiled in from Assets/. The image cache is keyed on the
+    // data, so they're decoded once for the first deck and shared by the other
     juce::ImageButton playButton;
-    juce::File playButtonFile = juce::File::getSpecialLocation
-    (juce::File::SpecialLocationType::userDesktopDirectory).getChildFile("playpause.png");
-    juce::Image playPauseImage = juce::ImageCache::getFromFile(playButtonFile);
+    juce::Image playPauseImage = juce::ImageCache::getFromMemory(BinaryData::playpause_png, BinaryData::playpause_pngSize);
 
     // fast forward button
     juce::ImageButton forwardButton;
-    juce::File forwardButtonFile = juce::File::getSpecialLocation
-    (juce::File::SpecialLocationType::userDesktopDirectory).getChildFile("forward-button.png");
-    juce::Image forwardButtonImage = juce::ImageCache::getFromFile(forwardButtonFile);
+    juce::Image forwardButtonImage = juce::ImageCache::getFromMemory(BinaryData::forwardbutton_png, BinaryData::forwardbutton_pngSize);
 
     // fast rewind button
     juce::ImageButton rewindButton;
-    juce::File rewindButtonFile = juce::File::getSpecialLocation
-    (juce::File::SpecialLocationType::userDesktopDirectory).getChildFile("rewind.png");
-    juce::Image rewindButtonImage = juce::ImageCache::getFromFile(rewindButtonFile);
+    juce::Image rewindButtonImage = juce::ImageCache::getFromMemory(BinaryData::rewind_png, BinaryData::rewind_pngSize);
 
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DeckGUI);
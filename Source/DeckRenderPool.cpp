@@ -0,0 +1,555 @@
+/*
+  ==============================================================================
+
+    DeckRenderPool.cpp
+    Created: 19 Oct 2026 9:12:40am
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#include "DeckRenderPool.h"
+#include "RealtimeSafety.h"
+
+#if JUCE_LINUX
+ #include <climits>
+ #include <ctime>
+ #include <linux/futex.h>
+ #include <sys/syscall.h>
+ #include <unistd.h>
+#elif JUCE_WINDOWS
+ #include <windows.h>
+ #pragma comment(lib, "Synchronization.lib")
+#endif
+
+// workers keep looking for jobs for this long after their last one before they park,
+// which covers the chunks of one oversized device block
+static const double workerSpinSecs = 0.0002;
+
+// a parked worker wakes up this often to check whether it should exit
+static const int workerParkTimeoutMs = 100;
+
+// how much of a chunk's period the audio thread waits for decks the workers are still
+// rendering before it leaves them out of the chunk; the rest is left for mixing
+static const double joinDeadlineProportion = 0.5;
+
+
+DeckRenderPool::DeckRenderPool()
+{
+}
+
+DeckRenderPool::~DeckRenderPool()
+{
+    stopWorkers();
+}
+
+void DeckRenderPool::addDeck(DJAudioPlayer* player)
+{
+    auto* slot = slots.add(new DeckSlot());
+    slot->player = player;
+}
+
+void DeckRenderPool::prepareToPlay(int samplesPerBlockExpected, double sampleRate)
+{
+    maxBlockSize = juce::jmax(1, samplesPerBlockExpected);
+    currentSampleRate = sampleRate;
+
+    for (auto* slot : slots)
+    {
+        slot->buffer.setSize(2, maxBlockSize);
+        slot->late = false;
+        slot->state.store(jobIdle);
+        slot->mixedGain = slot->player->getGain();
+        slot->player->prepareToPlay(maxBlockSize, sampleRate);
+    }
+    mixedCueMix = cueMix.load();
+    crossfaderPosition = crossfaderTarget.load();
+    crossfaderStep = 0;
+    crossfaderRequestsSeen = crossfaderRequests.load();
+    resetStatistics();
+}
+
+void DeckRenderPool::releaseResources()
+{
+    for (auto* slot : slots)
+    {
+        slot->player->releaseResources();
+    }
+}
+
+void DeckRenderPool::renderAndMix(const juce::AudioSourceChannelInfo& bufferToFill)
+{
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+
+    // a device may ask for more than it promised in prepareToPlay, so render in
+    // chunks that fit the preallocated deck buffers rather than reallocating here
+    int done = 0;
+    while (done < bufferToFill.numSamples)
+    {
+        const int chunk = juce::jmin(bufferToFill.numSamples - done, maxBlockSize);
+        renderChunk(*bufferToFill.buffer, bufferToFill.startSample + done, chunk);
+        done += chunk;
+    }
+
+    // deadline accounting: how much of the buffer period the decks used up
+    if (currentSampleRate > 0 && bufferToFill.numSamples > 0)
+    {
+        const double elapsed = juce::Time::highResolutionTicksToSeconds(
+            juce::Time::getHighResolutionTicks() - startTicks);
+        const double load = elapsed * currentSampleRate / bufferToFill.numSamples;
+
+        lastLoad.store(load, std::memory_order_relaxed);
+        if (load > peakLoad.load(std::memory_order_relaxed))
+        {
+            peakLoad.store(load, std::memory_order_relaxed);
+        }
+        if (load > 1.0)
+        {
+            deadlineMisses.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+void DeckRenderPool::renderChunk(juce::AudioBuffer<float>& output, int startSample, int numSamples)
+{
+    const bool realtime = RealtimeSafety::isInRealtimeSection();
+    for (auto* slot : slots)
+    {
+        if (slot->late)
+        {
+            // a late job that has since finished rendered audio whose time has passed,
+            // so it's dropped and the deck gets a job again
+            int expected = jobDone;
+            if (!slot->state.compare_exchange_strong(expected, jobIdle, std::memory_order_acquire))
+            {
+                continue;
+            }
+            slot->late = false;
+        }
+        slot->numSamples = numSamples;
+        slot->realtime = realtime;
+    }
+
+    if (parallel.load(std::memory_order_acquire))
+    {
+        // publish every deck but the first as a job, then render the first one here
+        const auto dispatchTicks = juce::Time::getHighResolutionTicks();
+        for (int i = 1; i < slots.size(); ++i)
+        {
+            if (!slots[i]->late)
+            {
+                slots[i]->state.store(jobPending, std::memory_order_release);
+            }
+        }
+        wakeWorkers();
+
+        if (slots.size() > 0)
+        {
+            renderSlot(*slots[0]);
+        }
+
+        // join: take over every job no worker has claimed yet, so the audio thread only
+        // waits on decks that are already being rendered
+        for (int i = 1; i < slots.size(); ++i)
+        {
+            auto& slot = *slots[i];
+            int expected = jobPending;
+            if (!slot.late && slot.state.compare_exchange_strong(expected, jobRunning, std::memory_order_acquire))
+            {
+                renderSlot(slot);
+                slot.state.store(jobDone, std::memory_order_relaxed);
+            }
+        }
+
+        // and waits on those only until the deadline, unless told to wait however long it takes;
+        // a deck that misses it is left out of the chunk until its job finishes
+        const bool waitForever = !meetDeadline.load(std::memory_order_relaxed);
+        const auto deadlineTicks = dispatchTicks + juce::Time::secondsToHighResolutionTicks(
+            joinDeadlineProportion * numSamples / juce::jmax(1.0, currentSampleRate));
+        for (int i = 1; i < slots.size(); ++i)
+        {
+            auto& slot = *slots[i];
+            if (!slot.late)
+            {
+                while (slot.state.load(std::memory_order_acquire) != jobDone
+                       && (waitForever || juce::Time::getHighResolutionTicks() < deadlineTicks))
+                {
+                }
+
+                if (slot.state.load(std::memory_order_acquire) == jobDone)
+                {
+                    slot.state.store(jobIdle, std::memory_order_relaxed);
+                    continue;
+                }
+                slot.late = true;
+            }
+            lateDecks.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    else
+    {
+        // a job left late by the workers before they were stopped finishes on its own
+        for (auto* slot : slots)
+        {
+            if (!slot->late)
+            {
+                renderSlot(*slot);
+            }
+        }
+    }
+
+    mixChunk(output, startSample, numSamples);
+}
+
+void DeckRenderPool::mixChunk(juce::AudioBuffer<float>& output, int startSample, int numSamples)
+{
+    const int numMasterChannels = juce::jmin(output.getNumChannels(), 2);
+    const bool hasCueOutputs = output.getNumChannels() >= cueLeftChannel + 2;
+
+    for (int channel = 0; channel < (hasCueOutputs ? cueLeftChannel + 2 : numMasterChannels); ++channel)
+    {
+        output.clear(channel, startSample, numSamples);
+    }
+
+    // one pass over the deck buffers feeds both buses, leaving out the decks that
+    // reported silence; fader and crossfader moves are ramped across the block so they
+    // don't click
+    const float crossfader = advanceCrossfader(numSamples);
+    for (int index = 0; index < slots.size(); ++index)
+    {
+        auto* slot = slots.getUnchecked(index);
+        if (slot->late)
+        {
+            // nothing was rendered for this chunk, and playing an old block again would
+            // repeat audio; the deck drops out and fades back in from silence
+            slot->mixedGain = 0.0f;
+            continue;
+        }
+
+        const auto& buffer = slot->buffer;
+        const float gain = slot->player->getGain() * getCrossfaderGain(index, crossfader);
+        if (!slot->player->isOutputSilent())
+        {
+            for (int channel = 0; channel < numMasterChannels; ++channel)
+            {
+                output.addFromWithRamp(channel, startSample,
+                    buffer.getReadPointer(channel % buffer.getNumChannels()),
+                    numSamples, slot->mixedGain, gain);
+            }
+
+            if (hasCueOutputs && slot->player->isCueEnabled())
+            {
+                for (int channel = 0; channel < 2; ++channel)
+                {
+                    output.addFrom(cueLeftChannel + channel, startSample,
+                        buffer.getReadPointer(channel % buffer.getNumChannels()), numSamples);
+                }
+            }
+        }
+        slot->mixedGain = gain;
+    }
+
+    if (hasCueOutputs)
+    {
+        mixHeadphones(output, startSample, numSamples);
+    }
+
+    // any further outputs carry the master, as they always have
+    for (int channel = hasCueOutputs ? cueLeftChannel + 2 : numMasterChannels; channel < output.getNumChannels(); ++channel)
+    {
+        output.copyFrom(channel, startSample, output.getReadPointer(channel % 2, startSample), numSamples);
+    }
+}
+
+float DeckRenderPool::advanceCrossfader(int numSamples)
+{
+    const int requests = crossfaderRequests.load(std::memory_order_acquire);
+    const float target = crossfaderTarget.load(std::memory_order_relaxed);
+    if (requests != crossfaderRequestsSeen)
+    {
+        crossfaderRequestsSeen = requests;
+        const double rampSamples = crossfaderRampSeconds.load(std::memory_order_relaxed) * currentSampleRate;
+        crossfaderStep = rampSamples >= 1.0 ? (float)((target - crossfaderPosition) / rampSamples) : target - crossfaderPosition;
+    }
+
+    crossfaderPosition += crossfaderStep * numSamples;
+    if ((crossfaderStep >= 0 && crossfaderPosition >= target) || (crossfaderStep < 0 && crossfaderPosition <= target))
+    {
+        crossfaderPosition = target;
+        crossfaderStep = 0;
+    }
+    return crossfaderPosition;
+}
+
+float DeckRenderPool::getCrossfaderGain(int deckIndex, float position)
+{
+    // full level up to the middle, then a quarter sine down to nothing at the far side
+    const float towardsDeck = deckIndex == 0 ? 1.0f - position : deckIndex == 1 ? position : 0.5f;
+    return std::sin(juce::jmin(1.0f, 2.0f * towardsDeck) * juce::MathConstants<float>::halfPi);
+}
+
+void DeckRenderPool::mixHeadphones(juce::AudioBuffer<float>& output, int startSample, int numSamples)
+{
+    const int cueRightChannel = cueLeftChannel + 1;
+    const float mix = cueMix.load(std::memory_order_relaxed);
+
+    if (splitCue.load(std::memory_order_relaxed))
+    {
+        // cue in mono on the left ear, master in mono on the right
+        output.addFrom(cueLeftChannel, startSample, output.getReadPointer(cueRightChannel, startSample), numSamples);
+        output.applyGain(cueLeftChannel, startSample, numSamples, 0.5f);
+        output.copyFrom(cueRightChannel, startSample, output.getReadPointer(0, startSample), numSamples, 0.5f);
+        output.addFrom(cueRightChannel, startSample, output.getReadPointer(1, startSample), numSamples, 0.5f);
+    }
+    else
+    {
+        // crossfade from the cue bus to the master as the mix goes up
+        for (int channel = 0; channel < 2; ++channel)
+        {
+            output.applyGainRamp(cueLeftChannel + channel, startSample, numSamples, 1.0f - mixedCueMix, 1.0f - mix);
+            output.addFromWithRamp(cueLeftChannel + channel, startSample,
+                output.getReadPointer(channel, startSample), numSamples, mixedCueMix, mix);
+        }
+    }
+    mixedCueMix = mix;
+}
+
+void DeckRenderPool::renderSlot(DeckSlot& slot)
+{
+    juce::AudioSourceChannelInfo info(&slot.buffer, 0, slot.numSamples);
+    slot.player->getNextAudioBlock(info);
+}
+
+bool DeckRenderPool::runPendingJob()
+{
+    for (auto* slot : slots)
+    {
+        int expected = jobPending;
+        if (slot->state.compare_exchange_strong(expected, jobRunning, std::memory_order_acquire))
+        {
+            if (slot->realtime)
+            {
+                RealtimeSafety::ScopedRealtimeSection realtimeSection;
+                renderSlot(*slot);
+            }
+            else
+            {
+                renderSlot(*slot);
+            }
+            slot->state.store(jobDone, std::memory_order_release);
+            return true;
+        }
+    }
+    return false;
+}
+
+void DeckRenderPool::wakeWorkers()
+{
+    // the generation is bumped before the count is read, and a worker counts itself
+    // before it checks the generation, so one of the two always sees the other
+    wakeGeneration.fetch_add(1);
+    if (parkedWorkers.load() == 0)
+    {
+        return;
+    }
+
+   #if JUCE_LINUX
+    syscall(SYS_futex, reinterpret_cast<juce::uint32*>(&wakeGeneration), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+   #elif JUCE_WINDOWS
+    WakeByAddressAll(&wakeGeneration);
+   #endif
+}
+
+void DeckRenderPool::parkWorker(juce::uint32 seenGeneration)
+{
+    parkedWorkers.fetch_add(1);
+    if (wakeGeneration.load() == seenGeneration)
+    {
+       #if JUCE_LINUX
+        struct timespec timeout = { 0, workerParkTimeoutMs * 1000000L };
+        syscall(SYS_futex, reinterpret_cast<juce::uint32*>(&wakeGeneration), FUTEX_WAIT_PRIVATE, seenGeneration, &timeout, nullptr, 0);
+       #elif JUCE_WINDOWS
+        WaitOnAddress(&wakeGeneration, &seenGeneration, sizeof(seenGeneration), (DWORD)workerParkTimeoutMs);
+       #else
+        // nothing to wait on without blocking the audio thread, so poll; the audio
+        // thread renders any job still pending when it joins
+        juce::Thread::sleep(1);
+       #endif
+    }
+    parkedWorkers.fetch_sub(1);
+}
+
+void DeckRenderPool::setParallelRendering(bool shouldRenderInParallel)
+{
+    if (shouldRenderInParallel == parallel.load())
+    {
+        return;
+    }
+
+    if (shouldRenderInParallel)
+    {
+        startWorkers();
+        parallel.store(true, std::memory_order_release);
+    }
+    else
+    {
+        parallel.store(false, std::memory_order_release);
+        stopWorkers();
+    }
+}
+
+bool DeckRenderPool::isParallelRendering() const
+{
+    return parallel.load();
+}
+
+void DeckRenderPool::setJoinDeadline(bool shouldMeetDeadline)
+{
+    meetDeadline.store(shouldMeetDeadline, std::memory_order_relaxed);
+}
+
+void DeckRenderPool::setCueMix(float mix)
+{
+    cueMix.store(juce::jlimit(0.0f, 1.0f, mix), std::memory_order_relaxed);
+}
+
+float DeckRenderPool::getCueMix() const
+{
+    return cueMix.load(std::memory_order_relaxed);
+}
+
+void DeckRenderPool::setSplitCue(bool shouldSplit)
+{
+    splitCue.store(shouldSplit, std::memory_order_relaxed);
+}
+
+bool DeckRenderPool::isSplitCue() const
+{
+    return splitCue.load(std::memory_order_relaxed);
+}
+
+void DeckRenderPool::setCrossfader(float position, double rampSeconds)
+{
+    crossfaderTarget.store(juce::jlimit(0.0f, 1.0f, position), std::memory_order_relaxed);
+    crossfaderRampSeconds.store(juce::jmax(0.0, rampSeconds), std::memory_order_relaxed);
+    crossfaderRequests.fetch_add(1, std::memory_order_release);
+
+    if (recorder != nullptr)
+    {
+        recorder->record(-1, AutomationTimeline::crossfaderEvent, getCrossfader(), -1, {}, juce::jmax(0.0, rampSeconds));
+    }
+}
+
+float DeckRenderPool::getCrossfader() const
+{
+    return crossfaderTarget.load(std::memory_order_relaxed);
+}
+
+void DeckRenderPool::setAutomationRecorder(AutomationRecorder* _recorder)
+{
+    recorder = _recorder;
+}
+
+void DeckRenderPool::recordCurrentState()
+{
+    if (recorder != nullptr)
+    {
+        recorder->record(-1, AutomationTimeline::crossfaderEvent, getCrossfader());
+    }
+}
+
+int DeckRenderPool::getNumDeadlineMisses() const
+{
+    return deadlineMisses.load();
+}
+
+int DeckRenderPool::getNumLateDecks() const
+{
+    return lateDecks.load();
+}
+
+double DeckRenderPool::getLastRenderLoad() const
+{
+    return lastLoad.load();
+}
+
+double DeckRenderPool::getPeakRenderLoad() const
+{
+    return peakLoad.load();
+}
+
+void DeckRenderPool::resetStatistics()
+{
+    deadlineMisses.store(0);
+    lateDecks.store(0);
+    lastLoad.store(0);
+    peakLoad.store(0);
+}
+
+void DeckRenderPool::startWorkers()
+{
+    // the audio thread renders the first deck itself, so one worker per extra deck
+    // is enough, but never more than the machine has spare cores for
+    const int numWorkers = juce::jmin(slots.size() - 1, juce::SystemStats::getNumCpus() - 1);
+
+    // the audio thread waits on them, so they're scheduled like it where the system allows
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        auto* worker = workers.add(new Worker(*this, i));
+        if (!worker->startRealtimeThread(juce::Thread::RealtimeOptions{}))
+        {
+            DBG("Deck render workers can't run at realtime priority");
+            worker->startThread(juce::Thread::Priority::highest);
+        }
+    }
+}
+
+void DeckRenderPool::stopWorkers()
+{
+    for (auto* worker : workers)
+    {
+        worker->signalThreadShouldExit();
+    }
+    wakeWorkers();
+    // a block may still be mid-join: stopping a worker only after it finished its
+    // current job keeps that block intact, and any job it leaves pending gets
+    // picked up by the audio thread
+    for (auto* worker : workers)
+    {
+        worker->stopThread(1000);
+    }
+    workers.clear();
+}
+
+DeckRenderPool::Worker::Worker(DeckRenderPool& _owner, int index)
+    : juce::Thread("Deck render " + juce::String(index + 1)),
+      owner(_owner)
+{
+}
+
+void DeckRenderPool::Worker::run()
+{
+    while (!threadShouldExit())
+    {
+        // read before looking, so jobs published in between cut the park short
+        const auto generation = owner.wakeGeneration.load();
+        if (owner.runPendingJob())
+        {
+            continue;
+        }
+
+        bool foundJob = false;
+        const auto spinEndTicks = juce::Time::getHighResolutionTicks()
+            + juce::Time::secondsToHighResolutionTicks(workerSpinSecs);
+        while (!foundJob && juce::Time::getHighResolutionTicks() < spinEndTicks && !threadShouldExit())
+        {
+            juce::Thread::yield();
+            foundJob = owner.runPendingJob();
+        }
+
+        if (!foundJob)
+        {
+            owner.parkWorker(generation);
+        }
+    }
+}
@@ -0,0 +1,249 @@
+/*
+  ==============================================================================
+
+    DeckRenderPool.h
+    Created: 19 Oct 2026 9:12:40am
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <atomic>
+#include "DJAudioPlayer.h"
+
+
+/**
+ * Renders every deck into its own preallocated buffer and mixes the results into
+ * the device buffer. Replaces juce::MixerAudioSource so that the per-deck chains
+ * can optionally be rendered in parallel by a small pool of worker threads.
+ *
+ * The audio thread never blocks on the workers: each deck is a job slot that is
+ * claimed with a compare-and-swap, so if a worker has not picked a job up by the
+ * time the audio thread joins, the audio thread simply renders that deck itself.
+ * Jobs a worker has claimed are waited for only until a deadline within the block;
+ * past it the deck is left out of the block and counted as late, and it isn't given
+ * a new job until the late one is finished, fading back in after. The workers run at realtime
+ * priority, spin briefly after each job and then sleep until the audio thread wakes
+ * them, which it does without taking a lock.
+ *
+ * The master goes to the first output pair. When the device has a second pair, it
+ * carries the headphone cue bus: the cued decks before their faders, blended with
+ * the master or split against it. Both are summed from the same deck buffers in
+ * the one mixing pass.
+ *
+ * A crossfader sits between the first two decks' faders and the master. Both decks
+ * are at full level with it in the middle, so it only takes one away towards the
+ * other side. Crossfades run on the audio thread, sample by sample.
+ */
+class DeckRenderPool
+{
+public:
+    /** Constructor */
+    DeckRenderPool();
+
+    /** Destructor. Stops the worker threads. */
+    ~DeckRenderPool();
+
+    /**
+     * Adds a deck to be rendered. Must be called before prepareToPlay().
+     *
+     * @param player: the deck to render, not owned by the pool
+     */
+    void addDeck(DJAudioPlayer* player);
+
+    /**
+     * Prepares every deck and allocates the per-deck buffers.
+     *
+     * @param samplesPerBlockExpected: the block size the device is expected to ask for
+     * @param sampleRate: the device sample rate
+     */
+    void prepareToPlay(int samplesPerBlockExpected, double sampleRate);
+
+    /** Releases every deck. */
+    void releaseResources();
+
+    /**
+     * Renders all the decks and sums them into the buffer. Called on the audio thread.
+     *
+     * @param bufferToFill: the device buffer to fill
+     */
+    void renderAndMix(const juce::AudioSourceChannelInfo& bufferToFill);
+
+    /**
+     * Turns the worker pool on or off. Called from the message thread; the change is
+     * picked up at the start of the next audio block.
+     *
+     * @param shouldRenderInParallel: true to render the decks on the worker threads
+     */
+    void setParallelRendering(bool shouldRenderInParallel);
+
+    /** @returns: true if the decks are currently rendered in parallel */
+    bool isParallelRendering() const;
+
+    /**
+     * Sets whether the audio thread gives up on a worker's deck at a deadline within
+     * the block. Offline renders turn it off, so every deck is in every block however
+     * long it takes and the result doesn't depend on timing.
+     *
+     * @param shouldMeetDeadline: false to always wait for every deck
+     */
+    void setJoinDeadline(bool shouldMeetDeadline);
+
+    /**
+     * Sets the headphone blend between the cue bus and the master.
+     *
+     * @param mix: 0 for only the cued decks, 1 for only the master
+     */
+    void setCueMix(float mix);
+
+    /** @returns: the headphone blend between the cue bus and the master */
+    float getCueMix() const;
+
+    /**
+     * Switches split cue on or off: the cued decks in mono on the left ear and the
+     * master in mono on the right, regardless of the cue mix.
+     *
+     * @param shouldSplit: true to split the headphones
+     */
+    void setSplitCue(bool shouldSplit);
+
+    /** @returns: true if the headphones are split between cue and master */
+    bool isSplitCue() const;
+
+    /**
+     * Moves the crossfader, over a while or at once.
+     *
+     * @param position: 0 for only the first deck, 0.5 for both, 1 for only the second
+     * @param rampSeconds: how long to take getting there
+     */
+    void setCrossfader(float position, double rampSeconds = 0);
+
+    /** @returns: where the crossfader is going to */
+    float getCrossfader() const;
+
+    /**
+     * Sends every later crossfader move to a recorder, as events for no deck.
+     *
+     * @param _recorder: the recorder, or nullptr to stop sending
+     */
+    void setAutomationRecorder(AutomationRecorder* _recorder);
+
+    /** Records where the crossfader is going to, so a replay starts from there */
+    void recordCurrentState();
+
+    /** First channel of the headphone pair; the device buffer needs two more after it */
+    static constexpr int cueLeftChannel = 2;
+
+    /** @returns: number of blocks whose render took longer than the buffer period */
+    int getNumDeadlineMisses() const;
+
+    /** @returns: number of times a deck's job wasn't done in time and the deck was left out of a block */
+    int getNumLateDecks() const;
+
+    /** @returns: the last block's render time as a proportion of the buffer period */
+    double getLastRenderLoad() const;
+
+    /** @returns: the worst render load seen since the last call to resetStatistics() */
+    double getPeakRenderLoad() const;
+
+    /** Clears the deadline and late deck counters. */
+    void resetStatistics();
+
+private:
+    enum JobState
+    {
+        jobIdle = 0,
+        jobPending,
+        jobRunning,
+        jobDone
+    };
+
+    struct DeckSlot
+    {
+        DJAudioPlayer* player = nullptr;
+        juce::AudioBuffer<float> buffer;
+        bool late = false;    // a job from an earlier block is still running, audio thread only
+        std::atomic<int> state{ jobIdle };
+        int numSamples = 0;
+        bool realtime = false; // the job is checked like the audio thread that dispatched it
+        float mixedGain = 1.0f; // fader gain the last block was mixed at, audio thread only
+    };
+
+    class Worker : public juce::Thread
+    {
+    public:
+        Worker(DeckRenderPool& _owner, int index);
+        void run() override;
+
+    private:
+        DeckRenderPool& owner;
+    };
+
+    juce::OwnedArray<DeckSlot> slots;
+    juce::OwnedArray<Worker> workers;
+
+    std::atomic<bool> parallel{ false };
+    std::atomic<bool> meetDeadline{ true };
+    std::atomic<float> cueMix{ 0.5f };
+    std::atomic<bool> splitCue{ false };
+    float mixedCueMix = 0.5f; // cue mix the last block was blended at, audio thread only
+
+    // crossfader moves, handed over as target and ramp with a request count bumped last
+    std::atomic<float> crossfaderTarget{ 0.5f };
+    std::atomic<double> crossfaderRampSeconds{ 0 };
+    std::atomic<int> crossfaderRequests{ 0 };
+    AutomationRecorder* recorder = nullptr;
+    int crossfaderRequestsSeen = 0;  // audio thread only, like the two below
+    float crossfaderPosition = 0.5f;
+    float crossfaderStep = 0;        // per sample, towards the target
+
+    // bumped by the audio thread after publishing jobs; parked workers sleep on it
+    std::atomic<juce::uint32> wakeGeneration{ 0 };
+    std::atomic<int> parkedWorkers{ 0 };
+
+    int maxBlockSize = 0;
+    double currentSampleRate = 0;
+
+    std::atomic<int> deadlineMisses{ 0 };
+    std::atomic<int> lateDecks{ 0 };
+    std::atomic<double> lastLoad{ 0 };
+    std::atomic<double> peakLoad{ 0 };
+
+    /** Sums the rendered decks into the master and, if there are outputs for it, the cue bus. */
+    void mixChunk(juce::AudioBuffer<float>& output, int startSample, int numSamples);
+
+    /** Moves the crossfader on by a chunk. @returns: where it ends up. */
+    float advanceCrossfader(int numSamples);
+
+    /** @returns: a deck's level from the crossfader, 1 for decks past the first two */
+    static float getCrossfaderGain(int deckIndex, float position);
+
+    /** Turns the cue bus on the headphone pair into what the headphones should hear. */
+    void mixHeadphones(juce::AudioBuffer<float>& output, int startSample, int numSamples);
+
+    /** Renders one deck into its slot's buffer. */
+    void renderSlot(DeckSlot& slot);
+
+    /** Tries to claim and render a pending job. Returns true if one was rendered. */
+    bool runPendingJob();
+
+    /** Wakes any parked worker. Never blocks, so the audio thread can call it. */
+    void wakeWorkers();
+
+    /**
+     * Sleeps a worker until the audio thread publishes jobs, or a timeout passes.
+     *
+     * @param seenGeneration: wakeGeneration from before the worker last looked for jobs
+     */
+    void parkWorker(juce::uint32 seenGeneration);
+
+    /** Renders numSamples of every deck and sums them into the buffer at startSample. */
+    void renderChunk(juce::AudioBuffer<float>& output, int startSample, int numSamples);
+
+    void startWorkers();
+    void stopWorkers();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DeckRenderPool)
+};
@@ -0,0 +1,228 @@
+/*
+  ==============================================================================
+
+    EffectsRack.cpp
+    Created: 19 Oct 2026 11:40:05am
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#include "EffectsRack.h"
+
+
+EffectsRack::EffectsRack()
+{
+    // same order as EffectType
+    effects.add(new FilterEffect());
+    effects.add(new DelayEffect());
+    effects.add(new EchoEffect());
+    effects.add(new FlangerEffect());
+    effects.add(new BitcrusherEffect());
+    reverb = new ReverbEffect();
+    effects.add(reverb);
+
+    // amounts the effects come in at when switched on from the deck
+    effects[filterEffect]->setAmount(-0.4f);
+    effects[delayEffect]->setAmount(0.35f);
+    effects[echoEffect]->setAmount(0.35f);
+    effects[flangerEffect]->setAmount(0.7f);
+    effects[bitcrusherEffect]->setAmount(0.5f);
+
+    // only the reverb is on by default, it is controlled by the wet and freeze knobs
+    for (int i = 0; i < numEffectTypes; ++i)
+    {
+        editLayout.order[i] = i;
+        editLayout.enabled[i] = (i == reverbEffect);
+        effectRunning[i] = false;
+    }
+    activeLayout = new Layout(editLayout);
+}
+
+EffectsRack::~EffectsRack()
+{
+    delete activeLayout;
+    delete pendingLayout.exchange(nullptr);
+    delete retiredLayout.exchange(nullptr);
+}
+
+void EffectsRack::prepareToPlay(int samplesPerBlockExpected, double sampleRate)
+{
+    for (auto* effect : effects)
+    {
+        effect->prepare(sampleRate, samplesPerBlockExpected);
+    }
+    for (auto& running : effectRunning)
+    {
+        running = false;
+    }
+    tailActive = false;
+}
+
+bool EffectsRack::process(juce::AudioBuffer<float>& buffer, int startSample, int numSamples, bool inputIsSilent)
+{
+    // pick up a new layout, but only once the one handed back last time has been collected.
+    // The old layout is handed back before the new one is taken, so by the time the pending
+    // slot is empty the message thread can always see what it has to collect
+    if (pendingLayout.load(std::memory_order_acquire) != nullptr)
+    {
+        Layout* noRetiredLayout = nullptr;
+        if (retiredLayout.compare_exchange_strong(noRetiredLayout, activeLayout, std::memory_order_acq_rel))
+        {
+            // only this thread empties the pending slot, so it still holds a layout
+            activeLayout = pendingLayout.exchange(nullptr, std::memory_order_acq_rel);
+        }
+    }
+
+    processedLastBlock = false;
+    bool anyActive = false;
+    for (int type = 0; type < numEffectTypes; ++type)
+    {
+        effects[type]->updateParameters(activeLayout->enabled[type]);
+        anyActive = anyActive || effects[type]->isActive();
+    }
+
+    // nothing to do: every effect is dry, or the input is silent and no tail is ringing
+    if (!anyActive || (inputIsSilent && !tailActive))
+    {
+        if (tailActive)
+        {
+            resetRunningEffects();
+            tailActive = false;
+        }
+        return inputIsSilent;
+    }
+
+    for (int slot = 0; slot < numEffectTypes; ++slot)
+    {
+        const int type = activeLayout->order[slot];
+        auto* effect = effects[type];
+
+        if (effect->isActive())
+        {
+            effect->process(buffer, startSample, numSamples);
+            effectRunning[type] = true;
+        }
+        else if (effectRunning[type])
+        {
+            // clear what is left in the delay lines so it doesn't come back when switched on again
+            effect->reset();
+            effectRunning[type] = false;
+        }
+    }
+    tailActive = true;
+    processedLastBlock = true;
+
+    // on silent input, the tail ends once it drops below -100dB, unless something rings forever
+    if (inputIsSilent)
+    {
+        bool infiniteTail = false;
+        for (int type = 0; type < numEffectTypes; ++type)
+        {
+            infiniteTail = infiniteTail || (effectRunning[type] && effects[type]->hasInfiniteTail());
+        }
+
+        if (!infiniteTail && buffer.getMagnitude(startSample, numSamples) < 1.0e-5f)
+        {
+            buffer.clear(startSample, numSamples);
+            resetRunningEffects();
+            tailActive = false;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool EffectsRack::didProcessLastBlock() const
+{
+    return processedLastBlock;
+}
+
+void EffectsRack::setEffectEnabled(EffectType type, bool shouldBeEnabled)
+{
+    if (editLayout.enabled[type] != shouldBeEnabled)
+    {
+        editLayout.enabled[type] = shouldBeEnabled;
+        publishLayout();
+    }
+}
+
+bool EffectsRack::isEffectEnabled(EffectType type) const
+{
+    return editLayout.enabled[type];
+}
+
+void EffectsRack::setEffectOrder(const juce::Array<EffectType>& newOrder)
+{
+    // must be a permutation of all the effects
+    if (newOrder.size() != numEffectTypes)
+    {
+        return;
+    }
+    for (int type = 0; type < numEffectTypes; ++type)
+    {
+        if (!newOrder.contains((EffectType)type))
+        {
+            return;
+        }
+    }
+
+    for (int slot = 0; slot < numEffectTypes; ++slot)
+    {
+        editLayout.order[slot] = newOrder[slot];
+    }
+    publishLayout();
+}
+
+juce::Array<EffectsRack::EffectType> EffectsRack::getEffectOrder() const
+{
+    juce::Array<EffectType> order;
+    for (int slot = 0; slot < numEffectTypes; ++slot)
+    {
+        order.add((EffectType)editLayout.order[slot]);
+    }
+    return order;
+}
+
+void EffectsRack::setEffectAmount(EffectType type, float amount)
+{
+    effects[type]->setAmount(amount);
+}
+
+DeckEffect& EffectsRack::getEffect(EffectType type)
+{
+    return *effects[type];
+}
+
+ReverbEffect& EffectsRack::getReverb()
+{
+    return *reverb;
+}
+
+void EffectsRack::publishLayout()
+{
+    // if the audio thread hasn't picked up the previous layout yet, it never will
+    delete pendingLayout.exchange(new Layout(editLayout), std::memory_order_acq_rel);
+
+    // collected after publishing: the audio thread retires its layout before it takes a
+    // pending one, so anything it retired to take an earlier layout is in the slot by now,
+    // and once that's gone it's free to take this one
+    collectRetiredLayout();
+}
+
+void EffectsRack::collectRetiredLayout()
+{
+    delete retiredLayout.exchange(nullptr, std::memory_order_acq_rel);
+}
+
+void EffectsRack::resetRunningEffects()
+{
+    for (int type = 0; type < numEffectTypes; ++type)
+    {
+        if (effectRunning[type])
+        {
+            effects[type]->reset();
+            effectRunning[type] = false;
+        }
+    }
+}
@@ -0,0 +1,136 @@
+/*
+  ==============================================================================
+
+    EffectsRack.h
+    Created: 19 Oct 2026 11:40:05am
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <atomic>
+#include "DeckEffects.h"
+
+
+/**
+ * The effects chain of one deck.
+ *
+ * Every effect is created and prepared up front; what changes mid-set is the layout, i.e.
+ * the order the effects run in and which ones are switched on. Layouts are built on the
+ * message thread and handed to the audio thread through an atomic pointer, and the audio
+ * thread hands the layout it replaced back the same way, so reordering or toggling effects
+ * never allocates, frees or locks inside getNextAudioBlock.
+ */
+class EffectsRack
+{
+public:
+    /** The available effects */
+    enum EffectType
+    {
+        filterEffect = 0,
+        delayEffect,
+        echoEffect,
+        flangerEffect,
+        bitcrusherEffect,
+        reverbEffect,
+        numEffectTypes
+    };
+
+    /** Constructor */
+    EffectsRack();
+
+    /** Destructor */
+    ~EffectsRack();
+
+    /**
+     * Prepares every effect. Never called on the audio thread.
+     *
+     * @param samplesPerBlockExpected: the largest block process() will be called with
+     * @param sampleRate: the device sample rate
+     */
+    void prepareToPlay(int samplesPerBlockExpected, double sampleRate);
+
+    /**
+     * Runs the enabled effects in order. Called on the audio thread.
+     *
+     * @param buffer: the deck's audio, processed in place
+     * @param startSample: first sample to process
+     * @param numSamples: number of samples to process
+     * @param inputIsSilent: true if the block coming into the rack is silence
+     * @returns: true if the block coming out of the rack is silence
+     */
+    bool process(juce::AudioBuffer<float>& buffer, int startSample, int numSamples, bool inputIsSilent);
+
+    /** @returns: false if the last call to process() skipped every effect */
+    bool didProcessLastBlock() const;
+
+    /**
+     * Switches an effect on or off. Message thread only.
+     *
+     * @param type: the effect
+     * @param shouldBeEnabled: true to switch it on
+     */
+    void setEffectEnabled(EffectType type, bool shouldBeEnabled);
+
+    /** @returns: true if the effect is switched on */
+    bool isEffectEnabled(EffectType type) const;
+
+    /**
+     * Changes the order the effects run in. Message thread only.
+     *
+     * @param newOrder: every effect type exactly once, first to last
+     */
+    void setEffectOrder(const juce::Array<EffectType>& newOrder);
+
+    /** @returns: the effect types, first to last */
+    juce::Array<EffectType> getEffectOrder() const;
+
+    /**
+     * Sets the main control of an effect. Can be called from any thread.
+     *
+     * @param type: the effect
+     * @param amount: see DeckEffect::setAmount()
+     */
+    void setEffectAmount(EffectType type, float amount);
+
+    /** @returns: the effect object */
+    DeckEffect& getEffect(EffectType type);
+
+    /** @returns: the reverb, for its freeze control */
+    ReverbEffect& getReverb();
+
+private:
+    /** One arrangement of the effects, swapped in as a whole */
+    struct Layout
+    {
+        int order[numEffectTypes];
+        bool enabled[numEffectTypes];
+    };
+
+    juce::OwnedArray<DeckEffect> effects;
+    ReverbEffect* reverb = nullptr;
+
+    // message thread's copy, and the hand-over slots to and from the audio thread
+    Layout editLayout;
+    std::atomic<Layout*> pendingLayout{ nullptr };
+    std::atomic<Layout*> retiredLayout{ nullptr };
+
+    // owned by the audio thread
+    Layout* activeLayout = nullptr;
+    bool effectRunning[numEffectTypes];
+    bool tailActive = false;
+    bool processedLastBlock = false;
+
+    /** Builds a copy of editLayout and queues it for the audio thread */
+    void publishLayout();
+
+    /** Deletes the layout the audio thread has finished with, if any */
+    void collectRetiredLayout();
+
+    /** Resets any effect that has been running */
+    void resetRunningEffects();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EffectsRack)
+};
@@ -0,0 +1,93 @@
+/*
+  ==============================================================================
+
+    KnobFilmstrip.cpp
+    Created: 19 Oct 2026 10:21:17pm
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#include "KnobFilmstrip.h"
+#include <algorithm>
+#include <cmath>
+
+
+KnobFilmstrip::KnobFilmstrip()
+{
+    juce::File knobImageFile = juce::File::getSpecialLocation
+    (juce::File::SpecialLocationType::userDesktopDirectory).getChildFile("knob1.png");
+    filmstrip = juce::ImageCache::getFromFile(knobImageFile);
+}
+
+void KnobFilmstrip::setFilmstrip(const juce::Image& _filmstrip)
+{
+    filmstrip = _filmstrip;
+    clearScaledFrames();
+}
+
+bool KnobFilmstrip::isValid() const
+{
+    return filmstrip.isValid() && getNumFrames() > 0;
+}
+
+int KnobFilmstrip::getNumFrames() const
+{
+    return filmstrip.isValid() ? filmstrip.getHeight() / filmstrip.getWidth() : 0;
+}
+
+void KnobFilmstrip::draw(juce::Graphics& g, int frame, float x, float y, int diameter)
+{
+    if (!isValid() || diameter <= 0)
+    {
+        return;
+    }
+
+    // frames are kept at the size they land on the screen, then drawn scaled back by the
+    // same factor, which the renderer turns into a straight copy
+    const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    const int size = juce::roundToInt(diameter * scale);
+    const auto& image = getScaledFrame(juce::jlimit(0, getNumFrames() - 1, frame), size);
+
+    g.drawImageTransformed(image, juce::AffineTransform::scale(1.0f / scale)
+        .translated(std::round(x * scale) / scale, std::round(y * scale) / scale));
+}
+
+void KnobFilmstrip::clearScaledFrames()
+{
+    scaledFrames.clear();
+}
+
+const juce::Image& KnobFilmstrip::getScaledFrame(int frame, int size)
+{
+    auto found = std::find_if(scaledFrames.begin(), scaledFrames.end(),
+        [size](const ScaledFrames& entry) { return entry.size == size; });
+
+    if (found == scaledFrames.end())
+    {
+        if ((int)scaledFrames.size() >= maxCachedSizes)
+        {
+            scaledFrames.erase(scaledFrames.begin());
+        }
+        ScaledFrames entry;
+        entry.size = size;
+        entry.frames.resize((size_t)getNumFrames());
+        scaledFrames.push_back(std::move(entry));
+    }
+    else if (found != scaledFrames.end() - 1)
+    {
+        // most recently used goes last
+        std::rotate(found, found + 1, scaledFrames.end());
+    }
+
+    auto& image = scaledFrames.back().frames[(size_t)frame];
+    if (!image.isValid())
+    {
+        const int frameSize = filmstrip.getWidth();
+        image = juce::Image(juce::Image::ARGB, size, size, true);
+        juce::Graphics g(image);
+        g.setImageResamplingQuality(juce::Graphics::highResamplingQuality);
+        g.drawImage(filmstrip, 0, 0, size, size, 0, frame * frameSize, frameSize, frameSize);
+    }
+    return image;
+}
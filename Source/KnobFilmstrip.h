@@ -0,0 +1,75 @@
+/*
+  ==============================================================================
+
+    KnobFilmstrip.h
+    Created: 19 Oct 2026 10:21:17pm
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <vector>
+
+
+/**
+ * Draws knobs from a filmstrip: one square frame per knob position, stacked top to bottom.
+ *
+ * The filmstrip is decoded once for the whole app, shared through a
+ * juce::SharedResourcePointer. Frames are scaled to each knob size the first time they're
+ * needed, at the screen's physical pixel size, so painting a knob is a plain blit with no
+ * resampling. A resize or a move to a screen with another scale factor asks for a new
+ * size; the sizes not used for a while are dropped. Message thread only.
+ */
+class KnobFilmstrip
+{
+public:
+    /** Constructor. Loads knob1.png from the Desktop. */
+    KnobFilmstrip();
+
+    /**
+     * Replaces the filmstrip and drops every scaled frame.
+     *
+     * @param filmstrip: square frames stacked vertically, first position at the top
+     */
+    void setFilmstrip(const juce::Image& filmstrip);
+
+    /** @returns: false if there's no filmstrip to draw with */
+    bool isValid() const;
+
+    /** @returns: how many positions the filmstrip has */
+    int getNumFrames() const;
+
+    /**
+     * Draws one frame of the knob.
+     *
+     * @param g: the graphics context to draw with
+     * @param frame: which position, 0 to getNumFrames() - 1
+     * @param x: left edge of the knob
+     * @param y: top edge of the knob
+     * @param diameter: width and height of the knob
+     */
+    void draw(juce::Graphics& g, int frame, float x, float y, int diameter);
+
+    /** Drops every scaled frame. */
+    void clearScaledFrames();
+
+private:
+    /** The frames scaled to one size, drawn as they're first needed */
+    struct ScaledFrames
+    {
+        int size = 0; // physical pixels
+        std::vector<juce::Image> frames;
+    };
+
+    static constexpr int maxCachedSizes = 4;
+
+    juce::Image filmstrip;
+    std::vector<ScaledFrames> scaledFrames; // least recently used first
+
+    /** @returns: one frame at a size, scaling it if it hasn't been needed before */
+    const juce::Image& getScaledFrame(int frame, int size);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(KnobFilmstrip)
+};
@@ -13,9 +13,6 @@
 
 KnobsLookAndFeel::KnobsLookAndFeel()
 {
-    juce::File knobImageFile1 = juce::File::getSpecialLocation
-    (juce::File::SpecialLocationType::userDesktopDirectory).getChildFile("knob1.png");
-    img1 = juce::ImageCache::getFromFile(knobImageFile1);
 }
 
 
@@ -24,14 +21,14 @@ void KnobsLookAndFeel::drawRotarySlider(juce::Graphics& g,
     float rotaryStartAngle, float rotaryEndAngle, juce::Slider& slider)
 {
 
-    if (img1.isValid())
+    if (filmstrip->isValid())
     {
         const double rotation = (slider.getValue()
             - slider.getMinimum())
             / (slider.getMaximum()
                 - slider.getMinimum());
 
-        const int frames = img1.getHeight() / img1.getWidth();
+        const int frames = filmstrip->getNumFrames();
         const int frameId = (int)ceil(rotation * ((double)frames - 1.0));
         const float radius = juce::jmin(width / 2.0f, height / 2.0f);
         const float centerX = x + width * 0.5f;
@@ -39,15 +36,7 @@ void KnobsLookAndFeel::drawRotarySlider(juce::Graphics& g,
         const float rx = centerX - radius - 1.0f;
         const float ry = centerY - radius;
 
-        g.drawImage(img1,
-            (int)rx,
-            (int)ry,
-            2 * (int)radius,
-            2 * (int)radius,
-            0,
-            frameId * img1.getWidth(),
-            img1.getWidth(),
-            img1.getWidth());
+        filmstrip->draw(g, frameId, rx, ry, 2 * (int)radius);
     }
     else
     {
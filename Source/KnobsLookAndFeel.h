@@ -10,6 +10,7 @@
 
 #pragma once
 #include <JuceHeader.h>
+#include "KnobFilmstrip.h"
 
 /** Defines custom style for knobs */
 class KnobsLookAndFeel : public juce::LookAndFeel_V4
@@ -18,11 +19,12 @@ public:
     /** Constructor */
     KnobsLookAndFeel();
 
-    /** Overrides parent class method to use loaded image for knobs */
+    /** Overrides parent class method to draw the knobs from the shared filmstrip */
     void drawRotarySlider(juce::Graphics& g, int x, int y, int width, int height, float sliderPos,
         float rotaryStartAngle, float rotaryEndAngle, juce::Slider& slider) override;
 
 private:
-    juce::Image img1;
+    // one filmstrip, and one set of scaled frames, for every deck's knobs
+    juce::SharedResourcePointer<KnobFilmstrip> filmstrip;
 
 };
\ No newline at end of file
@@ -0,0 +1,108 @@
+/*
+  ==============================================================================
+
+    LevelMeterComponent.cpp
+    Created: 19 Oct 2026 8:05:13pm
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#include "LevelMeterComponent.h"
+
+
+LevelMeterComponent::LevelMeterComponent(AudioMeter& _meter)
+    : meter(_meter)
+{
+    setOpaque(true);
+    setTooltip("Peak and RMS; the lamp lights on true peaks over 0 dBTP. Click for the spectrum");
+}
+
+void LevelMeterComponent::paint(juce::Graphics& g)
+{
+    g.fillAll(juce::Colours::black);
+
+    const auto& levels = meter.getLevels();
+    const bool vertical = isVertical();
+
+    // clip lamp at the loud end
+    const auto lamp = getLampBounds();
+    g.setColour(levels.maxTruePeak > 1.0f ? juce::Colours::red : juce::Colours::darkred.withAlpha(0.4f));
+    g.fillRect(lamp.reduced(1.0f));
+
+    auto bars = getLocalBounds().toFloat();
+    if (vertical)
+    {
+        bars.removeFromTop(lamp.getHeight());
+    }
+    else
+    {
+        bars.removeFromRight(lamp.getWidth());
+    }
+
+    for (int channel = 0; channel < AudioMeter::numChannels; ++channel)
+    {
+        auto bar = vertical
+            ? bars.withWidth(bars.getWidth() / AudioMeter::numChannels).withX(bars.getX() + channel * bars.getWidth() / AudioMeter::numChannels)
+            : bars.withHeight(bars.getHeight() / AudioMeter::numChannels).withY(bars.getY() + channel * bars.getHeight() / AudioMeter::numChannels);
+        bar = bar.reduced(1.0f);
+
+        // RMS, coloured by how close to full scale it is
+        const float rms = levelToProportion(levels.rms[channel]);
+        const float rmsDb = juce::Decibels::gainToDecibels(levels.rms[channel]);
+        g.setColour(rmsDb > -3.0f ? juce::Colours::red : rmsDb > -12.0f ? juce::Colours::orange : juce::Colours::lightgreen);
+        if (vertical)
+        {
+            g.fillRect(bar.withTop(bar.getBottom() - rms * bar.getHeight()));
+        }
+        else
+        {
+            g.fillRect(bar.withWidth(rms * bar.getWidth()));
+        }
+
+        // held peak
+        const float peak = levelToProportion(levels.peak[channel]);
+        g.setColour(juce::Colours::white);
+        if (vertical)
+        {
+            g.fillRect(bar.getX(), bar.getBottom() - peak * bar.getHeight() - 1.0f, bar.getWidth(), 2.0f);
+        }
+        else
+        {
+            g.fillRect(bar.getX() + peak * bar.getWidth() - 1.0f, bar.getY(), 2.0f, bar.getHeight());
+        }
+    }
+}
+
+void LevelMeterComponent::mouseDown(const juce::MouseEvent& event)
+{
+    if (getLampBounds().contains(event.position))
+    {
+        meter.resetMaxTruePeak();
+        return;
+    }
+
+    const bool enabled = !meter.isSpectrumEnabled();
+    meter.setSpectrumEnabled(enabled);
+    if (onSpectrumToggled)
+    {
+        onSpectrumToggled(enabled);
+    }
+}
+
+bool LevelMeterComponent::isVertical() const
+{
+    return getHeight() > getWidth();
+}
+
+juce::Rectangle<float> LevelMeterComponent::getLampBounds() const
+{
+    auto area = getLocalBounds().toFloat();
+    return isVertical() ? area.removeFromTop(area.getWidth() / 2) : area.removeFromRight(area.getHeight() / 2);
+}
+
+float LevelMeterComponent::levelToProportion(float gain)
+{
+    const float decibels = juce::Decibels::gainToDecibels(gain, minimumDb);
+    return juce::jlimit(0.0f, 1.0f, (decibels - minimumDb) / (maximumDb - minimumDb));
+}
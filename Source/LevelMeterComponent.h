@@ -0,0 +1,70 @@
+/*
+  ==============================================================================
+
+    LevelMeterComponent.h
+    Created: 19 Oct 2026 8:05:13pm
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <functional>
+#include "AudioMeter.h"
+
+
+/**
+ * Stereo level meter: RMS as a bar, the held sample peak as a line across it, and a clip
+ * lamp that lights when the true peak has gone over 0 dBTP.
+ *
+ * It repaints in step with the display, and only when the meter has published new levels.
+ * Laid out vertically when taller than wide, horizontally otherwise. Clicking the lamp
+ * clears it; clicking anywhere else switches the meter's spectrum on or off.
+ */
+class LevelMeterComponent : public juce::Component,
+    public juce::SettableTooltipClient
+{
+public:
+    /**
+     * Constructor
+     *
+     * @param _meter: the meter to show; this component is its only levels reader
+     */
+    LevelMeterComponent(AudioMeter& _meter);
+
+    /**
+     * Draws the bars from the latest levels.
+     *
+     * @param g: the graphics context to draw with
+     */
+    void paint(juce::Graphics& g) override;
+
+    /**
+     * Clears the clip lamp, or toggles the spectrum.
+     *
+     * @param event: the click
+     */
+    void mouseDown(const juce::MouseEvent& event) override;
+
+    /** Called with the new state when a click switches the spectrum on or off */
+    std::function<void(bool)> onSpectrumToggled;
+
+private:
+    // scale of the bars
+    static constexpr float minimumDb = -60.0f;
+    static constexpr float maximumDb = 3.0f;
+
+    AudioMeter& meter;
+    juce::VBlankAttachment vBlank{ this, [this] { if (meter.updateLevels()) repaint(); } };
+
+    bool isVertical() const;
+
+    /** @returns: where the clip lamp goes */
+    juce::Rectangle<float> getLampBounds() const;
+
+    /** @returns: 0 to 1 along the bar for a linear level */
+    static float levelToProportion(float gain);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LevelMeterComponent)
+};
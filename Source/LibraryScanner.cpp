@@ -0,0 +1,137 @@
+/*
+  ==============================================================================
+
+    LibraryScanner.cpp
+    Created: 20 Oct 2026 2:07:43am
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#include "LibraryScanner.h"
+#include <set>
+#include <vector>
+#include "Mp3SeekIndex.h"
+#include "SpectralWaveform.h"
+
+
+// how often analyseAll() reports progress
+static const int progressIntervalMs = 500;
+
+
+LibraryScanner::LibraryScanner(juce::AudioFormatManager& _formatManager) : formatManager(_formatManager)
+{
+}
+
+LibraryScanner::~LibraryScanner()
+{
+    // the tasks read through the format manager, so they mustn't outlive the scanner
+    stopping = true;
+    scheduler->waitUntilIdle();
+}
+
+TrackStore& LibraryScanner::getTracks()
+{
+    return tracks;
+}
+
+int LibraryScanner::importFolder(const juce::File& folder)
+{
+    std::set<juce::String> names;
+    for (int row = 0; row < tracks.size(); ++row)
+    {
+        names.insert(tracks.getName(row));
+    }
+
+    auto files = folder.findChildFiles(juce::File::findFiles, true, formatManager.getWildcardForAllFormats());
+    files.sort();
+
+    int numAdded = 0;
+    for (const auto& file : files)
+    {
+        // a song already in the playlist isn't added again, as when importing in the app
+        if (names.insert(file.getFileNameWithoutExtension()).second)
+        {
+            tracks.add(file);
+            ++numAdded;
+        }
+    }
+    return numAdded;
+}
+
+int LibraryScanner::analyseAll(const std::function<bool(int done, int total)>& onProgress)
+{
+    const int numTracks = tracks.size();
+    numDone = 0;
+    numFailed = 0;
+    stopping = false;
+
+    // each task fills in its own track's duration, taken into the playlist once they're all done
+    std::vector<float> durations((size_t)numTracks);
+    for (int row = 0; row < numTracks; ++row)
+    {
+        durations[(size_t)row] = tracks.getDuration(row);
+        const auto file = tracks.getFile(row);
+        float* duration = &durations[(size_t)row];
+
+        // nothing is on screen or playing, so these needn't leave a worker free for the decks
+        // as library tasks do
+        scheduler->submit(TaskScheduler::playlistPriority, "scan|" + file.getFullPathName(),
+            [this, file, duration](const std::function<bool()>& shouldCancel)
+            {
+                analyseTrack(file, *duration, shouldCancel);
+                ++numDone;
+            });
+    }
+
+    while (!scheduler->waitUntilIdle(progressIntervalMs))
+    {
+        if (onProgress != nullptr && !onProgress(numDone, numTracks))
+        {
+            stopping = true;
+        }
+    }
+    if (onProgress != nullptr)
+    {
+        onProgress(numDone, numTracks);
+    }
+
+    for (int row = 0; row < numTracks; ++row)
+    {
+        tracks.setDuration(row, durations[(size_t)row]);
+    }
+    return numFailed;
+}
+
+void LibraryScanner::analyseTrack(const juce::File& file, float& duration, const std::function<bool()>& shouldCancel)
+{
+    auto shouldStop = [this, &shouldCancel] { return stopping || shouldCancel(); };
+    if (shouldStop())
+    {
+        return;
+    }
+
+    // opening an MP3 through its seek index builds and saves the index
+    std::unique_ptr<juce::AudioFormatReader> reader(IndexedMp3Reader::create(file, formatManager));
+    if (reader == nullptr)
+    {
+        reader.reset(formatManager.createReaderFor(file));
+    }
+    if (reader == nullptr || reader->sampleRate <= 0)
+    {
+        DBG("Can't read " << file.getFullPathName());
+        ++numFailed;
+        return;
+    }
+    if (duration == TrackStore::unknownDuration)
+    {
+        duration = (float)(reader->lengthInSamples / reader->sampleRate);
+    }
+    reader.reset();
+
+    if (SpectralWaveform::loadOrAnalyse(file, formatManager, shouldStop) == nullptr && !shouldStop())
+    {
+        DBG("Can't analyse " << file.getFullPathName());
+        ++numFailed;
+    }
+}
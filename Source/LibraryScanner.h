@@ -0,0 +1,81 @@
+/*
+  ==============================================================================
+
+    LibraryScanner.h
+    Created: 20 Oct 2026 2:07:43am
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <atomic>
+#include <functional>
+#include "TrackStore.h"
+#include "TaskScheduler.h"
+
+
+/**
+ * Prepares a music library ahead of time, without a window or an audio device.
+ *
+ * Folders are imported into a playlist the same way the app imports files, skipping songs
+ * whose name is already in it. Then every track in the playlist gets its duration read,
+ * its MP3 seek index built and its colour waveform and beat analysed. Each result is
+ * saved where the app looks for it, so the decks load the tracks as if they'd been
+ * loaded before. The tracks are spread over every worker of the shared TaskScheduler.
+ */
+class LibraryScanner
+{
+public:
+    /**
+     * Constructor
+     *
+     * @param _formatManager: to read the tracks with
+     */
+    LibraryScanner(juce::AudioFormatManager& _formatManager);
+
+    /** Destructor. Stops any analysis still running. */
+    ~LibraryScanner();
+
+    /** @returns: the playlist being prepared, to load and save */
+    TrackStore& getTracks();
+
+    /**
+     * Adds the audio files in a folder and its subfolders to the playlist.
+     *
+     * @param folder: the folder
+     * @returns: how many songs were added
+     */
+    int importFolder(const juce::File& folder);
+
+    /**
+     * Reads, indexes and analyses every track in the playlist, and fills in the durations
+     * that weren't known. Returns when they're all done.
+     *
+     * @param onProgress: called every so often with how many tracks are done out of how
+     *                    many; returning false stops the scan
+     * @returns: how many tracks couldn't be read
+     */
+    int analyseAll(const std::function<bool(int done, int total)>& onProgress);
+
+private:
+    juce::AudioFormatManager& formatManager;
+    juce::SharedResourcePointer<TaskScheduler> scheduler;
+    TrackStore tracks;
+
+    std::atomic<int> numDone{ 0 };
+    std::atomic<int> numFailed{ 0 };
+    std::atomic<bool> stopping{ false };
+
+    /**
+     * Reads, indexes and analyses one track. Worker thread.
+     *
+     * @param file: the track
+     * @param duration: set to the track's duration if it was read
+     * @param shouldCancel: polled while analysing
+     */
+    void analyseTrack(const juce::File& file, float& duration, const std::function<bool()>& shouldCancel);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LibraryScanner)
+};
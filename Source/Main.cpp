@@ -7,7 +7,140 @@
 */
 
 #include <JuceHeader.h>
+#include <iostream>
 #include "MainComponent.h"
+#include "OfflineRenderer.h"
+#include "LibraryScanner.h"
+
+
+/**
+ * Renders a saved session to a file without opening a window or an audio device:
+ * DJApp --render <automation.xml> <output.wav|.flac> [--sample-rate <hz>] [--tail <secs>]
+ *
+ * @param args: the command line
+ * @returns: the process exit code
+ */
+static int renderFromCommandLine(const juce::StringArray& args)
+{
+    const int index = args.indexOf("--render");
+    if (index + 2 >= args.size())
+    {
+        std::cerr << "usage: DJApp --render <automation.xml> <output.wav|.flac> "
+                     "[--sample-rate <hz>] [--tail <secs>]" << std::endl;
+        return 1;
+    }
+
+    auto workingDirectory = juce::File::getCurrentWorkingDirectory();
+    auto timelineFile = workingDirectory.getChildFile(args[index + 1].unquoted());
+    auto outputFile = workingDirectory.getChildFile(args[index + 2].unquoted());
+
+    AutomationTimeline timeline;
+    if (!timeline.loadFromFile(timelineFile))
+    {
+        std::cerr << "Can't read automation from " << timelineFile.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    double sampleRate = 44100.0;
+    const int rateIndex = args.indexOf("--sample-rate");
+    if (rateIndex >= 0 && rateIndex + 1 < args.size())
+    {
+        sampleRate = args[rateIndex + 1].getDoubleValue();
+    }
+
+    OfflineRenderer renderer(timeline);
+    const int tailIndex = args.indexOf("--tail");
+    if (tailIndex >= 0 && tailIndex + 1 < args.size())
+    {
+        renderer.setTailLength(args[tailIndex + 1].getDoubleValue());
+    }
+
+    const double startMs = juce::Time::getMillisecondCounterHiRes();
+    auto result = renderer.render(outputFile, sampleRate,
+        [](double progress) { std::cout << "\r" << juce::roundToInt(progress * 100) << "%" << std::flush; return true; });
+    std::cout << std::endl;
+
+    if (result.failed())
+    {
+        std::cerr << result.getErrorMessage() << std::endl;
+        return 1;
+    }
+
+    const double renderSecs = (juce::Time::getMillisecondCounterHiRes() - startMs) / 1000.0;
+    std::cout << "Rendered " << outputFile.getFullPathName() << " in " << renderSecs << "s" << std::endl;
+    return 0;
+}
+
+
+/**
+ * Prepares a music library without opening a window or an audio device, so the decks load
+ * its tracks at once later: DJApp --scan [<folder> ...] [--playlist <playlist.csv>]
+ * Imports the folders into the playlist, then reads, indexes and analyses every track in it
+ * with a worker thread on every core, and saves the playlist with the durations filled in.
+ *
+ * @param args: the command line
+ * @returns: the process exit code
+ */
+static int scanFromCommandLine(const juce::StringArray& args)
+{
+    auto workingDirectory = juce::File::getCurrentWorkingDirectory();
+    auto playlistFile = TrackStore::getPlaylistFile();
+    juce::Array<juce::File> folders;
+    for (int index = args.indexOf("--scan") + 1; index < args.size(); ++index)
+    {
+        if (args[index] == "--playlist" && index + 1 < args.size())
+        {
+            playlistFile = workingDirectory.getChildFile(args[++index].unquoted());
+        }
+        else if (!args[index].startsWith("--"))
+        {
+            folders.add(workingDirectory.getChildFile(args[index].unquoted()));
+        }
+    }
+
+    // nothing else runs while scanning, so the scanner's scheduler gets every core
+    TaskScheduler::useAllCores();
+
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+    LibraryScanner scanner(formatManager);
+    scanner.getTracks().loadPlaylist(playlistFile);
+
+    for (const auto& folder : folders)
+    {
+        if (!folder.isDirectory())
+        {
+            std::cerr << "Can't find the folder " << folder.getFullPathName() << std::endl;
+            return 1;
+        }
+        const int numAdded = scanner.importFolder(folder);
+        std::cout << "Imported " << numAdded << " tracks from " << folder.getFullPathName() << std::endl;
+    }
+
+    const double startMs = juce::Time::getMillisecondCounterHiRes();
+    const int numFailed = scanner.analyseAll([](int done, int total)
+    {
+        std::cout << "\r" << done << "/" << total << " tracks" << std::flush;
+        return true;
+    });
+    std::cout << std::endl;
+
+    if (!scanner.getTracks().savePlaylist(playlistFile))
+    {
+        std::cerr << "Can't write the playlist to " << playlistFile.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    const double scanSecs = (juce::Time::getMillisecondCounterHiRes() - startMs) / 1000.0;
+    std::cout << "Analysed " << scanner.getTracks().size() << " tracks in " << scanSecs << "s on "
+              << juce::SharedResourcePointer<TaskScheduler>()->getNumWorkers() << " threads";
+    if (numFailed > 0)
+    {
+        std::cout << ", " << numFailed << " couldn't be read";
+    }
+    std::cout << std::endl << "Saved the playlist to " << playlistFile.getFullPathName() << std::endl;
+    return 0;
+}
 
 
 class DJAppApplication  : public juce::JUCEApplication
@@ -23,6 +156,21 @@ public:
     {
         // This method is where you should put your application's initialisation code..
 
+        // headless modes, for build machines without a display or an audio device
+        auto args = juce::StringArray::fromTokens(commandLine, true);
+        if (args.contains("--render"))
+        {
+            setApplicationReturnValue(renderFromCommandLine(args));
+            quit();
+            return;
+        }
+        if (args.contains("--scan"))
+        {
+            setApplicationReturnValue(scanFromCommandLine(args));
+            quit();
+            return;
+        }
+
         mainWindow.reset (new MainWindow (getApplicationName()));
     }
 
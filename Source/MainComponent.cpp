@@ -1,59 +1,219 @@
 #pragma once
 #include "MainComponent.h"
+#include "OfflineRenderer.h"
+#include "RealtimeSafety.h"
+#include "AudioSettingsPanel.h"
+
+
+/** Runs an OfflineRenderer behind a progress window */
+class MixExportThread : public juce::ThreadWithProgressWindow
+{
+public:
+    MixExportThread(const AutomationTimeline& timeline, const juce::File& _outputFile, double _sampleRate)
+        : juce::ThreadWithProgressWindow("Exporting mix...", true, true),
+          renderer(timeline),
+          outputFile(_outputFile),
+          sampleRate(_sampleRate)
+    {
+    }
+
+    void run() override
+    {
+        result = renderer.render(outputFile, sampleRate,
+            [this](double progress) { setProgress(progress); return !threadShouldExit(); });
+    }
+
+    juce::Result result{ juce::Result::ok() };
+
+private:
+    OfflineRenderer renderer;
+    juce::File outputFile;
+    double sampleRate;
+};
+
 
 MainComponent::MainComponent()
 {
+    startupTrace.mark("members: decks, playlist, meters");
+
     // size of app window
-    setSize(920, 640);
+    setSize(1120, 640);
+
+    // decks must be known to the renderer before the device starts calling back
+    deckRenderer.addDeck(&player1);
+    deckRenderer.addDeck(&player2);
+
+    midiController.addDeck(&player1);
+    midiController.addDeck(&player2);
+
+    player1.setAutomationRecorder(&automationRecorder, 0);
+    player2.setAutomationRecorder(&automationRecorder, 1);
+    deckRenderer.setAutomationRecorder(&automationRecorder);
+
+    readAheadThread.startThread();
+
+   #if JUCE_DEBUG
+    // flag anything on the audio thread that allocates, waits on a lock or blocks
+    RealtimeSafety::setCheckingEnabled(true);
+   #endif
+
+    // reopen the device the way it was set up last time
+    juce::PropertiesFile::Options settingsOptions;
+    settingsOptions.applicationName = "DJApp";
+    settingsOptions.folderName = "DJApp";
+    settingsOptions.filenameSuffix = ".settings";
+    settingsOptions.osxLibrarySubFolder = "Application Support";
+    appSettings.reset(new juce::PropertiesFile(settingsOptions));
+    std::shared_ptr<juce::XmlElement> savedDeviceState(appSettings->getXmlValue("audioDevice"));
 
     // Some platforms require permissions to open input channels so request that here
     if (juce::RuntimePermissions::isRequired(juce::RuntimePermissions::recordAudio)
         && !juce::RuntimePermissions::isGranted(juce::RuntimePermissions::recordAudio))
     {
         juce::RuntimePermissions::request(juce::RuntimePermissions::recordAudio,
-            [&](bool granted) { if (granted) setAudioChannels(2, 2); });
+            [this, savedDeviceState](bool granted) { if (granted) setAudioChannels(2, 4, savedDeviceState.get()); });
     }
     else
     {
         // Specify the number of input and output channels that we want to open
-        setAudioChannels(0, 2);  //zero inputs (no mic), 2 outputs left and right channels
+        // zero inputs (no mic), master on outputs 1/2 and the headphone cue on 3/4 where the device has them
+        setAudioChannels(0, 4, savedDeviceState.get());
     }
+    bufferSizer.setMode((AdaptiveBufferSizer::Mode)appSettings->getIntValue("adaptiveBufferMode", AdaptiveBufferSizer::off));
+    deckRenderer.setCueMix((float)appSettings->getDoubleValue("cueMix", 0.5));
+    deckRenderer.setSplitCue(appSettings->getBoolValue("splitCue", false));
+
+    // MIDI mappings as they were left, the generic layout the first time
+    if (auto savedMappings = appSettings->getXmlValue("midiMappings"))
+    {
+        midiController.restoreFromXml(*savedMappings);
+    }
+    else
+    {
+        midiController.setMappings(MidiController::getDefaultMappings());
+    }
+    midiController.onControlApplied = [this](const MidiController::ControlEvent& event)
+    {
+        (event.deck == 0 ? deckGUI1 : deckGUI2).controlMoved(event.control);
+    };
+    midiController.onLearned = [this](const MidiController::Mapping&)
+    {
+        midiButton.setToggleState(false, juce::dontSendNotification);
+        saveAudioSettings();
+    };
+    midiController.attachTo(deviceManager);
+    autoDJ.onDeckChanged = [this](int deck, DJAudioPlayer::Control control)
+    {
+        (deck == 0 ? deckGUI1 : deckGUI2).controlMoved(control);
+    };
+    startupTrace.mark("settings and audio device");
 
     addAndMakeVisible(deckGUI1);
     addAndMakeVisible(deckGUI2);
     addAndMakeVisible(playlistComponent);
 
+    addAndMakeVisible(masterLevelMeter);
+    addChildComponent(masterSpectrum);
+    masterLevelMeter.onSpectrumToggled = [this](bool enabled) { masterSpectrum.setVisible(enabled); resized(); };
+
+    // render each deck on its own core; off by default as it keeps a worker spinning
+    addAndMakeVisible(parallelRenderButton);
+    parallelRenderButton.setTooltip("Render the decks on separate cores");
+    parallelRenderButton.addListener(this);
+
+    addAndMakeVisible(recordSessionButton);
+    recordSessionButton.setTooltip("Record every deck action so the session can be exported");
+    recordSessionButton.addListener(this);
+
+    addAndMakeVisible(exportMixButton);
+    exportMixButton.setColour(juce::TextButton::ColourIds::buttonColourId, juce::Colours::grey);
+    exportMixButton.addListener(this);
+
+    addAndMakeVisible(recordMixButton);
+    recordMixButton.setTooltip("Record the master output to your music folder");
+    recordMixButton.addListener(this);
+    addAndMakeVisible(recordingStatusLabel);
+    recordingStatusLabel.setColour(juce::Label::textColourId, juce::Colours::lightcoral);
+
+    // headphones: how much master to hear against the cued decks
+    addAndMakeVisible(splitCueButton);
+    splitCueButton.setToggleState(deckRenderer.isSplitCue(), juce::dontSendNotification);
+    splitCueButton.setTooltip("Cue on the left ear, master on the right");
+    splitCueButton.addListener(this);
+
+    addAndMakeVisible(cueMixSlider);
+    cueMixSlider.setSliderStyle(juce::Slider::SliderStyle::LinearHorizontal);
+    cueMixSlider.setTextBoxStyle(juce::Slider::TextEntryBoxPosition::NoTextBox, true, 0, 0);
+    cueMixSlider.setRange(0.0, 1.0);
+    cueMixSlider.setValue(deckRenderer.getCueMix(), juce::dontSendNotification);
+    cueMixSlider.setTooltip("Headphones: cued decks on the left, master on the right");
+    cueMixSlider.addListener(this);
+
+    addChildComponent(performanceOverlay);
+    addAndMakeVisible(performanceButton);
+    performanceButton.setTooltip("Show audio callback timings");
+    performanceButton.addListener(this);
+
+    addAndMakeVisible(audioSettingsButton);
+    audioSettingsButton.setColour(juce::TextButton::ColourIds::buttonColourId, juce::Colours::grey);
+    audioSettingsButton.setTooltip("Audio device, sample rate and buffer size");
+    audioSettingsButton.addListener(this);
+
+    addAndMakeVisible(midiButton);
+    midiButton.setColour(juce::TextButton::ColourIds::buttonColourId, juce::Colours::grey);
+    midiButton.setColour(juce::TextButton::ColourIds::buttonOnColourId, juce::Colours::coral);
+    midiButton.setTooltip("Map a deck control to your MIDI controller: pick it, then move the knob or press the button");
+    midiButton.addListener(this);
+
     // otherwise app won't know formats e.g. mp3
     formatManager.registerBasicFormats(); 
+    startupTrace.mark("controls and formats");
+    startupTrace.finish();
 }
 
 MainComponent::~MainComponent()
 {
+    if (audioSettingsWindow != nullptr)
+    {
+        delete audioSettingsWindow.getComponent();
+    }
+    saveAudioSettings();
+
     // This shuts down the audio device and clears the audio source.
     shutdownAudio();
+    mixRecorder.stopRecording();
+    deckRenderer.setParallelRendering(false);
+    RealtimeSafety::setCheckingEnabled(false);
 }
 
 void MainComponent::prepareToPlay(int samplesPerBlockExpected, double sampleRate)
 {
-    player1.prepareToPlay(samplesPerBlockExpected, sampleRate);
-    player2.prepareToPlay(samplesPerBlockExpected, sampleRate);
-    mixerSource.prepareToPlay(samplesPerBlockExpected, sampleRate);
-    mixerSource.addInputSource(&player1, false);
-    mixerSource.addInputSource(&player2, false);
+    deckRenderer.prepareToPlay(samplesPerBlockExpected, sampleRate);
+    automationRecorder.setSampleRate(sampleRate);
+    callbackMonitor.prepare(sampleRate, samplesPerBlockExpected);
+    masterMeter.prepare(sampleRate, samplesPerBlockExpected);
 }
 
 void MainComponent::getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill)
 {
-    mixerSource.getNextAudioBlock(bufferToFill);
+    RealtimeSafety::ScopedRealtimeSection realtimeSection;
+    const auto callbackStart = callbackMonitor.beginCallback();
+
+    midiController.processBlock();
+    deckRenderer.renderAndMix(bufferToFill);
+    masterMeter.process(*bufferToFill.buffer, bufferToFill.startSample, bufferToFill.numSamples);
+    automationRecorder.advanceClock(bufferToFill.numSamples);
+    mixRecorder.pushBlock(bufferToFill);
+    taskScheduler->reportAudioLoad(deckRenderer.getLastRenderLoad());
+
+    callbackMonitor.endCallback(callbackStart, bufferToFill.numSamples);
 }
 
 
 void MainComponent::releaseResources()
 {
     // Called when the audio device stops or when it is being restarted due to a setting change.
-    player1.releaseResources();
-    player2.releaseResources();
-    mixerSource.releaseResources();
+    deckRenderer.releaseResources();
 }
 
 
@@ -65,24 +225,281 @@ void MainComponent::paint(juce::Graphics& g)
 
 void MainComponent::resized()
 {
+    const int barHeight = 24;
+    auto deckHeight = getHeight() - barHeight;
+
     // left deck
     deckGUI1.setBounds(
         0, //start at X
         0,  //start Y
         5 * getWidth() / 14, // width
-        getHeight()); // height
+        deckHeight); // height
 
-    // playlist
+    // playlist, with the master meter and, when it's on, the master spectrum under it
+    const int masterMeterHeight = 20;
+    const int masterSpectrumHeight = masterSpectrum.isVisible() ? 100 : 0;
     playlistComponent.setBounds(
         5 * getWidth() / 14,
         0,
         4 * getWidth() / 14,
-        getHeight());
+        deckHeight - masterMeterHeight - masterSpectrumHeight);
+    masterSpectrum.setBounds(5 * getWidth() / 14, playlistComponent.getBottom(), 4 * getWidth() / 14, masterSpectrumHeight);
+    masterLevelMeter.setBounds(5 * getWidth() / 14, masterSpectrum.getBottom(), 4 * getWidth() / 14, masterMeterHeight);
 
     // right deck
     deckGUI2.setBounds(
         9 * getWidth() / 14,
         0,
         5 * getWidth() / 14,
-        getHeight());
+        deckHeight);
+
+    // master bar
+    parallelRenderButton.setBounds(4, deckHeight, 180, barHeight);
+    recordSessionButton.setBounds(190, deckHeight, 140, barHeight);
+    exportMixButton.setBounds(336, deckHeight + 2, 110, barHeight - 4);
+    recordMixButton.setBounds(456, deckHeight, 110, barHeight);
+    recordingStatusLabel.setBounds(566, deckHeight, getWidth() - 946, barHeight);
+    splitCueButton.setBounds(getWidth() - 376, deckHeight, 90, barHeight);
+    cueMixSlider.setBounds(getWidth() - 286, deckHeight, 84, barHeight);
+    midiButton.setBounds(getWidth() - 198, deckHeight + 2, 48, barHeight - 4);
+    audioSettingsButton.setBounds(getWidth() - 146, deckHeight + 2, 70, barHeight - 4);
+    performanceButton.setBounds(getWidth() - 70, deckHeight, 66, barHeight);
+
+    // performance overlay, centred over the decks
+    performanceOverlay.setBounds(juce::Rectangle<int>(0, 0, getWidth(), deckHeight).withSizeKeepingCentre(
+        juce::jmin(getWidth() - 20, 520), juce::jmin(deckHeight - 20, 320)));
+}
+
+void MainComponent::buttonClicked(juce::Button* button)
+{
+    if (button == &parallelRenderButton)
+    {
+        deckRenderer.setParallelRendering(parallelRenderButton.getToggleState());
+    }
+    else if (button == &recordSessionButton)
+    {
+        if (recordSessionButton.getToggleState())
+        {
+            // start from the decks as they are now
+            automationRecorder.start();
+            player1.recordCurrentState();
+            player2.recordCurrentState();
+            deckRenderer.recordCurrentState();
+        }
+        else
+        {
+            automationRecorder.stop();
+        }
+    }
+    else if (button == &splitCueButton)
+    {
+        deckRenderer.setSplitCue(splitCueButton.getToggleState());
+    }
+    else if (button == &audioSettingsButton)
+    {
+        showAudioSettings();
+    }
+    else if (button == &midiButton)
+    {
+        showMidiLearnMenu();
+    }
+    else if (button == &performanceButton)
+    {
+        performanceOverlay.setVisible(performanceButton.getToggleState());
+    }
+    else if (button == &exportMixButton)
+    {
+        exportMix();
+    }
+    else if (button == &recordMixButton)
+    {
+        if (recordMixButton.getToggleState())
+        {
+            startMixRecording();
+        }
+        else
+        {
+            mixRecorder.stopRecording();
+            stopTimer();
+            timerCallback();
+        }
+    }
+}
+
+void MainComponent::sliderValueChanged(juce::Slider* slider)
+{
+    if (slider == &cueMixSlider)
+    {
+        deckRenderer.setCueMix((float)cueMixSlider.getValue());
+    }
+}
+
+void MainComponent::timerCallback()
+{
+    // recording status: length so far, and whether the disk has been keeping up
+    if (mixRecorder.isRecording())
+    {
+        const int seconds = (int)mixRecorder.getRecordedSeconds();
+        juce::String status = "REC " + juce::String(seconds / 60) + ":" + juce::String(seconds % 60).paddedLeft('0', 2);
+        if (mixRecorder.getNumDroppedBlocks() > 0)
+        {
+            status << "  (" << mixRecorder.getNumDroppedBlocks() << " blocks dropped)";
+        }
+        recordingStatusLabel.setText(status, juce::dontSendNotification);
+    }
+    else
+    {
+        recordingStatusLabel.setText("", juce::dontSendNotification);
+    }
+}
+
+void MainComponent::showAudioSettings()
+{
+    if (audioSettingsWindow != nullptr)
+    {
+        audioSettingsWindow->toFront(true);
+        return;
+    }
+
+    juce::DialogWindow::LaunchOptions options;
+    options.content.setOwned(new AudioSettingsPanel(deviceManager, bufferSizer));
+    options.dialogTitle = "Audio settings";
+    options.dialogBackgroundColour = getLookAndFeel().findColour(juce::ResizableWindow::backgroundColourId);
+    options.escapeKeyTriggersCloseButton = true;
+    options.useNativeTitleBar = true;
+    options.resizable = true;
+    audioSettingsWindow = options.launchAsync();
+}
+
+void MainComponent::saveAudioSettings()
+{
+    if (auto deviceState = deviceManager.createStateXml())
+    {
+        appSettings->setValue("audioDevice", deviceState.get());
+    }
+    appSettings->setValue("adaptiveBufferMode", (int)bufferSizer.getMode());
+    appSettings->setValue("cueMix", (double)deckRenderer.getCueMix());
+    appSettings->setValue("splitCue", deckRenderer.isSplitCue());
+    appSettings->setValue("midiMappings", midiController.createXml().get());
+    appSettings->saveIfNeeded();
+}
+
+void MainComponent::showMidiLearnMenu()
+{
+    // item ids: deck * numControls + control + 1, then the extra actions after them
+    const int cancelId = 2 * DJAudioPlayer::numControls + 1;
+    const int defaultsId = cancelId + 1;
+
+    juce::PopupMenu menu;
+    for (int deck = 0; deck < 2; ++deck)
+    {
+        juce::PopupMenu deckMenu;
+        for (int control = 0; control < DJAudioPlayer::numControls; ++control)
+        {
+            deckMenu.addItem(deck * DJAudioPlayer::numControls + control + 1,
+                MidiController::getControlName((DJAudioPlayer::Control)control));
+        }
+        menu.addSubMenu("Deck " + juce::String(deck + 1), deckMenu);
+    }
+    menu.addSeparator();
+    menu.addItem(cancelId, "Stop learning", midiController.isLearning());
+    menu.addItem(defaultsId, "Reset to the default layout");
+
+    juce::Component::SafePointer<MainComponent> safeThis(this);
+    menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(&midiButton),
+        [safeThis, cancelId, defaultsId](int result)
+        {
+            if (safeThis == nullptr || result == 0)
+            {
+                return;
+            }
+
+            auto& controller = safeThis->midiController;
+            if (result == cancelId)
+            {
+                controller.cancelLearning();
+            }
+            else if (result == defaultsId)
+            {
+                controller.cancelLearning();
+                controller.setMappings(MidiController::getDefaultMappings());
+                safeThis->saveAudioSettings();
+            }
+            else
+            {
+                controller.learn((result - 1) / DJAudioPlayer::numControls,
+                    (DJAudioPlayer::Control)((result - 1) % DJAudioPlayer::numControls));
+            }
+            safeThis->midiButton.setToggleState(controller.isLearning(), juce::dontSendNotification);
+        });
+}
+
+void MainComponent::startMixRecording()
+{
+    auto* device = deviceManager.getCurrentAudioDevice();
+    if (device == nullptr)
+    {
+        recordMixButton.setToggleState(false, juce::dontSendNotification);
+        return;
+    }
+
+    auto folder = juce::File::getSpecialLocation(juce::File::userMusicDirectory).getChildFile("DJApp Recordings");
+    folder.createDirectory();
+    auto file = folder.getChildFile("mix " + juce::Time::getCurrentTime().formatted("%Y-%m-%d %H-%M-%S") + ".wav");
+
+    if (mixRecorder.startRecording(file, device->getCurrentSampleRate(), 2))
+    {
+        startTimer(500);
+    }
+    else
+    {
+        recordMixButton.setToggleState(false, juce::dontSendNotification);
+        juce::AlertWindow::showMessageBox(juce::AlertWindow::AlertIconType::WarningIcon,
+            "Record mix:",
+            "Can't write to " + file.getFullPathName(),
+            "OK",
+            nullptr
+        );
+    }
+}
+
+void MainComponent::exportMix()
+{
+    auto timeline = automationRecorder.getTimeline();
+    if (timeline.isEmpty())
+    {
+        juce::AlertWindow::showMessageBox(juce::AlertWindow::AlertIconType::InfoIcon,
+            "Export mix:",
+            "Record a session first",
+            "OK",
+            nullptr
+        );
+        return;
+    }
+
+    juce::FileChooser chooser{ "Export mix as", {}, "*.wav;*.flac" };
+    if (chooser.browseForFileToSave(true))
+    {
+        auto outputFile = chooser.getResult();
+        timeline.saveToFile(outputFile.withFileExtension("xml"));
+
+        double sampleRate = 44100.0;
+        if (auto* device = deviceManager.getCurrentAudioDevice())
+        {
+            sampleRate = device->getCurrentSampleRate();
+        }
+
+        MixExportThread exportThread(timeline, outputFile, sampleRate);
+        exportThread.runThread();
+
+        if (exportThread.result.failed())
+        {
+            juce::AlertWindow::showMessageBox(juce::AlertWindow::AlertIconType::WarningIcon,
+                "Export mix:",
+                exportThread.result.getErrorMessage(),
+                "OK",
+                nullptr
+            );
+        }
+    }
 }
\ No newline at end of file
@@ -2,11 +2,27 @@
 
 #include <JuceHeader.h>
 #include "DJAudioPlayer.h"
+#include "DeckRenderPool.h"
+#include "AutomationTimeline.h"
+#include "MixRecorder.h"
+#include "AudioCallbackMonitor.h"
+#include "PerformanceOverlay.h"
+#include "AdaptiveBufferSizer.h"
+#include "AudioMeter.h"
+#include "LevelMeterComponent.h"
+#include "SpectrumDisplay.h"
 #include "DeckGUI.h"
+#include "MidiController.h"
+#include "AutoDJ.h"
+#include "TaskScheduler.h"
 #include "PlaylistComponent.h"
+#include "StartupTrace.h"
 
 
-class MainComponent : public juce::AudioAppComponent
+class MainComponent : public juce::AudioAppComponent,
+    public juce::Button::Listener,
+    public juce::Slider::Listener,
+    public juce::Timer
 {
 public:
     /**
@@ -74,21 +90,107 @@ public:
      */
     void resized() override;
 
+    /**
+     * Checks which button is pressed and runs different functions.
+     *
+     * @param button: the button that was clicked
+     */
+    void buttonClicked(juce::Button* button) override;
+
+    /**
+     * Passes the headphone cue mix on to the renderer.
+     *
+     * @param slider: the slider that changed
+     */
+    void sliderValueChanged(juce::Slider* slider) override;
+
+    /**
+     * Pure virtual function.
+     * The user-defined callback routine that actually gets called periodically.
+     */
+    void timerCallback() override;
+
 private:
+    // times construction, so first: it starts the clock before the other members
+    StartupTrace startupTrace{ "MainComponent" };
+
+    // decodes the loaded tracks ahead of the playheads, off the audio thread
+    juce::TimeSliceThread readAheadThread{ "Deck read-ahead" };
+
+    // analysis, indexing and duration probing, held back while the decks need the CPU
+    juce::SharedResourcePointer<TaskScheduler> taskScheduler;
+
     // creates left deck
-    DJAudioPlayer player1{ formatManager };
-    DeckGUI deckGUI1{ 1, &player1 , formatManager , thumbCache };
+    DJAudioPlayer player1{ formatManager, &readAheadThread };
+    DeckGUI deckGUI1{ 1, &player1 , formatManager };
 
     // creates right deck
-    DJAudioPlayer player2{ formatManager };
-    DeckGUI deckGUI2{ 2, &player2 , formatManager , thumbCache };
+    DJAudioPlayer player2{ formatManager, &readAheadThread };
+    DeckGUI deckGUI2{ 2, &player2 , formatManager };
+
+    // plays the decks from a MIDI controller, applying its moves on the audio thread
+    MidiController midiController;
 
-    juce::MixerAudioSource mixerSource;
+    // renders both decks, optionally in parallel, and mixes them
+    DeckRenderPool deckRenderer;
     juce::AudioFormatManager formatManager;
-    juce::AudioThumbnailCache thumbCache{ 100 }; // stores max 100 cached waveforms at a time
 
-    DJAudioPlayer metadataParser{ formatManager };
-    PlaylistComponent playlistComponent{ &deckGUI1, &deckGUI2, &metadataParser };
+    // plays the playlist's queue, mixing each track into the next on the beat
+    AutoDJ autoDJ{ player1, player2, deckRenderer, formatManager };
+
+    PlaylistComponent playlistComponent{ &deckGUI1, &deckGUI2, formatManager, &autoDJ };
+
+    // records deck actions so the session can be rendered offline
+    AutomationRecorder automationRecorder;
+
+    // records the master output to disk
+    MixRecorder mixRecorder;
+
+    // times every callback against its deadline, shown on the performance overlay
+    AudioCallbackMonitor callbackMonitor;
+    PerformanceOverlay performanceOverlay{ callbackMonitor, { &player1, &player2 }, deviceManager };
+
+    // master levels and spectrum, under the playlist
+    AudioMeter masterMeter;
+    LevelMeterComponent masterLevelMeter{ masterMeter };
+    SpectrumDisplay masterSpectrum{ masterMeter };
+
+    // finds the smallest buffer size the device runs cleanly at
+    AdaptiveBufferSizer bufferSizer{ callbackMonitor, deviceManager };
+
+    // device settings and adaptive buffer mode, kept between runs
+    std::unique_ptr<juce::PropertiesFile> appSettings;
+    juce::Component::SafePointer<juce::DialogWindow> audioSettingsWindow;
+
+    // master controls along the bottom of the window
+    juce::ToggleButton parallelRenderButton{ "Parallel deck DSP" };
+    juce::ToggleButton recordSessionButton{ "Record session" };
+    juce::TextButton exportMixButton{ "EXPORT MIX" };
+    juce::ToggleButton recordMixButton{ "Record mix" };
+    juce::Label recordingStatusLabel;
+    juce::ToggleButton splitCueButton{ "Split cue" };
+    juce::Slider cueMixSlider;
+    juce::ToggleButton performanceButton{ "Perf" };
+    juce::TextButton audioSettingsButton{ "AUDIO" };
+    juce::TextButton midiButton{ "MIDI" };
+
+    /** Opens the audio device settings window */
+    void showAudioSettings();
+
+    /** Stores the device state, adaptive buffer mode, headphone settings and MIDI mappings for the next run */
+    void saveAudioSettings();
+
+    /** Offers the deck controls to map to a MIDI controller, and learns the one picked */
+    void showMidiLearnMenu();
+
+    /** Starts recording the master output to a new file in the user's music folder */
+    void startMixRecording();
+
+    /**
+     * Asks for a .wav or .flac file and renders the recorded session into it, saving
+     * the automation alongside so it can be rendered again headless.
+     */
+    void exportMix();
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MainComponent)
 };
\ No newline at end of file
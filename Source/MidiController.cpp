@@ -0,0 +1,503 @@
+/*
+  ==============================================================================
+
+    MidiController.cpp
+    Created: 19 Oct 2026 11:58:26pm
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#include "MidiController.h"
+#include <cmath>
+
+
+/** @returns: true for the controls that only take effect when the message thread follows them up */
+static bool isDispatchedControl(DJAudioPlayer::Control control)
+{
+    return control == DJAudioPlayer::playControl;
+}
+
+/** @returns: true for the controls that take a position rather than a press or a move */
+static bool isContinuousControl(DJAudioPlayer::Control control)
+{
+    switch (control)
+    {
+        case DJAudioPlayer::gainControl:
+        case DJAudioPlayer::speedControl:
+        case DJAudioPlayer::wetControl:
+        case DJAudioPlayer::freezeControl:
+        case DJAudioPlayer::filterControl:
+            return true;
+        default:
+            return false;
+    }
+}
+
+
+MidiController::MidiController()
+    : inputQueue(queueSize),
+      appliedQueue(queueSize)
+{
+    for (auto& bucket : latencyBuckets)
+    {
+        bucket.store(0);
+    }
+}
+
+MidiController::~MidiController()
+{
+    stopTimer();
+    if (deviceManager != nullptr)
+    {
+        deviceManager->removeMidiInputDeviceCallback({}, this);
+    }
+}
+
+void MidiController::addDeck(DJAudioPlayer* deck)
+{
+    decks.add(deck);
+}
+
+void MidiController::attachTo(juce::AudioDeviceManager& _deviceManager)
+{
+    deviceManager = &_deviceManager;
+
+    // a controller that's plugged in should just work, until inputs are picked in the settings
+    const auto inputs = juce::MidiInput::getAvailableDevices();
+    bool anyEnabled = false;
+    for (auto& input : inputs)
+    {
+        anyEnabled = anyEnabled || deviceManager->isMidiInputDeviceEnabled(input.identifier);
+    }
+    if (!anyEnabled)
+    {
+        for (auto& input : inputs)
+        {
+            deviceManager->setMidiInputDeviceEnabled(input.identifier, true);
+        }
+    }
+
+    deviceManager->addMidiInputDeviceCallback({}, this);
+    startTimerHz(dispatchHz);
+}
+
+void MidiController::setMappings(const juce::Array<Mapping>& newMappings)
+{
+    const juce::SpinLock::ScopedLockType lock(inputLock);
+    mappings = newMappings;
+}
+
+juce::Array<MidiController::Mapping> MidiController::getMappings() const
+{
+    const juce::SpinLock::ScopedLockType lock(inputLock);
+    return mappings;
+}
+
+juce::Array<MidiController::Mapping> MidiController::getDefaultMappings()
+{
+    juce::Array<Mapping> defaults;
+    for (int deck = 0; deck < 2; ++deck)
+    {
+        const int channel = deck + 1;
+        defaults.add({ deck, DJAudioPlayer::playControl, noteKind, channel, 11 });
+        defaults.add({ deck, DJAudioPlayer::cueControl, noteKind, channel, 12 });
+        defaults.add({ deck, DJAudioPlayer::reverseControl, noteKind, channel, 13 });
+        defaults.add({ deck, DJAudioPlayer::jogTouchControl, noteKind, channel, 54 });
+        defaults.add({ deck, DJAudioPlayer::gainControl, controller14BitKind, channel, 7 });
+        defaults.add({ deck, DJAudioPlayer::speedControl, pitchWheelKind, channel, 0 });
+        defaults.add({ deck, DJAudioPlayer::wetControl, controllerKind, channel, 12 });
+        defaults.add({ deck, DJAudioPlayer::freezeControl, controllerKind, channel, 13 });
+        defaults.add({ deck, DJAudioPlayer::filterControl, controllerKind, channel, 14 });
+        defaults.add({ deck, DJAudioPlayer::jogTurnControl, relativeKind, channel, 22 });
+    }
+    return defaults;
+}
+
+void MidiController::learn(int deck, DJAudioPlayer::Control control)
+{
+    const juce::SpinLock::ScopedLockType lock(inputLock);
+    learnTarget = Mapping();
+    learnTarget.deck = deck;
+    learnTarget.control = control;
+    learning = true;
+    learnFinished.store(false);
+}
+
+void MidiController::cancelLearning()
+{
+    const juce::SpinLock::ScopedLockType lock(inputLock);
+    learning = false;
+}
+
+bool MidiController::isLearning() const
+{
+    const juce::SpinLock::ScopedLockType lock(inputLock);
+    return learning;
+}
+
+std::unique_ptr<juce::XmlElement> MidiController::createXml() const
+{
+    auto xml = std::make_unique<juce::XmlElement>("MIDIMAPPINGS");
+    for (auto& mapping : getMappings())
+    {
+        auto* element = xml->createNewChildElement("MAPPING");
+        element->setAttribute("deck", mapping.deck);
+        element->setAttribute("control", getControlName(mapping.control));
+        element->setAttribute("kind", (int)mapping.kind);
+        element->setAttribute("channel", mapping.channel);
+        element->setAttribute("number", mapping.number);
+    }
+    return xml;
+}
+
+void MidiController::restoreFromXml(const juce::XmlElement& xml)
+{
+    if (!xml.hasTagName("MIDIMAPPINGS"))
+    {
+        return;
+    }
+
+    juce::Array<Mapping> restored;
+    for (auto* element : xml.getChildWithTagNameIterator("MAPPING"))
+    {
+        Mapping mapping;
+        mapping.deck = element->getIntAttribute("deck");
+        mapping.kind = (MessageKind)juce::jlimit(0, numMessageKinds - 1, element->getIntAttribute("kind"));
+        mapping.channel = juce::jlimit(1, 16, element->getIntAttribute("channel", 1));
+        mapping.number = juce::jlimit(0, 127, element->getIntAttribute("number"));
+
+        const auto controlName = element->getStringAttribute("control");
+        int control = 0;
+        while (control < DJAudioPlayer::numControls && controlName != getControlName((DJAudioPlayer::Control)control))
+        {
+            ++control;
+        }
+        if (control == DJAudioPlayer::numControls)
+        {
+            DBG("Skipping unknown MIDI mapping: " << controlName);
+            continue;
+        }
+        mapping.control = (DJAudioPlayer::Control)control;
+        restored.add(mapping);
+    }
+    setMappings(restored);
+}
+
+juce::String MidiController::getControlName(DJAudioPlayer::Control control)
+{
+    switch (control)
+    {
+        case DJAudioPlayer::playControl:     return "Play";
+        case DJAudioPlayer::cueControl:      return "Cue";
+        case DJAudioPlayer::reverseControl:  return "Reverse";
+        case DJAudioPlayer::gainControl:     return "Volume";
+        case DJAudioPlayer::speedControl:    return "Speed";
+        case DJAudioPlayer::wetControl:      return "Wet";
+        case DJAudioPlayer::freezeControl:   return "Freeze";
+        case DJAudioPlayer::filterControl:   return "Filter";
+        case DJAudioPlayer::jogTouchControl: return "Jog touch";
+        case DJAudioPlayer::jogTurnControl:  return "Jog turn";
+        default:                             return "";
+    }
+}
+
+void MidiController::handleIncomingMidiMessage(juce::MidiInput*, const juce::MidiMessage& message)
+{
+    if (!message.isNoteOnOrOff() && !message.isController() && !message.isPitchWheel())
+    {
+        return;
+    }
+
+    // inputs stamp messages as they arrive, in seconds; ones made up in code may not be
+    const double receivedMs = message.getTimeStamp() > 0 ? message.getTimeStamp() * 1000.0
+                                                         : juce::Time::getMillisecondCounterHiRes();
+    const int channel = message.getChannel();
+    const int number = message.isController() ? message.getControllerNumber() : -1;
+    const int value = message.isController() ? message.getControllerValue() : 0;
+
+    const juce::SpinLock::ScopedLockType lock(inputLock);
+    if (learning)
+    {
+        if (learnFrom(message))
+        {
+            learning = false;
+            learnFinished.store(true, std::memory_order_release);
+        }
+        return;
+    }
+
+    // the coarse part of a 14-bit controller is kept for its fine part to add to
+    if (juce::isPositiveAndBelow(number, 32))
+    {
+        coarseValues[channel - 1][number] = value;
+    }
+
+    for (auto& mapping : mappings)
+    {
+        if (mapping.channel != channel)
+        {
+            continue;
+        }
+
+        ControlEvent event;
+        event.deck = mapping.deck;
+        event.control = mapping.control;
+        event.receivedMs = receivedMs;
+        bool matched = false;
+
+        switch (mapping.kind)
+        {
+            case noteKind:
+                matched = message.isNoteOnOrOff() && message.getNoteNumber() == mapping.number;
+                event.value = message.isNoteOn() ? 1.0 : 0.0;
+                break;
+            case controllerKind:
+                matched = number == mapping.number;
+                event.value = value / 127.0;
+                break;
+            case controller14BitKind:
+                // the coarse part moves the control on its own, so 7-bit hardware works too
+                if (number == mapping.number)
+                {
+                    matched = true;
+                    event.value = (value << 7) / 16383.0;
+                }
+                else if (number == mapping.number + 32 && juce::isPositiveAndBelow(mapping.number, 32))
+                {
+                    matched = true;
+                    event.value = ((coarseValues[channel - 1][mapping.number] << 7) | value) / 16383.0;
+                }
+                break;
+            case relativeKind:
+                matched = number == mapping.number && value != 64;
+                event.value = (value - 64) * jogSecondsPerTick;
+                break;
+            case pitchWheelKind:
+                matched = message.isPitchWheel();
+                event.value = message.isPitchWheel() ? message.getPitchWheelValue() / 16383.0 : 0.0;
+                break;
+            default:
+                break;
+        }
+
+        if (matched)
+        {
+            pushInput(event);
+        }
+    }
+}
+
+void MidiController::pushInput(const ControlEvent& event)
+{
+    int start1, size1, start2, size2;
+    inputFifo.prepareToWrite(1, start1, size1, start2, size2);
+    if (size1 == 0)
+    {
+        droppedEvents.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    inputQueue[(size_t)start1] = event;
+    inputFifo.finishedWrite(1);
+}
+
+bool MidiController::learnFrom(const juce::MidiMessage& message)
+{
+    Mapping mapping = learnTarget;
+    mapping.channel = message.getChannel();
+
+    if (message.isNoteOn())
+    {
+        mapping.kind = noteKind;
+        mapping.number = message.getNoteNumber();
+    }
+    else if (message.isPitchWheel())
+    {
+        mapping.kind = pitchWheelKind;
+        mapping.number = 0;
+    }
+    else if (message.isController())
+    {
+        mapping.number = message.getControllerNumber();
+        if (mapping.control == DJAudioPlayer::jogTurnControl)
+        {
+            mapping.kind = relativeKind;
+        }
+        else if (mapping.number < 32 && isContinuousControl(mapping.control))
+        {
+            mapping.kind = controller14BitKind;
+        }
+        else
+        {
+            mapping.kind = controllerKind;
+        }
+    }
+    else
+    {
+        // a note off, from letting go of whatever was pressed before learning started
+        return false;
+    }
+
+    mappings.removeIf([&mapping](const Mapping& existing)
+        {
+            return existing.deck == mapping.deck && existing.control == mapping.control;
+        });
+    mappings.add(mapping);
+    learnTarget = mapping;
+    return true;
+}
+
+void MidiController::processBlock()
+{
+    const int numReady = inputFifo.getNumReady();
+    if (numReady == 0)
+    {
+        return;
+    }
+
+    const double nowMs = juce::Time::getMillisecondCounterHiRes();
+    int start1, size1, start2, size2;
+    inputFifo.prepareToRead(numReady, start1, size1, start2, size2);
+    for (int index = start1; index < start1 + size1; ++index)
+    {
+        apply(inputQueue[(size_t)index], nowMs);
+    }
+    for (int index = start2; index < start2 + size2; ++index)
+    {
+        apply(inputQueue[(size_t)index], nowMs);
+    }
+    inputFifo.finishedRead(size1 + size2);
+}
+
+void MidiController::apply(ControlEvent event, double nowMs)
+{
+    if (juce::isPositiveAndBelow(event.deck, decks.size()))
+    {
+        decks.getUnchecked(event.deck)->applyControl(event.control, event.value);
+    }
+
+    // play is timed when the message thread starts or stops the deck
+    event.appliedMs = nowMs;
+    if (!isDispatchedControl(event.control))
+    {
+        recordLatency(event);
+    }
+
+    int start1, size1, start2, size2;
+    appliedFifo.prepareToWrite(1, start1, size1, start2, size2);
+    if (size1 == 0)
+    {
+        droppedEvents.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    appliedQueue[(size_t)start1] = event;
+    appliedFifo.finishedWrite(1);
+}
+
+void MidiController::recordLatency(const ControlEvent& event)
+{
+    // written from the audio thread and the message thread, so the sums are compare-and-swapped
+    const double latencyMs = juce::jmax(0.0, event.appliedMs - event.receivedMs);
+    latencyBuckets[juce::jmin(numLatencyBuckets, (int)(latencyMs / latencyBucketMs))].fetch_add(1, std::memory_order_relaxed);
+
+    double total = totalLatencyMs.load(std::memory_order_relaxed);
+    while (!totalLatencyMs.compare_exchange_weak(total, total + latencyMs, std::memory_order_relaxed))
+    {
+    }
+    double slowest = maxLatencyMs.load(std::memory_order_relaxed);
+    while (latencyMs > slowest && !maxLatencyMs.compare_exchange_weak(slowest, latencyMs, std::memory_order_relaxed))
+    {
+    }
+}
+
+void MidiController::dispatchAppliedControls()
+{
+    int start1, size1, start2, size2;
+    appliedFifo.prepareToRead(appliedFifo.getNumReady(), start1, size1, start2, size2);
+
+    auto dispatch = [this](ControlEvent event)
+    {
+        if (juce::isPositiveAndBelow(event.deck, decks.size()))
+        {
+            decks.getUnchecked(event.deck)->controlApplied(event.control, event.value);
+        }
+        if (isDispatchedControl(event.control))
+        {
+            event.appliedMs = juce::Time::getMillisecondCounterHiRes();
+            recordLatency(event);
+        }
+        if (onControlApplied != nullptr)
+        {
+            onControlApplied(event);
+        }
+    };
+    for (int index = start1; index < start1 + size1; ++index)
+    {
+        dispatch(appliedQueue[(size_t)index]);
+    }
+    for (int index = start2; index < start2 + size2; ++index)
+    {
+        dispatch(appliedQueue[(size_t)index]);
+    }
+    appliedFifo.finishedRead(size1 + size2);
+
+    if (learnFinished.exchange(false, std::memory_order_acquire))
+    {
+        Mapping learned;
+        {
+            const juce::SpinLock::ScopedLockType lock(inputLock);
+            learned = learnTarget;
+        }
+        if (onLearned != nullptr)
+        {
+            onLearned(learned);
+        }
+    }
+}
+
+void MidiController::timerCallback()
+{
+    dispatchAppliedControls();
+}
+
+MidiController::LatencyStatistics MidiController::getLatencyStatistics() const
+{
+    LatencyStatistics statistics;
+    juce::int64 counts[numLatencyBuckets + 1];
+    for (int bucket = 0; bucket <= numLatencyBuckets; ++bucket)
+    {
+        counts[bucket] = latencyBuckets[bucket].load(std::memory_order_relaxed);
+        statistics.count += counts[bucket];
+    }
+    if (statistics.count == 0)
+    {
+        return statistics;
+    }
+
+    statistics.meanMs = totalLatencyMs.load(std::memory_order_relaxed) / statistics.count;
+    statistics.maxMs = maxLatencyMs.load(std::memory_order_relaxed);
+
+    // percentiles to the middle of the bucket they fall in; past the histogram, the slowest seen
+    auto percentile = [&](double fraction)
+    {
+        const auto wanted = (juce::int64)std::ceil(fraction * statistics.count);
+        juce::int64 seen = 0;
+        for (int bucket = 0; bucket < numLatencyBuckets; ++bucket)
+        {
+            seen += counts[bucket];
+            if (seen >= wanted)
+            {
+                return juce::jmin(statistics.maxMs, (bucket + 0.5) * latencyBucketMs);
+            }
+        }
+        return statistics.maxMs;
+    };
+    statistics.medianMs = percentile(0.5);
+    statistics.p99Ms = percentile(0.99);
+    return statistics;
+}
+
+int MidiController::getNumDroppedEvents() const
+{
+    return droppedEvents.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,223 @@
+/*
+  ==============================================================================
+
+    MidiController.h
+    Created: 19 Oct 2026 11:58:26pm
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <atomic>
+#include <functional>
+#include <vector>
+#include "DJAudioPlayer.h"
+
+
+/**
+ * Plays the decks from a MIDI controller.
+ *
+ * Messages are time stamped as they come in on the MIDI thread, turned into deck controls
+ * through the mappings and queued in a lock-free FIFO. The audio thread applies them to
+ * the decks at the start of its next block, without going through the message thread,
+ * and passes them on through a second FIFO so the message thread can start and stop
+ * decks, record automation and move the controls on screen. Play only takes effect there,
+ * up to a dispatch interval later.
+ *
+ * Faders can send 14-bit values, either as pitch wheel messages or as a controller below
+ * 32 with its fine part on the controller 32 above, and jog wheels send relative moves.
+ * A control is mapped by learning it: pick it with learn(), then move the hardware.
+ */
+class MidiController : public juce::MidiInputCallback,
+    private juce::Timer
+{
+public:
+    /** How a mapped control's messages carry its value */
+    enum MessageKind
+    {
+        noteKind = 0,          // note on for pressed, note off for released
+        controllerKind,        // 7-bit controller, 0 to 127
+        controller14BitKind,   // controller below 32, with its fine part on the one 32 above
+        relativeKind,          // controller with 64 for no movement and ticks either side of it
+        pitchWheelKind,        // pitch wheel, 14 bits
+        numMessageKinds
+    };
+
+    /** One hardware control driving one deck control */
+    struct Mapping
+    {
+        int deck = 0;
+        DJAudioPlayer::Control control = DJAudioPlayer::playControl;
+        MessageKind kind = noteKind;
+        int channel = 1;   // 1 to 16
+        int number = 0;    // note or controller number, unused for the pitch wheel
+    };
+
+    /** A control the hardware moved */
+    struct ControlEvent
+    {
+        int deck = 0;
+        DJAudioPlayer::Control control = DJAudioPlayer::playControl;
+        double value = 0;        // see DJAudioPlayer::Control
+        double receivedMs = 0;   // Time::getMillisecondCounterHiRes() when the message came in
+        double appliedMs = 0;    // and when it took effect: on the audio thread, or for play on the message thread
+    };
+
+    /** How long controls took from coming in to taking effect, play included */
+    struct LatencyStatistics
+    {
+        juce::int64 count = 0;
+        double meanMs = 0;
+        double medianMs = 0;
+        double p99Ms = 0;
+        double maxMs = 0;
+    };
+
+    /** Seconds of track one tick of a jog wheel moves, about 128 ticks to a turn of a record at 33 rpm */
+    static constexpr double jogSecondsPerTick = 1.8 / 128.0;
+
+    /** How often applied controls are followed up on the message thread, once attached */
+    static constexpr int dispatchHz = 60;
+
+    /** Constructor */
+    MidiController();
+
+    /** Destructor. Stops listening to the device manager's MIDI inputs. */
+    ~MidiController() override;
+
+    /**
+     * Adds a deck for the mappings to drive, numbered in the order added. Call before
+     * any MIDI comes in.
+     *
+     * @param deck: the deck's player
+     */
+    void addDeck(DJAudioPlayer* deck);
+
+    /**
+     * Listens to the MIDI inputs enabled on a device manager, enabling all of them if none
+     * is, and starts passing applied controls on to the message thread. Message thread only.
+     *
+     * @param _deviceManager: the app's device manager; must outlive the controller
+     */
+    void attachTo(juce::AudioDeviceManager& _deviceManager);
+
+    /**
+     * Replaces all the mappings.
+     *
+     * @param newMappings: the mappings to use
+     */
+    void setMappings(const juce::Array<Mapping>& newMappings);
+
+    /** @returns: a copy of the mappings in use */
+    juce::Array<Mapping> getMappings() const;
+
+    /** @returns: a layout for a generic two-deck controller, deck 1 on channel 1 and deck 2 on channel 2 */
+    static juce::Array<Mapping> getDefaultMappings();
+
+    /**
+     * Maps a deck control to the next note, controller or pitch wheel message that comes in,
+     * in place of whatever it was mapped to.
+     *
+     * @param deck: the deck
+     * @param control: the control on it
+     */
+    void learn(int deck, DJAudioPlayer::Control control);
+
+    /** Stops waiting for a message to learn */
+    void cancelLearning();
+
+    /** @returns: true while waiting for a message to learn */
+    bool isLearning() const;
+
+    /** @returns: the mappings as XML, to save with the app's settings */
+    std::unique_ptr<juce::XmlElement> createXml() const;
+
+    /**
+     * Replaces the mappings with ones saved by createXml().
+     *
+     * @param xml: the saved mappings
+     */
+    void restoreFromXml(const juce::XmlElement& xml);
+
+    /** @returns: the name a control is shown and saved under */
+    static juce::String getControlName(DJAudioPlayer::Control control);
+
+    /**
+     * Time stamps a message and queues the deck controls it moves. Called on the MIDI thread.
+     *
+     * @param source: the input it came from
+     * @param message: the message
+     */
+    void handleIncomingMidiMessage(juce::MidiInput* source, const juce::MidiMessage& message) override;
+
+    /** Applies the controls that came in since the last block. Audio thread, before the decks render. */
+    void processBlock();
+
+    /**
+     * Follows up the controls the audio thread applied, and reports a finished learn.
+     * Message thread; runs from a timer once attached, or call it directly without one.
+     */
+    void dispatchAppliedControls();
+
+    /** Called on the message thread for every control applied, after the deck has followed it up */
+    std::function<void(const ControlEvent&)> onControlApplied;
+
+    /** Called on the message thread when learn() has mapped a control */
+    std::function<void(const Mapping&)> onLearned;
+
+    /** @returns: how long controls have taken from coming in to taking effect, so far */
+    LatencyStatistics getLatencyStatistics() const;
+
+    /** @returns: number of controls that didn't fit in a FIFO */
+    int getNumDroppedEvents() const;
+
+private:
+    // a burst from every fader at once fits many times over
+    static constexpr int queueSize = 1024;
+    // latency histogram, in steps of a tenth of a millisecond
+    static constexpr int numLatencyBuckets = 500;
+    static constexpr double latencyBucketMs = 0.1;
+
+    juce::Array<DJAudioPlayer*> decks;
+    juce::AudioDeviceManager* deviceManager = nullptr;
+
+    // taken by the MIDI threads, as several inputs can be calling back at once, and by the
+    // message thread when the mappings change; never by the audio thread
+    juce::SpinLock inputLock;
+    juce::Array<Mapping> mappings;
+    int coarseValues[16][32] = {};   // last coarse part of each 14-bit controller, per channel
+    bool learning = false;
+    Mapping learnTarget;
+    std::atomic<bool> learnFinished{ false };
+
+    // MIDI threads to the audio thread
+    juce::AbstractFifo inputFifo{ queueSize };
+    std::vector<ControlEvent> inputQueue;
+
+    // audio thread to the message thread
+    juce::AbstractFifo appliedFifo{ queueSize };
+    std::vector<ControlEvent> appliedQueue;
+
+    std::atomic<int> droppedEvents{ 0 };
+    std::atomic<juce::int64> latencyBuckets[numLatencyBuckets + 1];   // the last one counts anything slower
+    std::atomic<double> totalLatencyMs{ 0 };
+    std::atomic<double> maxLatencyMs{ 0 };
+
+    /** Queues one control for the audio thread. MIDI thread, holding inputLock. */
+    void pushInput(const ControlEvent& event);
+
+    /** Applies one control and queues it for the message thread. Audio thread. */
+    void apply(ControlEvent event, double nowMs);
+
+    /** Adds one control's latency to the statistics. Audio or message thread. */
+    void recordLatency(const ControlEvent& event);
+
+    /** Maps the learn target to a message, @returns: false if it's not a kind that can be mapped */
+    bool learnFrom(const juce::MidiMessage& message);
+
+    void timerCallback() override;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MidiController)
+};
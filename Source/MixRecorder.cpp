@@ -0,0 +1,188 @@
+/*
+  ==============================================================================
+
+    MixRecorder.cpp
+    Created: 19 Oct 2026 3:20:12pm
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#include "MixRecorder.h"
+
+
+MixRecorder::MixRecorder() : juce::Thread("Mix recorder")
+{
+}
+
+MixRecorder::~MixRecorder()
+{
+    stopRecording();
+}
+
+bool MixRecorder::startRecording(const juce::File& file, double sampleRate, int numChannels)
+{
+    stopRecording();
+
+    file.deleteFile();
+    std::unique_ptr<juce::OutputStream> stream(file.createOutputStream());
+    if (stream == nullptr)
+    {
+        DBG("Can't record to " << file.getFullPathName());
+        return false;
+    }
+
+    juce::WavAudioFormat wavFormat;
+    std::unique_ptr<juce::AudioFormatWriter> newWriter(wavFormat.createWriterFor(stream.get(),
+        sampleRate, (unsigned int)numChannels, 24, {}, 0));
+    if (newWriter == nullptr)
+    {
+        return false;
+    }
+    stream.release(); // the writer owns it now
+
+    // everything the audio thread touches is allocated here, before recording is switched on
+    const int fifoSize = (int)(fifoSeconds * sampleRate);
+    batchSize = (int)(batchSeconds * sampleRate);
+    fifo.setTotalSize(fifoSize);
+    fifoBuffer.setSize(numChannels, fifoSize);
+    writeBuffer.setSize(numChannels, batchSize * 2);
+    recordingSampleRate = sampleRate;
+    droppedBlocks.store(0);
+    samplesWritten.store(0);
+
+    {
+        const juce::ScopedLock sl(writerLock);
+        writer = std::move(newWriter);
+    }
+
+    startThread();
+    recording.store(true, std::memory_order_release);
+    return true;
+}
+
+void MixRecorder::stopRecording()
+{
+    if (!recording.exchange(false))
+    {
+        return;
+    }
+
+    // the audio thread may have seen recording on just before; once it's out of pushBlock()
+    // it can't go back in, so the FIFO can be drained here and resized by the next recording
+    while (pushing.load())
+    {
+        juce::Thread::yield();
+    }
+
+    stopThread(2000);
+
+    // whatever is still in the FIFO goes out before the file is closed
+    drainFifo(0);
+
+    const juce::ScopedLock sl(writerLock);
+    writer.reset();
+}
+
+bool MixRecorder::isRecording() const
+{
+    return recording.load();
+}
+
+void MixRecorder::pushBlock(const juce::AudioSourceChannelInfo& bufferToFill)
+{
+    // marked before recording is checked, so stopRecording() either sees it or stops us here
+    pushing.store(true);
+    if (!recording.load())
+    {
+        pushing.store(false, std::memory_order_release);
+        return;
+    }
+    copyToFifo(bufferToFill);
+    pushing.store(false, std::memory_order_release);
+}
+
+void MixRecorder::copyToFifo(const juce::AudioSourceChannelInfo& bufferToFill)
+{
+    // drop the whole block rather than write part of it, a clean gap is easier to find later
+    if (fifo.getFreeSpace() < bufferToFill.numSamples)
+    {
+        droppedBlocks.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite(bufferToFill.numSamples, start1, size1, start2, size2);
+
+    for (int channel = 0; channel < fifoBuffer.getNumChannels(); ++channel)
+    {
+        if (channel < bufferToFill.buffer->getNumChannels())
+        {
+            fifoBuffer.copyFrom(channel, start1, *bufferToFill.buffer, channel, bufferToFill.startSample, size1);
+            if (size2 > 0)
+            {
+                fifoBuffer.copyFrom(channel, start2, *bufferToFill.buffer, channel,
+                    bufferToFill.startSample + size1, size2);
+            }
+        }
+        else
+        {
+            fifoBuffer.clear(channel, start1, size1);
+            fifoBuffer.clear(channel, start2, size2);
+        }
+    }
+    fifo.finishedWrite(size1 + size2);
+}
+
+int MixRecorder::getNumDroppedBlocks() const
+{
+    return droppedBlocks.load();
+}
+
+double MixRecorder::getRecordedSeconds() const
+{
+    return (double)samplesWritten.load() / recordingSampleRate;
+}
+
+void MixRecorder::run()
+{
+    while (!threadShouldExit())
+    {
+        drainFifo(batchSize);
+        wait(20);
+    }
+}
+
+void MixRecorder::drainFifo(int minimumSamples)
+{
+    if (fifo.getNumReady() < juce::jmax(1, minimumSamples))
+    {
+        return;
+    }
+
+    const juce::ScopedLock sl(writerLock);
+    if (writer == nullptr)
+    {
+        return;
+    }
+
+    while (fifo.getNumReady() > 0)
+    {
+        const int numToWrite = juce::jmin(fifo.getNumReady(), writeBuffer.getNumSamples());
+
+        int start1, size1, start2, size2;
+        fifo.prepareToRead(numToWrite, start1, size1, start2, size2);
+        for (int channel = 0; channel < writeBuffer.getNumChannels(); ++channel)
+        {
+            writeBuffer.copyFrom(channel, 0, fifoBuffer, channel, start1, size1);
+            if (size2 > 0)
+            {
+                writeBuffer.copyFrom(channel, size1, fifoBuffer, channel, start2, size2);
+            }
+        }
+        fifo.finishedRead(size1 + size2);
+
+        writer->writeFromAudioSampleBuffer(writeBuffer, 0, size1 + size2);
+        samplesWritten.fetch_add(size1 + size2);
+    }
+}
@@ -0,0 +1,98 @@
+/*
+  ==============================================================================
+
+    MixRecorder.h
+    Created: 19 Oct 2026 3:20:12pm
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <atomic>
+
+
+/**
+ * Records the master output to a WAV file during a set.
+ *
+ * The audio thread only copies each block into a preallocated lock-free FIFO. A background
+ * thread drains the FIFO in large batches and does all the encoding and disk writing. If
+ * the disk falls behind and the FIFO fills up, blocks are dropped and counted rather than
+ * making the audio thread wait.
+ */
+class MixRecorder : private juce::Thread
+{
+public:
+    /** Constructor */
+    MixRecorder();
+
+    /** Destructor. Finishes any recording in progress. */
+    ~MixRecorder() override;
+
+    /**
+     * Opens a file and starts recording. Message thread only.
+     *
+     * @param file: the .wav file to write, overwritten if it exists
+     * @param sampleRate: the device sample rate
+     * @param numChannels: number of channels to record
+     * @returns: True if the file could be opened, else False
+     */
+    bool startRecording(const juce::File& file, double sampleRate, int numChannels);
+
+    /**
+     * Stops recording, waits for the audio thread to leave pushBlock() if it's inside,
+     * writes out what is left in the FIFO and closes the file. Message thread only.
+     */
+    void stopRecording();
+
+    /** @returns: true while recording */
+    bool isRecording() const;
+
+    /**
+     * Copies a block into the FIFO if recording. Called on the audio thread; never blocks.
+     *
+     * @param bufferToFill: the block just rendered
+     */
+    void pushBlock(const juce::AudioSourceChannelInfo& bufferToFill);
+
+    /** @returns: number of blocks that didn't fit in the FIFO since recording started */
+    int getNumDroppedBlocks() const;
+
+    /** @returns: seconds of audio written so far */
+    double getRecordedSeconds() const;
+
+private:
+    // enough for several seconds of slow disk before anything is dropped
+    static constexpr double fifoSeconds = 4.0;
+    // write in batches of at least this much, so the disk sees few large writes
+    static constexpr double batchSeconds = 0.25;
+
+    juce::AbstractFifo fifo{ 1 };
+    juce::AudioBuffer<float> fifoBuffer;
+    juce::AudioBuffer<float> writeBuffer;
+
+    juce::CriticalSection writerLock;
+    std::unique_ptr<juce::AudioFormatWriter> writer;
+
+    std::atomic<bool> recording{ false };
+    std::atomic<bool> pushing{ false };   // the audio thread is inside pushBlock()
+    std::atomic<int> droppedBlocks{ 0 };
+    std::atomic<juce::int64> samplesWritten{ 0 };
+    double recordingSampleRate = 44100.0;
+    int batchSize = 0;
+
+    void run() override;
+
+    /** Copies a block into the FIFO, or drops it if there's no room. Audio thread. */
+    void copyToFifo(const juce::AudioSourceChannelInfo& bufferToFill);
+
+    /**
+     * Moves whatever is in the FIFO to the file.
+     *
+     * @param minimumSamples: do nothing unless at least this much is waiting
+     */
+    void drainFifo(int minimumSamples);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MixRecorder)
+};
@@ -0,0 +1,422 @@
+/*
+  ==============================================================================
+
+    Mp3SeekIndex.cpp
+    Created: 19 Oct 2026 10:47:52pm
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#include "Mp3SeekIndex.h"
+
+
+// saved index layout, all little endian: magic, version, the track's size and modification
+// time, sample rate, samples per frame, number of offsets, then the offsets
+static const int indexMagic = 0x49534a44; // "DJSI"
+static const int indexVersion = 1;
+
+// how far into a file to look for the first frame, past any tag the header skip missed
+static const int maxSyncSearchBytes = 65536;
+
+// header and the longest layer III side information, which hold no reservoir data
+static const int frameOverheadBytes = 4 + 32;
+
+
+/** What a layer III frame header says */
+struct FrameHeader
+{
+    int sampleRate = 0;
+    int samplesPerFrame = 0;
+    int frameBytes = 0;
+    int sideInfoBytes = 0; // from the end of the header, CRC included
+};
+
+/**
+ * Decodes an MPEG audio frame header.
+ *
+ * @param bytes: the four header bytes
+ * @param header: filled in if it's a valid layer III header
+ * @returns: false if it isn't
+ */
+static bool parseFrameHeader(const juce::uint8* bytes, FrameHeader& header)
+{
+    static const int mpeg1Bitrates[] = { 0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320 };
+    static const int mpeg2Bitrates[] = { 0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160 };
+    static const int mpeg1SampleRates[] = { 44100, 48000, 32000 };
+
+    if (bytes[0] != 0xff || (bytes[1] & 0xe0) != 0xe0)
+    {
+        return false;
+    }
+
+    const int version = (bytes[1] >> 3) & 3;       // 0 MPEG 2.5, 1 reserved, 2 MPEG 2, 3 MPEG 1
+    const int layer = (bytes[1] >> 1) & 3;         // 1 is layer III
+    const bool hasCrc = (bytes[1] & 1) == 0;
+    const int bitrateIndex = (bytes[2] >> 4) & 15;
+    const int sampleRateIndex = (bytes[2] >> 2) & 3;
+    const int padding = (bytes[2] >> 1) & 1;
+    const bool mono = ((bytes[3] >> 6) & 3) == 3;
+
+    // free format streams have no frame length in their headers, so can't be indexed this way
+    if (version == 1 || layer != 1 || bitrateIndex == 0 || bitrateIndex == 15 || sampleRateIndex == 3)
+    {
+        return false;
+    }
+
+    const bool mpeg1 = version == 3;
+    const int bitrate = (mpeg1 ? mpeg1Bitrates : mpeg2Bitrates)[bitrateIndex] * 1000;
+    header.sampleRate = mpeg1SampleRates[sampleRateIndex] >> (mpeg1 ? 0 : (version == 2 ? 1 : 2));
+    header.samplesPerFrame = mpeg1 ? 1152 : 576;
+    header.frameBytes = (mpeg1 ? 144 : 72) * bitrate / header.sampleRate + padding;
+    header.sideInfoBytes = (hasCrc ? 2 : 0) + (mpeg1 ? (mono ? 17 : 32) : (mono ? 9 : 17));
+    return true;
+}
+
+/** @returns: true if a frame holds a Xing, Info or VBRI header rather than audio */
+static bool isVbrHeaderFrame(juce::InputStream& input, juce::int64 offset, const FrameHeader& header)
+{
+    char tag[4];
+    input.setPosition(offset + 4 + header.sideInfoBytes);
+    if (input.read(tag, 4) == 4 && (juce::String(tag, 4) == "Xing" || juce::String(tag, 4) == "Info"))
+    {
+        return true;
+    }
+
+    input.setPosition(offset + 4 + 32);
+    return input.read(tag, 4) == 4 && juce::String(tag, 4) == "VBRI";
+}
+
+/** @returns: the size of an ID3v2 tag at the start of the file, or 0 if there isn't one */
+static juce::int64 getId3TagSize(juce::InputStream& input)
+{
+    juce::uint8 tag[10];
+    input.setPosition(0);
+    if (input.read(tag, 10) != 10 || tag[0] != 'I' || tag[1] != 'D' || tag[2] != '3')
+    {
+        return 0;
+    }
+
+    // synchsafe: seven bits per byte, then the footer if the flags say there is one
+    const juce::int64 size = ((juce::int64)(tag[6] & 0x7f) << 21) | ((tag[7] & 0x7f) << 14) | ((tag[8] & 0x7f) << 7) | (tag[9] & 0x7f);
+    return 10 + size + ((tag[5] & 0x10) != 0 ? 10 : 0);
+}
+
+/**
+ * Looks for the first frame: a header followed by another with the same sample rate,
+ * which a stray sync pattern in a tag or junk won't be.
+ *
+ * @returns: the offset of the first frame, or -1 if there isn't one near the start
+ */
+static juce::int64 findFirstFrame(juce::InputStream& input, juce::int64 start)
+{
+    juce::MemoryBlock block;
+    input.setPosition(start);
+    input.readIntoMemoryBlock(block, maxSyncSearchBytes + 4);
+    const auto* bytes = static_cast<const juce::uint8*>(block.getData());
+    const int numBytes = (int)block.getSize();
+
+    for (int i = 0; i + 4 <= numBytes; ++i)
+    {
+        FrameHeader header, next;
+        if (parseFrameHeader(bytes + i, header))
+        {
+            const int nextOffset = i + header.frameBytes;
+            if (nextOffset + 4 > numBytes)
+            {
+                // a single frame at the end of the search: take it if it's the whole file
+                return input.getTotalLength() == start + nextOffset ? start + i : -1;
+            }
+            if (parseFrameHeader(bytes + nextOffset, next) && next.sampleRate == header.sampleRate)
+            {
+                return start + i;
+            }
+        }
+    }
+    return -1;
+}
+
+
+std::shared_ptr<const Mp3SeekIndex> Mp3SeekIndex::loadOrBuild(const juce::File& track)
+{
+    const auto indexFile = getIndexFileFor(track);
+    if (auto saved = load(indexFile, track))
+    {
+        return saved;
+    }
+
+    std::unique_ptr<juce::FileInputStream> input(track.createInputStream());
+    if (input == nullptr)
+    {
+        return nullptr;
+    }
+
+    // the headers are tiny and spread through the file, so read it in big chunks
+    juce::BufferedInputStream buffered(*input, 1 << 16);
+    auto index = build(buffered);
+    if (index != nullptr && !index->save(indexFile, track))
+    {
+        DBG("Can't save the seek index for " << track.getFullPathName());
+    }
+    return index;
+}
+
+std::unique_ptr<Mp3SeekIndex> Mp3SeekIndex::build(juce::InputStream& input)
+{
+    const juce::int64 totalLength = input.getTotalLength();
+    juce::int64 offset = findFirstFrame(input, getId3TagSize(input));
+    if (offset < 0)
+    {
+        return nullptr;
+    }
+
+    std::unique_ptr<Mp3SeekIndex> index(new Mp3SeekIndex());
+    bool isFirstFrame = true;
+
+    // frame to frame by the lengths in their headers, until the audio stops: the end of the
+    // file, an ID3v1 tag, or anything that isn't a frame of the same stream
+    for (;;)
+    {
+        juce::uint8 bytes[4];
+        input.setPosition(offset);
+        FrameHeader header;
+        if (input.read(bytes, 4) != 4 || !parseFrameHeader(bytes, header)
+            || (index->sampleRate != 0 && header.sampleRate != index->sampleRate)
+            || offset + header.frameBytes > totalLength)
+        {
+            break;
+        }
+
+        // a VBR header takes the place of the first frame, and doesn't decode to anything
+        if (!(isFirstFrame && isVbrHeaderFrame(input, offset, header)))
+        {
+            index->sampleRate = header.sampleRate;
+            index->samplesPerFrame = header.samplesPerFrame;
+            index->frameOffsets.push_back(offset);
+        }
+        isFirstFrame = false;
+        offset += header.frameBytes;
+    }
+
+    if (index->frameOffsets.empty())
+    {
+        return nullptr;
+    }
+    index->frameOffsets.push_back(offset);
+    return index;
+}
+
+std::unique_ptr<Mp3SeekIndex> Mp3SeekIndex::load(const juce::File& indexFile, const juce::File& track)
+{
+    // the whole index in one read
+    juce::MemoryBlock data;
+    if (!indexFile.existsAsFile() || !indexFile.loadFileAsData(data))
+    {
+        return nullptr;
+    }
+
+    juce::MemoryInputStream input(data, false);
+    if (input.readInt() != indexMagic || input.readInt() != indexVersion
+        || input.readInt64() != track.getSize()
+        || input.readInt64() != track.getLastModificationTime().toMilliseconds())
+    {
+        return nullptr;
+    }
+
+    std::unique_ptr<Mp3SeekIndex> index(new Mp3SeekIndex());
+    index->sampleRate = input.readInt();
+    index->samplesPerFrame = input.readInt();
+    const int numOffsets = input.readInt();
+
+    if (index->sampleRate <= 0 || index->samplesPerFrame <= 0 || numOffsets < 2
+        || input.getNumBytesRemaining() != (juce::int64)numOffsets * 8)
+    {
+        return nullptr;
+    }
+
+    index->frameOffsets.resize((size_t)numOffsets);
+    for (auto& offset : index->frameOffsets)
+    {
+        offset = input.readInt64();
+    }
+    return index;
+}
+
+bool Mp3SeekIndex::save(const juce::File& indexFile, const juce::File& track) const
+{
+    if (!indexFile.getParentDirectory().createDirectory())
+    {
+        return false;
+    }
+
+    // written aside and moved into place, so a half written index is never read
+    juce::TemporaryFile temporary(indexFile);
+    {
+        juce::FileOutputStream output(temporary.getFile());
+        if (!output.openedOk())
+        {
+            return false;
+        }
+
+        output.writeInt(indexMagic);
+        output.writeInt(indexVersion);
+        output.writeInt64(track.getSize());
+        output.writeInt64(track.getLastModificationTime().toMilliseconds());
+        output.writeInt(sampleRate);
+        output.writeInt(samplesPerFrame);
+        output.writeInt((int)frameOffsets.size());
+        for (auto offset : frameOffsets)
+        {
+            output.writeInt64(offset);
+        }
+        output.flush();
+        if (output.getStatus().failed())
+        {
+            return false;
+        }
+    }
+    return temporary.overwriteTargetFileWithTemporary();
+}
+
+juce::File Mp3SeekIndex::getIndexFileFor(const juce::File& track)
+{
+    const auto name = juce::String::toHexString(track.getFullPathName().hashCode64());
+    return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+        .getChildFile("DJApp").getChildFile("SeekIndexes").getChildFile(name + ".seek");
+}
+
+int Mp3SeekIndex::getNumFrames() const
+{
+    return (int)frameOffsets.size() - 1;
+}
+
+juce::int64 Mp3SeekIndex::getFrameOffset(int frame) const
+{
+    return frameOffsets[(size_t)juce::jlimit(0, getNumFrames(), frame)];
+}
+
+int Mp3SeekIndex::getFrameForSample(juce::int64 sample) const
+{
+    return (int)juce::jlimit((juce::int64)0, (juce::int64)getNumFrames() - 1, sample / samplesPerFrame);
+}
+
+int Mp3SeekIndex::getWarmUpFrame(int frame) const
+{
+    int first = frame;
+    juce::int64 reservoirBytes = 0;
+    while (first > 0 && reservoirBytes < maxBitReservoirBytes)
+    {
+        --first;
+        reservoirBytes += getFrameOffset(first + 1) - getFrameOffset(first) - frameOverheadBytes;
+    }
+    return first;
+}
+
+int Mp3SeekIndex::getSamplesPerFrame() const
+{
+    return samplesPerFrame;
+}
+
+int Mp3SeekIndex::getSampleRate() const
+{
+    return sampleRate;
+}
+
+juce::int64 Mp3SeekIndex::getLengthInSamples() const
+{
+    return (juce::int64)getNumFrames() * samplesPerFrame;
+}
+
+
+IndexedMp3Reader* IndexedMp3Reader::create(const juce::File& file, juce::AudioFormatManager& formatManager, bool buildIndex)
+{
+    auto* format = formatManager.findFormatForFileExtension(file.getFileExtension());
+    if (format == nullptr || !file.hasFileExtension("mp3"))
+    {
+        return nullptr;
+    }
+
+    std::shared_ptr<const Mp3SeekIndex> index;
+    if (buildIndex)
+    {
+        index = Mp3SeekIndex::loadOrBuild(file);
+    }
+    else
+    {
+        index = Mp3SeekIndex::load(Mp3SeekIndex::getIndexFileFor(file), file);
+    }
+    if (index == nullptr)
+    {
+        return nullptr;
+    }
+
+    std::unique_ptr<IndexedMp3Reader> reader(new IndexedMp3Reader(file, index, *format));
+    return reader->openDecoderAt(0) ? reader.release() : nullptr;
+}
+
+IndexedMp3Reader::IndexedMp3Reader(const juce::File& _file, std::shared_ptr<const Mp3SeekIndex> _index, juce::AudioFormat& _format)
+    : juce::AudioFormatReader(nullptr, "MP3 file"),
+      file(_file),
+      index(_index),
+      format(_format)
+{
+}
+
+bool IndexedMp3Reader::readSamples(int* const* destChannels, int numDestChannels, int startOffsetInDestBuffer,
+    juce::int64 startSampleInFile, int numSamples)
+{
+    if (startSampleInFile != nextSample && !openDecoderAt(startSampleInFile))
+    {
+        for (int channel = 0; channel < numDestChannels; ++channel)
+        {
+            if (destChannels[channel] != nullptr)
+            {
+                juce::zeromem(destChannels[channel] + startOffsetInDestBuffer, sizeof(int) * (size_t)numSamples);
+            }
+        }
+        nextSample = -1;
+        return false;
+    }
+
+    nextSample = startSampleInFile + numSamples;
+    return decoder->readSamples(destChannels, numDestChannels, startOffsetInDestBuffer,
+        startSampleInFile - decoderStart, numSamples);
+}
+
+bool IndexedMp3Reader::openDecoderAt(juce::int64 sample)
+{
+    const int first = index->getWarmUpFrame(index->getFrameForSample(sample));
+
+    std::unique_ptr<juce::FileInputStream> input(file.createInputStream());
+    if (input == nullptr)
+    {
+        decoder.reset();
+        return false;
+    }
+
+    // the decoder sees a stream starting at the frame
+    decoder.reset(format.createReaderFor(new juce::SubregionStream(input.release(), index->getFrameOffset(first), -1, true), true));
+    if (decoder == nullptr)
+    {
+        return false;
+    }
+    decoderStart = (juce::int64)first * index->getSamplesPerFrame();
+
+    // the warm-up frames are decoded from the start of that stream and thrown away. Asked
+    // for a later sample straight off, JUCE's decoder would seek to a few frames before it
+    // and reset itself there, losing the reservoir the warm-up frames were there to fill
+    const juce::int64 warmUpSamples = juce::jmin(sample, index->getLengthInSamples()) - decoderStart;
+    warmUpBuffer.setSize((int)decoder->numChannels, index->getSamplesPerFrame(), false, false, true);
+    for (juce::int64 position = 0; position < warmUpSamples; position += warmUpBuffer.getNumSamples())
+    {
+        decoder->read(&warmUpBuffer, 0, (int)juce::jmin((juce::int64)warmUpBuffer.getNumSamples(), warmUpSamples - position),
+            position, true, true);
+    }
+    nextSample = sample;
+    sampleRate = decoder->sampleRate;
+    numChannels = decoder->numChannels;
+    bitsPerSample = decoder->bitsPerSample;
+    usesFloatingPointData = decoder->usesFloatingPointData;
+    lengthInSamples = index->getLengthInSamples();
+    return true;
+}
@@ -0,0 +1,138 @@
+/*
+  ==============================================================================
+
+    Mp3SeekIndex.h
+    Created: 19 Oct 2026 10:47:52pm
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <memory>
+#include <vector>
+
+
+/**
+ * Where every frame of an MP3 file starts, so a seek can go straight to the frame holding
+ * a sample instead of reading its way there from the start of the file.
+ *
+ * Built from the frame headers alone, without decoding, and saved in the app's data
+ * folder so the scan only happens the first time a track is loaded.
+ */
+class Mp3SeekIndex
+{
+public:
+    /**
+     * Reads the index saved for a track, or scans the track and saves it.
+     *
+     * @param track: an MP3 file
+     * @returns: the index, or nullptr if the file isn't an MP3 that can be indexed
+     */
+    static std::shared_ptr<const Mp3SeekIndex> loadOrBuild(const juce::File& track);
+
+    /**
+     * Scans an MP3 stream's frame headers.
+     *
+     * @param input: the whole file, from its start
+     * @returns: the index, or nullptr if no run of MPEG layer III frames was found
+     */
+    static std::unique_ptr<Mp3SeekIndex> build(juce::InputStream& input);
+
+    /**
+     * Reads a saved index.
+     *
+     * @param indexFile: where it was saved
+     * @param track: the file it's for; an index saved before the file changed is ignored
+     * @returns: the index, or nullptr if there isn't a valid one
+     */
+    static std::unique_ptr<Mp3SeekIndex> load(const juce::File& indexFile, const juce::File& track);
+
+    /**
+     * Saves the index.
+     *
+     * @param indexFile: where to save it
+     * @param track: the file it's for
+     * @returns: false if it couldn't be written
+     */
+    bool save(const juce::File& indexFile, const juce::File& track) const;
+
+    /** @returns: where a track's index is kept */
+    static juce::File getIndexFileFor(const juce::File& track);
+
+    /** @returns: how many audio frames the file has */
+    int getNumFrames() const;
+
+    /** @returns: the byte position of a frame's header in the file */
+    juce::int64 getFrameOffset(int frame) const;
+
+    /** @returns: the frame holding a sample */
+    int getFrameForSample(juce::int64 sample) const;
+
+    /**
+     * @returns: the frame to start decoding from so a frame comes out whole. Layer III
+     *           frames can start their data in the frames before them, up to 511 bytes
+     *           back, so that's how far decoding has to start ahead.
+     */
+    int getWarmUpFrame(int frame) const;
+
+    /** @returns: samples per channel in each frame */
+    int getSamplesPerFrame() const;
+
+    /** @returns: the file's sample rate */
+    int getSampleRate() const;
+
+    /** @returns: exact length of the file in samples */
+    juce::int64 getLengthInSamples() const;
+
+private:
+    int sampleRate = 0;
+    int samplesPerFrame = 0;
+    std::vector<juce::int64> frameOffsets;   // the offset of the frame after the last is the end of the audio
+
+    static constexpr int maxBitReservoirBytes = 511;
+};
+
+
+/**
+ * Reads an MP3 file through its seek index. A read that doesn't carry on from the last
+ * one opens a decoder at the wanted frame, a frame or two early to fill the decoder's bit
+ * reservoir, so any jump costs one open and the decoding of those frames. The decoder
+ * always reads on from where it was, the warm-up frames decoded and dropped first.
+ */
+class IndexedMp3Reader : public juce::AudioFormatReader
+{
+public:
+    /**
+     * Opens an MP3 file through its seek index.
+     *
+     * @param file: the track
+     * @param formatManager: to find the MP3 decoder with
+     * @param buildIndex: build the index if the track hasn't got one yet, which reads the
+     *                    whole file; false to only use an index that's been saved
+     * @returns: the reader, or nullptr if the file isn't an MP3 that can be indexed, or
+     *           has no index yet and buildIndex is false
+     */
+    static IndexedMp3Reader* create(const juce::File& file, juce::AudioFormatManager& formatManager, bool buildIndex = true);
+
+    bool readSamples(int* const* destChannels, int numDestChannels, int startOffsetInDestBuffer,
+        juce::int64 startSampleInFile, int numSamples) override;
+
+private:
+    IndexedMp3Reader(const juce::File& _file, std::shared_ptr<const Mp3SeekIndex> _index, juce::AudioFormat& _format);
+
+    juce::File file;
+    std::shared_ptr<const Mp3SeekIndex> index;
+    juce::AudioFormat& format;
+
+    std::unique_ptr<juce::AudioFormatReader> decoder;
+    juce::int64 decoderStart = 0;  // the sample the decoder's first frame is at in the file
+    juce::int64 nextSample = -1;   // where the last read ended, -1 if there's nothing to carry on from
+    juce::AudioBuffer<float> warmUpBuffer;  // the warm-up frames are decoded into this and dropped
+
+    /** Opens a decoder to read from a sample, @returns: false if the file couldn't be read */
+    bool openDecoderAt(juce::int64 sample);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(IndexedMp3Reader)
+};
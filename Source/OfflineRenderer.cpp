@@ -0,0 +1,227 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.cpp
+    Created: 19 Oct 2026 2:31:48pm
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#include "OfflineRenderer.h"
+#include "DJAudioPlayer.h"
+#include "DeckRenderPool.h"
+
+// large blocks keep the per-block overhead down; events still land on their exact sample
+static const int offlineBlockSize = 4096;
+
+
+/** Replays one recorded action onto a deck */
+static void applyEvent(const AutomationTimeline::Event& event, DJAudioPlayer& deck)
+{
+    switch (event.type)
+    {
+        case AutomationTimeline::loadEvent:
+        {
+            // the deck only opens an MP3 through a seek index that's already built; this isn't
+            // the message thread, so build it here and seek exactly from the first load
+            const juce::File track{ event.file };
+            if (track.hasFileExtension("mp3"))
+            {
+                Mp3SeekIndex::loadOrBuild(track);
+            }
+            deck.loadURL(juce::URL{ track });
+            break;
+        }
+        case AutomationTimeline::startEvent:
+            deck.start();
+            break;
+        case AutomationTimeline::stopEvent:
+            deck.stop();
+            break;
+        case AutomationTimeline::gainEvent:
+            deck.setGain(event.value);
+            break;
+        case AutomationTimeline::speedEvent:
+            deck.setSpeed(event.value);
+            break;
+        case AutomationTimeline::positionEvent:
+            deck.setPosition(event.value);
+            break;
+        case AutomationTimeline::wetEvent:
+            deck.setWetLevel((float)event.value);
+            break;
+        case AutomationTimeline::freezeEvent:
+            deck.setFreeze((float)event.value);
+            break;
+        case AutomationTimeline::effectEnabledEvent:
+            if (juce::isPositiveAndBelow(event.effect, (int)EffectsRack::numEffectTypes))
+            {
+                deck.setEffectEnabled((EffectsRack::EffectType)event.effect, event.value > 0.5);
+            }
+            break;
+        case AutomationTimeline::effectAmountEvent:
+            if (juce::isPositiveAndBelow(event.effect, (int)EffectsRack::numEffectTypes))
+            {
+                deck.setEffectAmount((EffectsRack::EffectType)event.effect, (float)event.value);
+            }
+            break;
+        case AutomationTimeline::reverseEvent:
+            deck.setReverse(event.value > 0.5);
+            break;
+        case AutomationTimeline::effectSlotEvent:
+            if (juce::isPositiveAndBelow(event.effect, (int)EffectsRack::numEffectTypes))
+            {
+                deck.moveEffect((EffectsRack::EffectType)event.effect, juce::roundToInt(event.value));
+            }
+            break;
+        case AutomationTimeline::scratchEvent:
+            if (event.value > 0.5)
+            {
+                deck.beginScratch();
+            }
+            else
+            {
+                deck.endScratch();
+            }
+            break;
+        case AutomationTimeline::scratchMoveEvent:
+            deck.scratchMove(event.value);
+            break;
+        default:
+            break;
+    }
+}
+
+
+OfflineRenderer::OfflineRenderer(const AutomationTimeline& _timeline) : timeline(_timeline)
+{
+}
+
+void OfflineRenderer::setTailLength(double seconds)
+{
+    tailSeconds = juce::jmax(0.0, seconds);
+}
+
+juce::Result OfflineRenderer::render(const juce::File& outputFile,
+    double sampleRate,
+    std::function<bool(double)> progressCallback)
+{
+    const auto& events = timeline.getEvents();
+    if (events.isEmpty())
+    {
+        return juce::Result::fail("Nothing was recorded");
+    }
+
+    // pick the writer from the file extension
+    std::unique_ptr<juce::AudioFormat> format;
+    if (outputFile.hasFileExtension("flac"))
+    {
+        format.reset(new juce::FlacAudioFormat());
+    }
+    else if (outputFile.hasFileExtension("wav"))
+    {
+        format.reset(new juce::WavAudioFormat());
+    }
+    else
+    {
+        return juce::Result::fail("Output must be a .wav or .flac file");
+    }
+
+    outputFile.deleteFile();
+    std::unique_ptr<juce::OutputStream> stream(outputFile.createOutputStream());
+    if (stream == nullptr)
+    {
+        return juce::Result::fail("Can't write to " + outputFile.getFullPathName());
+    }
+
+    std::unique_ptr<juce::AudioFormatWriter> writer(format->createWriterFor(stream.get(),
+        sampleRate, 2, 24, {}, 0));
+    if (writer == nullptr)
+    {
+        return juce::Result::fail("Can't write " + format->getFormatName() + " at this sample rate");
+    }
+    stream.release(); // the writer owns it now
+
+    // a fresh set of decks, as many as the timeline uses
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    int numDecks = 2;
+    for (auto& event : events)
+    {
+        numDecks = juce::jmax(numDecks, event.deck + 1);
+    }
+
+    juce::OwnedArray<DJAudioPlayer> decks;
+    DeckRenderPool renderer;
+    for (int i = 0; i < numDecks; ++i)
+    {
+        renderer.addDeck(decks.add(new DJAudioPlayer(formatManager)));
+    }
+    renderer.prepareToPlay(offlineBlockSize, sampleRate);
+
+    // every deck waits for its job however long it takes: the render can't depend on
+    // timing, and no job is still running when the next event changes its deck
+    renderer.setJoinDeadline(false);
+    renderer.setParallelRendering(true);
+
+    juce::AudioBuffer<float> block(2, offlineBlockSize);
+    const juce::int64 totalSamples = (juce::int64)((timeline.getLengthInSeconds() + tailSeconds) * sampleRate);
+    const juce::int64 progressInterval = (juce::int64)sampleRate;
+    juce::int64 position = 0;
+    juce::int64 nextProgress = 0;
+    int nextEvent = 0;
+    bool cancelled = false;
+
+    while (position < totalSamples)
+    {
+        // apply everything that is due, then render up to the next event at most
+        while (nextEvent < events.size()
+            && (juce::int64)(events.getReference(nextEvent).timeInSecs * sampleRate) <= position)
+        {
+            const auto& event = events.getReference(nextEvent++);
+            if (event.type == AutomationTimeline::crossfaderEvent)
+            {
+                renderer.setCrossfader((float)event.value, event.rampSecs);
+            }
+            else if (auto* deck = decks[event.deck])
+            {
+                applyEvent(event, *deck);
+            }
+        }
+
+        juce::int64 blockEnd = juce::jmin(position + offlineBlockSize, totalSamples);
+        if (nextEvent < events.size())
+        {
+            blockEnd = juce::jmin(blockEnd, (juce::int64)(events.getReference(nextEvent).timeInSecs * sampleRate));
+        }
+        const int numSamples = (int)(blockEnd - position);
+
+        juce::AudioSourceChannelInfo info(&block, 0, numSamples);
+        renderer.renderAndMix(info);
+        writer->writeFromAudioSampleBuffer(block, 0, numSamples);
+        position = blockEnd;
+
+        if (progressCallback != nullptr && position >= nextProgress)
+        {
+            nextProgress = position + progressInterval;
+            if (!progressCallback((double)position / (double)totalSamples))
+            {
+                cancelled = true;
+                break;
+            }
+        }
+    }
+
+    renderer.setParallelRendering(false);
+    renderer.releaseResources();
+    writer.reset();
+
+    if (cancelled)
+    {
+        outputFile.deleteFile();
+        return juce::Result::fail("Render cancelled");
+    }
+    return juce::Result::ok();
+}
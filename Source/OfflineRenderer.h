@@ -0,0 +1,54 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.h
+    Created: 19 Oct 2026 2:31:48pm
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <functional>
+#include "AutomationTimeline.h"
+
+
+/**
+ * Renders a recorded session to an audio file without an audio device, as fast as the
+ * machine allows. The timeline is replayed onto a fresh pair of decks and crossfader,
+ * with each deck's decoding and effects running on its own core through a DeckRenderPool.
+ */
+class OfflineRenderer
+{
+public:
+    /**
+     * Constructor
+     *
+     * @param _timeline: the session to render
+     */
+    OfflineRenderer(const AutomationTimeline& _timeline);
+
+    /**
+     * Sets how long to keep rendering after the last event.
+     *
+     * @param seconds: length of the tail; defaults to 30 seconds
+     */
+    void setTailLength(double seconds);
+
+    /**
+     * Renders the session. Blocks until done.
+     *
+     * @param outputFile: a .wav or .flac file, overwritten if it exists
+     * @param sampleRate: the sample rate to render at
+     * @param progressCallback: called regularly with the proportion done; return false to cancel
+     * @returns: ok, or the reason rendering failed
+     */
+    juce::Result render(const juce::File& outputFile,
+        double sampleRate,
+        std::function<bool(double)> progressCallback = nullptr);
+
+private:
+    const AutomationTimeline& timeline;
+    double tailSeconds = 30.0;
+};
@@ -0,0 +1,217 @@
+/*
+  ==============================================================================
+
+    PerformanceOverlay.cpp
+    Created: 19 Oct 2026 4:31:02pm
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#include "PerformanceOverlay.h"
+#include "RealtimeSafety.h"
+
+// refresh rate of the figures; fast enough to catch a spike, slow enough to read
+static const int refreshIntervalMs = 250;
+
+
+PerformanceOverlay::PerformanceOverlay(AudioCallbackMonitor& _monitor,
+    const juce::Array<DJAudioPlayer*>& _decks,
+    juce::AudioDeviceManager& _deviceManager)
+    : monitor(_monitor),
+      decks(_decks),
+      deviceManager(_deviceManager)
+{
+    stageLoads.insertMultiple(0, 0.0, decks.size() * DJAudioPlayer::numStages);
+    lastStageSeconds.insertMultiple(0, 0.0, decks.size() * DJAudioPlayer::numStages);
+
+    addAndMakeVisible(resetButton);
+    resetButton.setColour(juce::TextButton::ColourIds::buttonColourId, juce::Colours::grey);
+    resetButton.addListener(this);
+
+    addAndMakeVisible(saveReportButton);
+    saveReportButton.setColour(juce::TextButton::ColourIds::buttonColourId, juce::Colours::grey);
+    saveReportButton.addListener(this);
+
+    // the overlay only passes clicks through to its buttons
+    setInterceptsMouseClicks(false, true);
+}
+
+PerformanceOverlay::~PerformanceOverlay()
+{
+    stopTimer();
+}
+
+void PerformanceOverlay::paint(juce::Graphics& g)
+{
+    g.fillAll(juce::Colours::black.withAlpha(0.75f));
+    g.setColour(juce::Colours::white);
+    g.setFont(14.0f);
+
+    const int lineHeight = 18;
+    auto area = getLocalBounds().reduced(10);
+    auto nextLine = [&]() { return area.removeFromTop(lineHeight); };
+
+    g.drawText("Audio callback  (buffer " + juce::String(snapshot.bufferPeriodSecs * 1000.0, 2) + " ms)",
+        nextLine(), juce::Justification::centredLeft);
+    g.drawText("load  last " + juce::String(juce::roundToInt(snapshot.lastLoad * 100.0)) + "%"
+        + "   mean " + juce::String(juce::roundToInt(snapshot.meanLoad * 100.0)) + "%"
+        + "   peak " + juce::String(juce::roundToInt(snapshot.peakLoad * 100.0)) + "%"
+        + " (" + juce::String(snapshot.peakCallbackSecs * 1000.0, 2) + " ms)",
+        nextLine(), juce::Justification::centredLeft);
+
+    // anything that may have been heard as a click is highlighted
+    g.setColour(snapshot.overruns + snapshot.lateCallbacks > 0 || deviceXRuns > 0
+        ? juce::Colours::lightcoral : juce::Colours::white);
+    g.drawText("overruns " + juce::String(snapshot.overruns)
+        + "   late callbacks " + juce::String(snapshot.lateCallbacks)
+        + "   device xruns " + (deviceXRuns < 0 ? juce::String("n/a") : juce::String(deviceXRuns))
+        + "   callbacks " + juce::String(snapshot.callbacks),
+        nextLine(), juce::Justification::centredLeft);
+
+    g.setColour(juce::Colours::white);
+    area.removeFromTop(lineHeight / 2);
+    for (int deck = 0; deck < decks.size(); ++deck)
+    {
+        const double source = stageLoads[deck * DJAudioPlayer::numStages + DJAudioPlayer::sourceStage];
+        const double effects = stageLoads[deck * DJAudioPlayer::numStages + DJAudioPlayer::effectsStage];
+        g.drawText("deck " + juce::String(deck + 1)
+            + "   source " + juce::String(source * 100.0, 1) + "%"
+            + "   effects " + juce::String(effects * 100.0, 1) + "%"
+            + "   decode underruns " + juce::String(decks[deck]->getNumDecodeUnderruns()),
+            nextLine(), juce::Justification::centredLeft);
+    }
+
+    if (RealtimeSafety::isCheckerAvailable())
+    {
+        g.setColour(realtimeViolations > 0 ? juce::Colours::lightcoral : juce::Colours::white);
+        g.drawText("real-time violations " + juce::String(realtimeViolations)
+            + (realtimeViolations > 0 ? "  (details in the saved report)" : ""),
+            nextLine(), juce::Justification::centredLeft);
+        g.setColour(juce::Colours::white);
+    }
+
+    // load histogram, one bar per bucket on a log scale so rare slow callbacks still show
+    area.removeFromTop(lineHeight / 2);
+    auto histogramArea = area.withTrimmedBottom(32).toFloat();
+    if (histogramArea.getHeight() < 20)
+    {
+        return;
+    }
+
+    juce::int64 largest = 1;
+    for (auto count : snapshot.histogram)
+    {
+        largest = juce::jmax(largest, count);
+    }
+
+    const float barWidth = histogramArea.getWidth() / (float)AudioCallbackMonitor::numHistogramBuckets;
+    const double deadlineBucket = 1.0 / AudioCallbackMonitor::histogramBucketWidth;
+    for (int i = 0; i < AudioCallbackMonitor::numHistogramBuckets; ++i)
+    {
+        if (snapshot.histogram[i] == 0)
+        {
+            continue;
+        }
+        const float height = histogramArea.getHeight()
+            * (float)(std::log1p((double)snapshot.histogram[i]) / std::log1p((double)largest));
+        g.setColour(i >= deadlineBucket ? juce::Colours::lightcoral : juce::Colours::lightgreen);
+        g.fillRect(histogramArea.getX() + i * barWidth, histogramArea.getBottom() - height,
+            juce::jmax(1.0f, barWidth - 1.0f), height);
+    }
+
+    // the deadline
+    const float deadlineX = histogramArea.getX() + (float)deadlineBucket * barWidth;
+    g.setColour(juce::Colours::white);
+    g.drawVerticalLine(juce::roundToInt(deadlineX), histogramArea.getY(), histogramArea.getBottom());
+    g.setFont(12.0f);
+    g.drawText("100%", juce::Rectangle<float>(deadlineX + 2, histogramArea.getY(), 40, 14),
+        juce::Justification::centredLeft);
+}
+
+void PerformanceOverlay::resized()
+{
+    auto buttons = getLocalBounds().reduced(10).removeFromBottom(24);
+    resetButton.setBounds(buttons.removeFromLeft(80));
+    buttons.removeFromLeft(6);
+    saveReportButton.setBounds(buttons.removeFromLeft(110));
+}
+
+void PerformanceOverlay::buttonClicked(juce::Button* button)
+{
+    if (button == &resetButton)
+    {
+        monitor.reset();
+    }
+    else if (button == &saveReportButton)
+    {
+        saveReport();
+    }
+}
+
+void PerformanceOverlay::timerCallback()
+{
+    snapshot = monitor.getSnapshot();
+
+    auto* device = deviceManager.getCurrentAudioDevice();
+    deviceXRuns = device != nullptr ? device->getXRunCount() : -1;
+    realtimeViolations = RealtimeSafety::getTotalViolations();
+
+    // turn the decks' running totals into a share of the time since the last refresh
+    const auto now = juce::Time::getHighResolutionTicks();
+    const double interval = lastRefreshTicks != 0
+        ? juce::Time::highResolutionTicksToSeconds(now - lastRefreshTicks) : 0.0;
+    lastRefreshTicks = now;
+
+    for (int deck = 0; deck < decks.size(); ++deck)
+    {
+        for (int stage = 0; stage < DJAudioPlayer::numStages; ++stage)
+        {
+            const int index = deck * DJAudioPlayer::numStages + stage;
+            const double seconds = decks[deck]->getStageStatistics((DJAudioPlayer::Stage)stage).secondsProcessing;
+            stageLoads.set(index, interval > 0 ? (seconds - lastStageSeconds[index]) / interval : 0.0);
+            lastStageSeconds.set(index, seconds);
+        }
+    }
+    repaint();
+}
+
+void PerformanceOverlay::visibilityChanged()
+{
+    if (isVisible())
+    {
+        lastRefreshTicks = 0;
+        timerCallback();
+        startTimer(refreshIntervalMs);
+    }
+    else
+    {
+        stopTimer();
+    }
+}
+
+void PerformanceOverlay::saveReport()
+{
+    auto folder = juce::File::getSpecialLocation(juce::File::userDocumentsDirectory).getChildFile("DJApp Performance");
+    folder.createDirectory();
+    auto file = folder.getChildFile("performance " + juce::Time::getCurrentTime().formatted("%Y-%m-%d %H-%M-%S") + ".json");
+
+    if (monitor.writeReport(file, decks, deviceManager.getCurrentAudioDevice()))
+    {
+        juce::AlertWindow::showMessageBox(juce::AlertWindow::AlertIconType::InfoIcon,
+            "Performance report:",
+            "Saved to " + file.getFullPathName(),
+            "OK",
+            nullptr
+        );
+    }
+    else
+    {
+        juce::AlertWindow::showMessageBox(juce::AlertWindow::AlertIconType::WarningIcon,
+            "Performance report:",
+            "Can't write to " + file.getFullPathName(),
+            "OK",
+            nullptr
+        );
+    }
+}
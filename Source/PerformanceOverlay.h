@@ -0,0 +1,96 @@
+/*
+  ==============================================================================
+
+    PerformanceOverlay.h
+    Created: 19 Oct 2026 4:31:02pm
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "AudioCallbackMonitor.h"
+#include "DJAudioPlayer.h"
+
+
+/**
+ * Translucent panel drawn over the decks showing how close the audio callback runs to
+ * its deadline: callback load, overruns and xruns, a load histogram and the time each
+ * deck spends in each stage of its chain. Everything is read from lock-free counters on
+ * a timer, so showing it never touches the audio thread.
+ */
+class PerformanceOverlay : public juce::Component,
+    public juce::Button::Listener,
+    public juce::Timer
+{
+public:
+    /**
+     * Constructor.
+
+        @param _monitor: the callback monitor to show
+        @param _decks: the decks whose stage timings to show
+        @param _deviceManager: used to read the device's own xrun count
+     */
+    PerformanceOverlay(AudioCallbackMonitor& _monitor,
+        const juce::Array<DJAudioPlayer*>& _decks,
+        juce::AudioDeviceManager& _deviceManager
+    );
+
+    /**
+     * Destructor.
+     */
+    ~PerformanceOverlay() override;
+
+    /**
+     * Draws the statistics and the load histogram.
+
+        @param juce::Graphics& g: the graphics context that must be used to do the drawing operations.
+     */
+    void paint(juce::Graphics& g) override;
+
+    /**
+     * Places the buttons along the bottom of the panel.
+     */
+    void resized() override;
+
+    /**
+     * Resets the counters or saves a report.
+     *
+     * @param button: the button that was clicked
+     */
+    void buttonClicked(juce::Button* button) override;
+
+    /**
+     * Takes a new snapshot of the counters and repaints.
+     */
+    void timerCallback() override;
+
+    /** Starts or stops refreshing when the overlay is shown or hidden. */
+    void visibilityChanged() override;
+
+private:
+    AudioCallbackMonitor& monitor;
+    juce::Array<DJAudioPlayer*> decks;
+    juce::AudioDeviceManager& deviceManager;
+
+    juce::TextButton resetButton{ "RESET" };
+    juce::TextButton saveReportButton{ "SAVE REPORT" };
+
+    AudioCallbackMonitor::Snapshot snapshot;
+    int deviceXRuns = -1;
+
+    // stage time per refresh, as a share of one core
+    juce::Array<double> stageLoads;
+    juce::Array<double> lastStageSeconds;
+    juce::int64 lastRefreshTicks = 0;
+
+    // audio thread safety, only known in builds with the checker
+    juce::int64 realtimeViolations = 0;
+
+    /** Writes a report to the user's documents folder and says where it went */
+    void saveReport();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PerformanceOverlay)
+};
@@ -13,12 +13,17 @@
 #include <JuceHeader.h>
 #include "PlaylistComponent.h"
 
+// every duration probe's scheduler group starts with this
+static const juce::String probeGroupPrefix{ "duration|" };
+
 
 PlaylistComponent::PlaylistComponent(DeckGUI* _deckGUI1,
                                      DeckGUI* _deckGUI2,
-                                     DJAudioPlayer* _metadataParser) : deckGUI1(_deckGUI1),
-                                                                       deckGUI2(_deckGUI2),
-                                                                       metadataParser(_metadataParser)
+                                     juce::AudioFormatManager& _formatManager,
+                                     AutoDJ* _autoDJ) : deckGUI1(_deckGUI1),
+                                                        deckGUI2(_deckGUI2),
+                                                        formatManager(_formatManager),
+                                                        autoDJ(_autoDJ)
 {
     // track title
     addAndMakeVisible(tableComponent);
@@ -56,16 +61,35 @@ PlaylistComponent::PlaylistComponent(DeckGUI* _deckGUI1,
     addAndMakeVisible(addSongToRightDeckButton);
     addSongToLeftDeckButton.addListener(this);
     addSongToRightDeckButton.addListener(this);
+
+    // Auto-DJ: queue songs and let it mix them; it loads them through the decks so they show there
+    addAndMakeVisible(queueSongButton);
+    addAndMakeVisible(autoDJButton);
+    queueSongButton.setTooltip("Add the selected songs to the Auto-DJ queue");
+    autoDJButton.setTooltip("Mix the queue automatically, or the playlist from the selected song");
+    autoDJButton.setColour(juce::TextButton::ColourIds::buttonOnColourId, juce::Colours::coral);
+    queueSongButton.addListener(this);
+    autoDJButton.addListener(this);
+    autoDJ->onLoad = [this](int deck, const juce::URL& track)
+    {
+        (deck == 0 ? deckGUI1 : deckGUI2)->loadFile(track);
+    };
+    autoDJ->onStateChanged = [this] { updateAutoDJStatus(); };
 }
 
 PlaylistComponent::~PlaylistComponent()
 {
     savePlaylist();
+
+    // the probes read through the format manager, so they mustn't outlive the playlist
+    scheduler->cancelAll(probeGroupPrefix, 5000);
 }
 
 void PlaylistComponent::paint(juce::Graphics& g)
 {
     importSongsButton.setColour(juce::TextButton::ColourIds::buttonColourId, juce::Colours::grey);
+    queueSongButton.setColour(juce::TextButton::ColourIds::buttonColourId, juce::Colours::grey);
+    autoDJButton.setColour(juce::TextButton::ColourIds::buttonColourId, juce::Colours::grey);
     addSongToLeftDeckButton.setColour(juce::TextButton::ColourIds::buttonColourId, juce::Colours::coral);
     addSongToRightDeckButton.setColour(juce::TextButton::ColourIds::buttonColourId, juce::Colours::coral);
 }
@@ -78,12 +102,14 @@ void PlaylistComponent::resized()
 
     searchBox.setBounds(0, 0, getWidth(), 2 * rowH);
 
-    playlist.setBounds(0, 2 * rowH, getWidth(), 13 * rowH);
+    playlist.setBounds(0, 2 * rowH, getWidth(), 11 * rowH);
     playlist.getHeader().setColumnWidth(1, 5 * getWidth() / 10);
     playlist.getHeader().setColumnWidth(2, 3 * getWidth() / 10);
     playlist.getHeader().setColumnWidth(3, 2 * getWidth() / 10);
 
-    importSongsButton.setBounds(0, 15 * rowH, getWidth(), 2 * rowH);
+    importSongsButton.setBounds(0, 13 * rowH, getWidth(), 2 * rowH);
+    queueSongButton.setBounds(0, 15 * rowH, getWidth() / 2, 2 * rowH);
+    autoDJButton.setBounds(getWidth() / 2, 15 * rowH, getWidth() / 2, 2 * rowH);
     decksLabel.setBounds(0, 17 * rowH, getWidth(), rowH);
     addSongToLeftDeckButton.setBounds(0, 18 * rowH, getWidth() / 2, 2 * rowH);
     addSongToRightDeckButton.setBounds(getWidth() / 2, 18 * rowH, getWidth() / 2, 2 * rowH);
@@ -91,7 +117,7 @@ void PlaylistComponent::resized()
 
 int PlaylistComponent::getNumRows()
 {
-    return songs.size();
+    return tracks.size();
 }
 
 void PlaylistComponent::paintRowBackground(juce::Graphics& g,
@@ -121,7 +147,7 @@ void PlaylistComponent::paintCell(juce::Graphics& g,
     {
         if (columnId == 1)
         {
-            g.drawText(songs[rowNumber].songName,
+            g.drawText(tracks.getName(rowNumber),
                 2,
                 0,
                 width - 4,
@@ -132,7 +158,13 @@ void PlaylistComponent::paintCell(juce::Graphics& g,
         }
         if (columnId == 2)
         {
-            g.drawText(songs[rowNumber].trackDuration,
+            // on screen and not read yet: read it before the rest of the library
+            const float seconds = tracks.getDuration(rowNumber);
+            if (seconds == TrackStore::unknownDuration && raisedProbes.insert(tracks.getId(rowNumber)).second)
+            {
+                scheduler->raisePriority(getProbeGroup(tracks.getFile(rowNumber)), TaskScheduler::playlistPriority);
+            }
+            g.drawText(TrackStore::formatDuration(seconds),
                 2,
                 0,
                 width - 4,
@@ -179,6 +211,14 @@ void PlaylistComponent::buttonClicked(juce::Button* button)
     {
         loadSongInDeck(deckGUI2);
     }
+    else if (button == &queueSongButton)
+    {
+        queueSelectedSongs();
+    }
+    else if (button == &autoDJButton)
+    {
+        toggleAutoDJ();
+    }
     else
     {
         int id = std::stoi(button->getComponentID().toStdString());
@@ -190,33 +230,24 @@ void PlaylistComponent::buttonClicked(juce::Button* button)
 
 void PlaylistComponent::savePlaylist()
 {
-    std::ofstream myPlaylist("playlist.csv");
-
-    for (Song& t : songs)
+    if (!tracks.savePlaylist(TrackStore::getPlaylistFile()))
     {
-        myPlaylist << t.file.getFullPathName() << "," << t.trackDuration << "\n";
+        DBG("Can't save the playlist");
     }
 }
 
 void PlaylistComponent::loadPlaylist()
 {
-    // create input stream from saved playlist
-    std::ifstream myPlaylist("playlist.csv");
-    std::string filePath;
-    std::string length;
+    tracks.loadPlaylist(TrackStore::getPlaylistFile());
 
-    // Read data, line by line
-    if (myPlaylist.is_open())
+    // saved while it was still being read
+    for (int row = 0; row < tracks.size(); ++row)
     {
-        while (getline(myPlaylist, filePath, ',')) {
-            juce::File file{ filePath };
-            Song newTrack{ file };
-            getline(myPlaylist, length);
-            newTrack.trackDuration = length;
-            songs.push_back(newTrack);
+        if (tracks.getDuration(row) == TrackStore::unknownDuration)
+        {
+            probeDuration(tracks.getId(row), tracks.getFile(row));
         }
     }
-    myPlaylist.close();
 }
 
 void PlaylistComponent::loadSongInDeck(DeckGUI* deckGUI)
@@ -224,7 +255,7 @@ void PlaylistComponent::loadSongInDeck(DeckGUI* deckGUI)
     int selectedRow{ playlist.getSelectedRow() };
     if (selectedRow != -1)
     {
-        deckGUI->loadFile(songs[selectedRow].URL);
+        deckGUI->loadFile(juce::URL{ tracks.getFile(selectedRow) });
     }
     else
     {
@@ -237,6 +268,47 @@ void PlaylistComponent::loadSongInDeck(DeckGUI* deckGUI)
     }
 }
 
+void PlaylistComponent::queueSelectedSongs()
+{
+    const auto selectedRows = playlist.getSelectedRows();
+    if (selectedRows.isEmpty())
+    {
+        juce::AlertWindow::showMessageBox(juce::AlertWindow::AlertIconType::InfoIcon,
+            "Auto-DJ Information:",
+            "Please select the tracks to queue",
+            "OK",
+            nullptr
+        );
+        return;
+    }
+
+    for (int i = 0; i < selectedRows.size(); ++i)
+    {
+        autoDJ->addToQueue(tracks.getFile(selectedRows[i]));
+    }
+}
+
+void PlaylistComponent::toggleAutoDJ()
+{
+    if (!autoDJ->isEnabled() && autoDJ->getQueue().isEmpty())
+    {
+        for (int row = juce::jmax(0, playlist.getSelectedRow()); row < tracks.size(); ++row)
+        {
+            autoDJ->addToQueue(tracks.getFile(row));
+        }
+    }
+    autoDJ->setEnabled(!autoDJ->isEnabled());
+}
+
+void PlaylistComponent::updateAutoDJStatus()
+{
+    const int queued = autoDJ->getQueue().size();
+    queueSongButton.setButtonText(queued > 0 ? "QUEUE (" + juce::String(queued) + ")" : "QUEUE");
+    autoDJButton.setToggleState(autoDJ->isEnabled(), juce::dontSendNotification);
+    decksLabel.setText(autoDJ->isEnabled() ? autoDJ->getStatusText() : "Add song to left or right deck:",
+        juce::dontSendNotification);
+}
+
 void PlaylistComponent::importSongToPlaylist()
 {
     juce::FileChooser chooser{ "Select files" };
@@ -248,10 +320,7 @@ void PlaylistComponent::importSongToPlaylist()
             // load songs if not already loaded
             if (!songIsInPlaylist(fileNameWithoutExtension)) 
             {
-                Song newTrack{ file };
-                juce::URL audioURL{ file };
-                newTrack.trackDuration = getLength(audioURL);
-                songs.push_back(newTrack);
+                probeDuration(tracks.add(file), file);
             }
             // If a song was already loaded, alert user and don't import
             else 
@@ -269,35 +338,57 @@ void PlaylistComponent::importSongToPlaylist()
 
 bool PlaylistComponent::songIsInPlaylist(juce::String fileNameWithoutExtension)
 {
-    return (std::find(songs.begin(), songs.end(), fileNameWithoutExtension) != songs.end());
+    return tracks.containsName(fileNameWithoutExtension);
 }
 
 void PlaylistComponent::deleteFromPlaylist(int id)
 {
-    songs.erase(songs.begin() + id);
+    scheduler->cancel(getProbeGroup(tracks.getFile(id)));
+    raisedProbes.erase(tracks.getId(id));
+    tracks.remove(id);
 }
 
-juce::String PlaylistComponent::getLength(juce::URL audioURL)
+void PlaylistComponent::probeDuration(TrackStore::TrackId id, const juce::File& file)
 {
-    metadataParser->loadURL(audioURL);
-    double seconds{ metadataParser->getLengthInSeconds() };
-    juce::String minutes{ secondsToMinutes(seconds) };
-    return minutes;
+    // a big import is library work; the rows on screen get raised as they're painted
+    juce::Component::SafePointer<PlaylistComponent> safeThis(this);
+    juce::AudioFormatManager& formats = formatManager;
+    scheduler->submit(TaskScheduler::libraryPriority, getProbeGroup(file),
+        [safeThis, id, file, &formats](const std::function<bool()>& shouldCancel)
+        {
+            std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(file));
+            const double seconds = reader != nullptr && reader->sampleRate > 0
+                ? reader->lengthInSamples / reader->sampleRate : 0.0;
+            if (shouldCancel())
+            {
+                return;
+            }
+            juce::MessageManager::callAsync([safeThis, id, seconds]
+            {
+                if (safeThis != nullptr)
+                {
+                    safeThis->durationProbed(id, seconds);
+                }
+            });
+        });
 }
 
-juce::String PlaylistComponent::secondsToMinutes(double seconds)
+void PlaylistComponent::durationProbed(TrackStore::TrackId id, double seconds)
 {
-    // find seconds and minutes and make into string
-    int secondsRounded{ int(std::round(seconds)) };
-    juce::String min{ std::to_string(secondsRounded / 60) };
-    juce::String sec{ std::to_string(secondsRounded % 60) };
+    raisedProbes.erase(id);
 
-    if (sec.length() < 2) // if seconds is 1 digit or less
+    // rows may have moved up while it was read
+    const int row = tracks.indexOf(id);
+    if (row != -1)
     {
-        // add '0' to seconds until seconds is length 2
-        sec = sec.paddedLeft('0', 2);
+        tracks.setDuration(row, (float)seconds);
+        playlist.repaintRow(row);
     }
-    return juce::String{ min + ":" + sec };
+}
+
+juce::String PlaylistComponent::getProbeGroup(const juce::File& file)
+{
+    return probeGroupPrefix + file.getFullPathName();
 }
 
 void PlaylistComponent::searchPlaylist(juce::String query)
@@ -316,14 +407,5 @@ void PlaylistComponent::searchPlaylist(juce::String query)
 int PlaylistComponent::whereInPlaylist(juce::String query)
 {
     // finds index where track title contains searchText
-    auto it = find_if(songs.begin(), songs.end(),
-        [&query](const Song& obj) {return obj.songName.contains(query); });
-    int i = -1;
-
-    if (it != songs.end())
-    {
-        i = std::distance(songs.begin(), it);
-    }
-
-    return i;
+    return tracks.findName(query);
 }
\ No newline at end of file
@@ -11,12 +11,15 @@
 #pragma once
 
 #include <JuceHeader.h>
-#include "Song.h" 
+#include "TrackStore.h"
+#include <set>
 #include <vector>
 #include <string>
 #include <fstream> 
 #include "DeckGUI.h" 
 #include "DJAudioPlayer.h" 
+#include "AutoDJ.h"
+#include "TaskScheduler.h"
 
 
 class PlaylistComponent : public juce::Component,
@@ -30,11 +33,13 @@ public:
 
      @param _deckGUI1: DeckGUI object (left)
      @param _deckGUI2: DeckGUI object (right)
-     @param _playerForParsingMetaData: An instance of the DJAudioPlayer to process metadata. A DJAudioPlayer object to use to parse metadata of files.
+     @param _formatManager: to read the songs' durations with, in the background
+     @param _autoDJ: plays the queue built here, loading its tracks through the decks
      */
     PlaylistComponent(DeckGUI* _deckGUI1,
         DeckGUI* _deckGUI2,
-        DJAudioPlayer* _playerForParsingMetaData
+        juce::AudioFormatManager& _formatManager,
+        AutoDJ* _autoDJ
     );
 
     /**
@@ -120,12 +125,18 @@ private:
     juce::TableListBox tableComponent;
 
     // the playlist
-    std::vector<Song> songs;
+    TrackStore tracks;
 
     // we have private access to these once they are instantiated from the constructor
     DeckGUI* deckGUI1;
     DeckGUI* deckGUI2;
-    DJAudioPlayer* metadataParser;
+    juce::AudioFormatManager& formatManager;
+    AutoDJ* autoDJ;
+
+    // reads durations off the message thread, sooner for the rows on screen
+    juce::SharedResourcePointer<TaskScheduler> scheduler;
+    // songs whose duration has been hurried along already, so painting doesn't do it again
+    std::set<TrackStore::TrackId> raisedProbes;
 
     // GUI components
     juce::TextButton importSongsButton{ "IMPORT SONGS" };
@@ -134,23 +145,32 @@ private:
     juce::Label decksLabel;
     juce::TextButton addSongToLeftDeckButton{ "ADD TO LEFT" };
     juce::TextButton addSongToRightDeckButton{ "ADD TO RIGHT" };
+    juce::TextButton queueSongButton{ "QUEUE" };
+    juce::TextButton autoDJButton{ "AUTO DJ" };
 
 
     /**
-     * Loads the audio file from URL, checks duration in seconds, converts it to minutes, and returns duration.
+     * Reads a song's duration in the background and shows it in the playlist when it's known.
+     * Until then, the song's duration is TrackStore::unknownDuration.
      *
-     * @param juce::URL audioURL: URL for an audio file
-     * @returns: duration in minutes of the song, in string format.
+     * @param id: the song's id in the playlist
+     * @param file: the song's file
      */
-    juce::String getLength(juce::URL audioURL);
+    void probeDuration(TrackStore::TrackId id, const juce::File& file);
 
     /**
-     * Converts seconds to minutes
+     * Fills in a song's duration, if it's still in the playlist.
      *
-     * @param seconds: duration of a song in seconds
-     * @returns: duration of a song in minutes, in string format
+     * @param id: the song's id in the playlist
+     * @param seconds: its duration
+     */
+    void durationProbed(TrackStore::TrackId id, double seconds);
+
+    /**
+     * @param file: the song's file
+     * @returns: the scheduler group its duration is read in
      */
-    juce::String secondsToMinutes(double seconds);
+    static juce::String getProbeGroup(const juce::File& file);
 
     /**
      * When the user closes the app, it saves a .csv file containing all songs added to the playlist.
@@ -161,8 +181,7 @@ private:
 
     /**
      * Checks if there exists a .csv file containing the playlist. 
-     * If file exists, create a Song object for each song contained in it and add this Song object to the 
-     * playlist vector. 
+     * If file exists, add each song contained in it to the playlist. 
      */
     void loadPlaylist();
 
@@ -175,21 +194,36 @@ private:
     void deleteFromPlaylist(int id);
 
     /**
-     * Allows user to browse for songs on their laptop and loads each selected song in a Song object.
-     * The Song object is then added to the songs vector aka the playlist. 
+     * Allows user to browse for songs on their laptop and adds each selected song to the playlist.
      *
      * @param button: the button that was clicked
      */
     void importSongToPlaylist();
 
     /**
-     * The selected song is picked from the playlist vector and loaded to a DeckGUI object,
+     * The selected song is picked from the playlist and loaded to a DeckGUI object,
      * which loads the song to be played.
      *
      * @param DeckGUI* deckGUI: the deck (left or right) into which the song is loaded
      */
     void loadSongInDeck(DeckGUI* deckGUI);
 
+    /**
+     * Adds the selected songs to the end of the Auto-DJ queue.
+     */
+    void queueSelectedSongs();
+
+    /**
+     * Turns the Auto-DJ on or off. Turned on with nothing queued, it plays the playlist
+     * from the selected song, or from the top.
+     */
+    void toggleAutoDJ();
+
+    /**
+     * Shows the Auto-DJ's queue length and what it's doing.
+     */
+    void updateAutoDJStatus();
+
     /**
      * Checks if a song is in the playlist
      *
@@ -0,0 +1,316 @@
+/*
+  ==============================================================================
+
+    ReadAheadAudioSource.cpp
+    Created: 19 Oct 2026 5:02:19pm
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#include "ReadAheadAudioSource.h"
+
+
+ReadAheadAudioSource::ReadAheadAudioSource(juce::AudioFormatReader* _reader, juce::TimeSliceThread* _thread)
+    : reader(_reader),
+      thread(_thread)
+{
+    if (thread != nullptr)
+    {
+        // all allocation happens here, on the thread loading the file
+        ringSize = (int)((historySeconds + readAheadSeconds) * reader->sampleRate);
+        readAheadSize = (int)(readAheadSeconds * reader->sampleRate);
+        ring.setSize(2, ringSize);
+        ring.clear();
+        thread->addTimeSliceClient(this);
+    }
+}
+
+ReadAheadAudioSource::~ReadAheadAudioSource()
+{
+    if (thread != nullptr)
+    {
+        thread->removeTimeSliceClient(this);
+    }
+}
+
+void ReadAheadAudioSource::prepareToPlay(int, double)
+{
+}
+
+void ReadAheadAudioSource::releaseResources()
+{
+}
+
+void ReadAheadAudioSource::getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill)
+{
+    // pick up a seek
+    const int requests = seekRequests.load(std::memory_order_acquire);
+    if (requests != seeksHandled.load(std::memory_order_relaxed))
+    {
+        playPosition.store(seekTarget.load(std::memory_order_acquire), std::memory_order_relaxed);
+        seeksHandled.store(requests, std::memory_order_release);
+    }
+
+    const auto position = playPosition.load(std::memory_order_relaxed);
+    const int numSamples = bufferToFill.numSamples;
+
+    if (thread == nullptr)
+    {
+        reader->read(bufferToFill.buffer, bufferToFill.startSample, numSamples, position, true, true);
+        playPosition.store(position + numSamples, std::memory_order_release);
+        return;
+    }
+
+    // copy whatever part of the block has been decoded
+    int numCopied = 0;
+    const int generation = windowGeneration.load(std::memory_order_acquire);
+    const auto start = windowStart.load(std::memory_order_acquire);
+    const auto end = windowEnd.load(std::memory_order_acquire);
+
+    if (position >= start && position < end)
+    {
+        const int available = (int)juce::jmin((juce::int64)numSamples, end - position);
+        copyFromRing(position, bufferToFill, 0, available);
+
+        // the decoder may have started reusing that part of the ring while we copied
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (windowGeneration.load(std::memory_order_relaxed) == generation
+            && windowStart.load(std::memory_order_relaxed) <= position
+            && windowEnd.load(std::memory_order_relaxed) >= position + available)
+        {
+            numCopied = available;
+        }
+    }
+
+    if (numCopied < numSamples)
+    {
+        for (int channel = 0; channel < bufferToFill.buffer->getNumChannels(); ++channel)
+        {
+            bufferToFill.buffer->clear(channel, bufferToFill.startSample + numCopied, numSamples - numCopied);
+        }
+        if (position + numCopied < reader->lengthInSamples)
+        {
+            underruns.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    playPosition.store(position + numSamples, std::memory_order_release);
+}
+
+void ReadAheadAudioSource::setNextReadPosition(juce::int64 newPosition)
+{
+    seekTarget.store(juce::jmax((juce::int64)0, newPosition), std::memory_order_release);
+    seekRequests.fetch_add(1, std::memory_order_acq_rel);
+}
+
+void ReadAheadAudioSource::setDirection(Direction newDirection)
+{
+    direction.store(newDirection, std::memory_order_relaxed);
+}
+
+bool ReadAheadAudioSource::readDecoded(juce::int64 position, juce::AudioBuffer<float>& dest, int numSamples)
+{
+    if (thread == nullptr)
+    {
+        return reader->read(&dest, 0, numSamples, position, true, true);
+    }
+
+    // the part of the request the window holds
+    const int generation = windowGeneration.load(std::memory_order_acquire);
+    auto from = juce::jmax(position, windowStart.load(std::memory_order_acquire));
+    auto to = juce::jmin(position + numSamples, windowEnd.load(std::memory_order_acquire));
+
+    if (from < to)
+    {
+        copyFromRing(from, juce::AudioSourceChannelInfo(&dest, 0, numSamples), (int)(from - position), (int)(to - from));
+
+        // the decoder may have started reusing that part of the ring while we copied
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (windowGeneration.load(std::memory_order_relaxed) != generation
+            || windowStart.load(std::memory_order_relaxed) > from
+            || windowEnd.load(std::memory_order_relaxed) < to)
+        {
+            from = to = position;
+        }
+    }
+    else
+    {
+        from = to = position;
+    }
+
+    const int copiedStart = (int)(from - position);
+    const int copiedEnd = (int)(to - position);
+    for (int channel = 0; channel < dest.getNumChannels(); ++channel)
+    {
+        dest.clear(channel, 0, copiedStart);
+        dest.clear(channel, copiedEnd, numSamples - copiedEnd);
+    }
+
+    // silence before the start or after the end of the file is expected, anything else was missed
+    const auto inFileStart = juce::jmax(position, (juce::int64)0);
+    const auto inFileEnd = juce::jmin(position + numSamples, reader->lengthInSamples);
+    const bool complete = inFileEnd <= inFileStart || (from <= inFileStart && to >= inFileEnd);
+    if (!complete)
+    {
+        underruns.fetch_add(1, std::memory_order_relaxed);
+    }
+    return complete;
+}
+
+juce::int64 ReadAheadAudioSource::getNextReadPosition() const
+{
+    return getPlayhead();
+}
+
+juce::int64 ReadAheadAudioSource::getTotalLength() const
+{
+    return reader->lengthInSamples;
+}
+
+bool ReadAheadAudioSource::isLooping() const
+{
+    return false;
+}
+
+double ReadAheadAudioSource::getSampleRate() const
+{
+    return reader->sampleRate;
+}
+
+int ReadAheadAudioSource::getNumUnderruns() const
+{
+    return underruns.load();
+}
+
+double ReadAheadAudioSource::getSecondsDecodedAhead() const
+{
+    if (reader->sampleRate <= 0)
+    {
+        return 0;
+    }
+
+    const auto playhead = getPlayhead();
+    if (thread == nullptr)
+    {
+        return juce::jmax((juce::int64)0, reader->lengthInSamples - playhead) / reader->sampleRate;
+    }
+
+    const auto start = windowStart.load(std::memory_order_acquire);
+    const auto end = windowEnd.load(std::memory_order_acquire);
+    if (playhead < start || playhead > end)
+    {
+        return 0;
+    }
+    return (end - playhead) / reader->sampleRate;
+}
+
+int ReadAheadAudioSource::useTimeSlice()
+{
+    const auto playhead = getPlayhead();
+    auto start = windowStart.load(std::memory_order_relaxed);
+    auto end = windowEnd.load(std::memory_order_relaxed);
+
+    // a seek outside the decoded window, or playback overtook the decoder: start again
+    // from the playhead
+    if (playhead < start || playhead > end)
+    {
+        start = end = playhead;
+        windowStart.store(start, std::memory_order_relaxed);
+        windowEnd.store(end, std::memory_order_relaxed);
+        windowGeneration.fetch_add(1, std::memory_order_release);
+    }
+
+    // how far to decode on each side. The two never add up to more than the ring, so
+    // filling one side only ever drops audio the other side doesn't want. Going backwards
+    // still keeps a chunk ahead, which interpolating around the playhead reads
+    const int heading = direction.load(std::memory_order_relaxed);
+    const juce::int64 ahead = heading == forward ? readAheadSize : (heading == both ? ringSize / 2 : decodeChunkSize);
+    const juce::int64 behind = heading == backward ? readAheadSize : (heading == both ? ringSize / 2 : 0);
+    const auto wantedEnd = juce::jmin(playhead + ahead, reader->lengthInSamples);
+    const auto wantedStart = juce::jmax(playhead - behind, (juce::int64)0);
+
+    const bool wantsForward = end < wantedEnd;
+    const bool wantsBackward = start > wantedStart;
+    if (!wantsForward && !wantsBackward)
+    {
+        return 10;
+    }
+
+    // the side the playhead is heading for goes first, or when it's going both ways the
+    // side with less decoded
+    if (wantsBackward && (!wantsForward || heading == backward || playhead - start < end - playhead))
+    {
+        decodeBackward(start, end, wantedStart);
+        return 0;
+    }
+
+    const int numToRead = (int)juce::jmin(wantedEnd - end, (juce::int64)decodeChunkSize);
+
+    // the chunk overwrites the oldest audio in the ring, which is well behind the playhead
+    const auto newStart = juce::jmax(start, end + numToRead - ringSize);
+    if (newStart != start)
+    {
+        windowStart.store(newStart, std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+
+    decodeIntoRing(end, numToRead);
+    windowEnd.store(end + numToRead, std::memory_order_release);
+    return 0;
+}
+
+void ReadAheadAudioSource::decodeBackward(juce::int64 start, juce::int64 end, juce::int64 wantedStart)
+{
+    const int numToRead = (int)juce::jmin(start - wantedStart, (juce::int64)decodeChunkSize);
+    const auto newStart = start - numToRead;
+
+    // the chunk overwrites the audio furthest ahead, which is well away from the playhead
+    const auto newEnd = juce::jmin(end, newStart + ringSize);
+    if (newEnd != end)
+    {
+        windowEnd.store(newEnd, std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+
+    decodeIntoRing(newStart, numToRead);
+    windowStart.store(newStart, std::memory_order_release);
+}
+
+void ReadAheadAudioSource::decodeIntoRing(juce::int64 position, int numSamples)
+{
+    const int ringPosition = (int)(position % ringSize);
+    const int firstPart = juce::jmin(numSamples, ringSize - ringPosition);
+    reader->read(&ring, ringPosition, firstPart, position, true, true);
+    if (firstPart < numSamples)
+    {
+        reader->read(&ring, 0, numSamples - firstPart, position + firstPart, true, true);
+    }
+}
+
+juce::int64 ReadAheadAudioSource::getPlayhead() const
+{
+    if (seekRequests.load(std::memory_order_acquire) != seeksHandled.load(std::memory_order_acquire))
+    {
+        return seekTarget.load(std::memory_order_acquire);
+    }
+    return playPosition.load(std::memory_order_acquire);
+}
+
+void ReadAheadAudioSource::copyFromRing(juce::int64 position, const juce::AudioSourceChannelInfo& bufferToFill,
+    int offset, int numSamples) const
+{
+    const int ringPosition = (int)(position % ringSize);
+    const int firstPart = juce::jmin(numSamples, ringSize - ringPosition);
+    const int destStart = bufferToFill.startSample + offset;
+
+    for (int channel = 0; channel < bufferToFill.buffer->getNumChannels(); ++channel)
+    {
+        const int sourceChannel = juce::jmin(channel, ring.getNumChannels() - 1);
+        bufferToFill.buffer->copyFrom(channel, destStart, ring, sourceChannel, ringPosition, firstPart);
+        if (firstPart < numSamples)
+        {
+            bufferToFill.buffer->copyFrom(channel, destStart + firstPart, ring, sourceChannel, 0, numSamples - firstPart);
+        }
+    }
+}
@@ -0,0 +1,158 @@
+/*
+  ==============================================================================
+
+    ReadAheadAudioSource.h
+    Created: 19 Oct 2026 5:02:19pm
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <atomic>
+
+
+/**
+ * Plays an audio file, decoding it ahead of the playhead on a background thread.
+ *
+ * Decoded audio is kept in a ring buffer addressed by file position, holding a little
+ * history behind the playhead and a few seconds ahead of it, so small backward jumps
+ * don't need decoding again. Told the playhead is heading backwards, or both ways as it
+ * does while scratching, the window is decoded on that side of the playhead instead.
+ * The audio thread only copies out of the ring and never reads the file, allocates or
+ * takes a lock; if decoding ever falls behind it plays silence and counts an underrun
+ * rather than waiting.
+ *
+ * Without a thread the file is decoded on the calling thread as it is played, which is
+ * what offline rendering and benchmarking want.
+ */
+class ReadAheadAudioSource : public juce::PositionableAudioSource,
+    private juce::TimeSliceClient
+{
+public:
+    /** Which side of the playhead to keep decoded */
+    enum Direction
+    {
+        backward = -1,
+        both = 0,
+        forward = 1
+    };
+
+    /**
+     * Constructor
+     *
+     * @param _reader: the file to play, owned by the source
+     * @param _thread: thread to decode on, or nullptr to decode while playing
+     */
+    ReadAheadAudioSource(juce::AudioFormatReader* _reader, juce::TimeSliceThread* _thread);
+
+    /** Destructor. Stops decoding. */
+    ~ReadAheadAudioSource() override;
+
+    void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
+    void releaseResources() override;
+
+    /**
+     * Copies the next block out of the decoded window. Called on the audio thread.
+     *
+     * @param bufferToFill: buffer to fill with the next block of the file
+     */
+    void getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill) override;
+
+    /**
+     * Moves the playhead. Safe to call from any thread; the audio thread picks it up at
+     * its next block.
+     *
+     * @param newPosition: position in samples of the file
+     */
+    void setNextReadPosition(juce::int64 newPosition) override;
+
+    /**
+     * Tells the decoder which way the playhead is going. Safe to call from any thread.
+     *
+     * @param direction: forward for normal play, backward for reverse, both for scratching
+     */
+    void setDirection(Direction direction);
+
+    /**
+     * Copies decoded audio from anywhere in the window, for playing at rates the source
+     * can't, such as backwards. Called on the audio thread; it doesn't move the playhead.
+     * What's outside the file or hasn't been decoded comes out silent.
+     *
+     * @param position: file position of the first sample
+     * @param dest: where to copy to, from its first sample
+     * @param numSamples: how many samples
+     * @returns: false if part of it wasn't decoded yet
+     */
+    bool readDecoded(juce::int64 position, juce::AudioBuffer<float>& dest, int numSamples);
+
+    /** @returns: the playhead, in samples of the file */
+    juce::int64 getNextReadPosition() const override;
+
+    /** @returns: length of the file in samples */
+    juce::int64 getTotalLength() const override;
+
+    /** @returns: always false, decks don't loop */
+    bool isLooping() const override;
+
+    /** @returns: the file's sample rate */
+    double getSampleRate() const;
+
+    /** @returns: number of blocks that weren't fully decoded in time */
+    int getNumUnderruns() const;
+
+    /**
+     * @returns: how much is decoded ahead of the playhead, up to the few seconds the
+     *           source keeps, or to the end of the file. Without a thread, everything left.
+     */
+    double getSecondsDecodedAhead() const;
+
+private:
+    // decoded audio kept around the playhead
+    static constexpr double historySeconds = 1.0;
+    static constexpr double readAheadSeconds = 3.0;
+    // most the decoder reads in one go, so a seek is never stuck behind a long read
+    static constexpr int decodeChunkSize = 8192;
+
+    std::unique_ptr<juce::AudioFormatReader> reader;
+    juce::TimeSliceThread* thread;
+
+    juce::AudioBuffer<float> ring;
+    int ringSize = 0;
+    int readAheadSize = 0;
+
+    // the file positions held in the ring, written by the decoding thread. Any change
+    // that may overwrite audio the audio thread is copying bumps windowGeneration or
+    // moves windowStart past it first, so the copy can be checked afterwards.
+    std::atomic<juce::int64> windowStart{ 0 };
+    std::atomic<juce::int64> windowEnd{ 0 };
+    std::atomic<int> windowGeneration{ 0 };
+
+    // playhead, only written by the audio thread; seeks are handed over through seekTarget
+    std::atomic<juce::int64> playPosition{ 0 };
+    std::atomic<juce::int64> seekTarget{ 0 };
+    std::atomic<int> seekRequests{ 0 };
+    std::atomic<int> seeksHandled{ 0 };
+
+    std::atomic<int> underruns{ 0 };
+    std::atomic<int> direction{ forward };
+
+    /** Decodes the next chunk ahead of the playhead. Runs on the decoding thread. */
+    int useTimeSlice() override;
+
+    /** Decodes a chunk before the start of the window. Runs on the decoding thread. */
+    void decodeBackward(juce::int64 start, juce::int64 end, juce::int64 wantedStart);
+
+    /** Decodes part of the file into the ring, handling the wrap around. */
+    void decodeIntoRing(juce::int64 position, int numSamples);
+
+    /** @returns: where playback will continue from, including a seek not picked up yet */
+    juce::int64 getPlayhead() const;
+
+    /** Copies part of the ring out, handling the wrap around. */
+    void copyFromRing(juce::int64 position, const juce::AudioSourceChannelInfo& bufferToFill,
+        int offset, int numSamples) const;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ReadAheadAudioSource)
+};
@@ -0,0 +1,471 @@
+/*
+  ==============================================================================
+
+    RealtimeSafety.cpp
+    Created: 19 Oct 2026 5:40:53pm
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#include "RealtimeSafety.h"
+#include <atomic>
+#include <cstring>
+
+#if JUCE_LINUX && (JUCE_DEBUG || DJ_REALTIME_CHECKS)
+ #define DJ_REALTIME_INTERCEPTION 1
+ #include <cerrno>
+ #include <cxxabi.h>
+ #include <dlfcn.h>
+ #include <execinfo.h>
+ #include <malloc.h>
+ #include <poll.h>
+ #include <pthread.h>
+ #include <time.h>
+ #include <unistd.h>
+#else
+ #define DJ_REALTIME_INTERCEPTION 0
+#endif
+
+
+namespace
+{
+    // everything here is zero-initialised before any constructor runs, so the hooks
+    // below are safe to call even while the C runtime is still starting up
+    thread_local int realtimeDepth = 0;
+    thread_local bool insideHook = false;
+
+    std::atomic<bool> checkingEnabled{ false };
+    std::atomic<juce::int64> violationCounts[RealtimeSafety::numViolationTypes];
+    std::atomic<juce::int64> uncontendedLocks{ 0 };
+
+    // every heap block in the process, counted whether or not a section is marked
+    std::atomic<juce::int64> heapAllocations{ 0 };
+    std::atomic<juce::int64> heapBytes{ 0 };
+
+    constexpr int maxRecordedViolations = 256;
+    constexpr int maxStackDepth = 24;
+
+    struct ViolationRecord
+    {
+        std::atomic<bool> ready;
+        int type;
+        int depth;
+        void* frames[maxStackDepth];
+    };
+
+    ViolationRecord records[maxRecordedViolations];
+    std::atomic<int> numRecords{ 0 };
+
+    const char* const violationNames[] = { "allocation", "deallocation", "contended lock", "blocking call" };
+
+   #if DJ_REALTIME_INTERCEPTION
+    /** @returns: true if the current call should be checked */
+    inline bool shouldCheck()
+    {
+        return realtimeDepth > 0 && !insideHook && checkingEnabled.load(std::memory_order_relaxed);
+    }
+
+    /** Counts a violation and keeps its stack while there is room in the table */
+    void recordViolation(RealtimeSafety::ViolationType type)
+    {
+        insideHook = true;
+        violationCounts[type].fetch_add(1, std::memory_order_relaxed);
+
+        const int index = numRecords.fetch_add(1, std::memory_order_relaxed);
+        if (index < maxRecordedViolations)
+        {
+            auto& record = records[index];
+            record.type = type;
+            record.depth = backtrace(record.frames, maxStackDepth);
+            record.ready.store(true, std::memory_order_release);
+        }
+        insideHook = false;
+    }
+
+    inline void countAllocation(void* block)
+    {
+        if (block != nullptr)
+        {
+            heapAllocations.fetch_add(1, std::memory_order_relaxed);
+            heapBytes.fetch_add((juce::int64)malloc_usable_size(block), std::memory_order_relaxed);
+        }
+    }
+
+    inline void countFree(void* block)
+    {
+        if (block != nullptr)
+        {
+            heapBytes.fetch_sub((juce::int64)malloc_usable_size(block), std::memory_order_relaxed);
+        }
+    }
+
+    inline void checkBlockingCall()
+    {
+        if (shouldCheck())
+        {
+            recordViolation(RealtimeSafety::blockingCall);
+        }
+    }
+
+    /** Finds the next definition of a libc function, preferring the current symbol version */
+    void* findRealFunction(const char* name)
+    {
+        if (auto* function = dlvsym(RTLD_NEXT, name, "GLIBC_2.3.2"))
+        {
+            return function;
+        }
+        return dlsym(RTLD_NEXT, name);
+    }
+
+    /** @returns: the function name in a backtrace_symbols() line, demangled if possible */
+    juce::String describeFrame(const char* symbol)
+    {
+        const char* open = std::strchr(symbol, '(');
+        const char* plus = open != nullptr ? std::strchr(open, '+') : nullptr;
+        if (open == nullptr || plus == nullptr || plus == open + 1)
+        {
+            return symbol;
+        }
+
+        const juce::String mangled(open + 1, (size_t)(plus - open - 1));
+        int status = 0;
+        if (char* demangled = abi::__cxa_demangle(mangled.toRawUTF8(), nullptr, nullptr, &status))
+        {
+            const juce::String name(demangled);
+            std::free(demangled);
+            return name;
+        }
+        return mangled;
+    }
+   #endif
+}
+
+
+#if DJ_REALTIME_INTERCEPTION
+// glibc's own entry points, which the overrides below forward to
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* ptr, size_t size);
+extern "C" void* __libc_memalign(size_t alignment, size_t size);
+extern "C" void __libc_free(void* ptr);
+
+extern "C"
+{
+    void* malloc(size_t size) noexcept
+    {
+        if (shouldCheck())
+        {
+            recordViolation(RealtimeSafety::allocation);
+        }
+        void* block = __libc_malloc(size);
+        countAllocation(block);
+        return block;
+    }
+
+    void* calloc(size_t count, size_t size) noexcept
+    {
+        if (shouldCheck())
+        {
+            recordViolation(RealtimeSafety::allocation);
+        }
+        void* block = __libc_calloc(count, size);
+        countAllocation(block);
+        return block;
+    }
+
+    void* realloc(void* ptr, size_t size) noexcept
+    {
+        if (shouldCheck())
+        {
+            recordViolation(RealtimeSafety::allocation);
+        }
+        // the old block is only gone if the new one was made, or the size was zero
+        const auto oldBytes = ptr != nullptr ? (juce::int64)malloc_usable_size(ptr) : 0;
+        void* block = __libc_realloc(ptr, size);
+        if (block != nullptr || size == 0)
+        {
+            heapBytes.fetch_sub(oldBytes, std::memory_order_relaxed);
+        }
+        countAllocation(block);
+        return block;
+    }
+
+    void* aligned_alloc(size_t alignment, size_t size) noexcept
+    {
+        if (shouldCheck())
+        {
+            recordViolation(RealtimeSafety::allocation);
+        }
+        void* block = __libc_memalign(alignment, size);
+        countAllocation(block);
+        return block;
+    }
+
+    int posix_memalign(void** result, size_t alignment, size_t size) noexcept
+    {
+        if (shouldCheck())
+        {
+            recordViolation(RealtimeSafety::allocation);
+        }
+        *result = __libc_memalign(alignment, size);
+        countAllocation(*result);
+        return *result != nullptr ? 0 : ENOMEM;
+    }
+
+    void free(void* ptr) noexcept
+    {
+        if (ptr != nullptr && shouldCheck())
+        {
+            recordViolation(RealtimeSafety::deallocation);
+        }
+        countFree(ptr);
+        __libc_free(ptr);
+    }
+
+    int pthread_mutex_lock(pthread_mutex_t* mutex) noexcept
+    {
+        static int (*realLock)(pthread_mutex_t*) = nullptr;
+        if (realLock == nullptr)
+        {
+            realLock = (int (*)(pthread_mutex_t*))dlsym(RTLD_NEXT, "pthread_mutex_lock");
+        }
+
+        // an uncontended lock never waits; only one held by another thread is a problem
+        if (shouldCheck())
+        {
+            if (pthread_mutex_trylock(mutex) == 0)
+            {
+                uncontendedLocks.fetch_add(1, std::memory_order_relaxed);
+                return 0;
+            }
+            recordViolation(RealtimeSafety::contendedLock);
+        }
+        return realLock(mutex);
+    }
+
+    int pthread_cond_wait(pthread_cond_t* condition, pthread_mutex_t* mutex)
+    {
+        static int (*realWait)(pthread_cond_t*, pthread_mutex_t*) = nullptr;
+        if (realWait == nullptr)
+        {
+            realWait = (int (*)(pthread_cond_t*, pthread_mutex_t*))findRealFunction("pthread_cond_wait");
+        }
+        checkBlockingCall();
+        return realWait(condition, mutex);
+    }
+
+    int pthread_cond_timedwait(pthread_cond_t* condition, pthread_mutex_t* mutex, const struct timespec* time)
+    {
+        static int (*realWait)(pthread_cond_t*, pthread_mutex_t*, const struct timespec*) = nullptr;
+        if (realWait == nullptr)
+        {
+            realWait = (int (*)(pthread_cond_t*, pthread_mutex_t*, const struct timespec*))findRealFunction("pthread_cond_timedwait");
+        }
+        checkBlockingCall();
+        return realWait(condition, mutex, time);
+    }
+
+    ssize_t read(int fd, void* buffer, size_t size)
+    {
+        static ssize_t (*realRead)(int, void*, size_t) = nullptr;
+        if (realRead == nullptr)
+        {
+            realRead = (ssize_t (*)(int, void*, size_t))dlsym(RTLD_NEXT, "read");
+        }
+        checkBlockingCall();
+        return realRead(fd, buffer, size);
+    }
+
+    ssize_t write(int fd, const void* buffer, size_t size)
+    {
+        static ssize_t (*realWrite)(int, const void*, size_t) = nullptr;
+        if (realWrite == nullptr)
+        {
+            realWrite = (ssize_t (*)(int, const void*, size_t))dlsym(RTLD_NEXT, "write");
+        }
+        checkBlockingCall();
+        return realWrite(fd, buffer, size);
+    }
+
+    int nanosleep(const struct timespec* requested, struct timespec* remaining)
+    {
+        static int (*realSleep)(const struct timespec*, struct timespec*) = nullptr;
+        if (realSleep == nullptr)
+        {
+            realSleep = (int (*)(const struct timespec*, struct timespec*))dlsym(RTLD_NEXT, "nanosleep");
+        }
+        checkBlockingCall();
+        return realSleep(requested, remaining);
+    }
+
+    int usleep(useconds_t microseconds)
+    {
+        static int (*realSleep)(useconds_t) = nullptr;
+        if (realSleep == nullptr)
+        {
+            realSleep = (int (*)(useconds_t))dlsym(RTLD_NEXT, "usleep");
+        }
+        checkBlockingCall();
+        return realSleep(microseconds);
+    }
+
+    int poll(struct pollfd* fds, nfds_t numFds, int timeout)
+    {
+        static int (*realPoll)(struct pollfd*, nfds_t, int) = nullptr;
+        if (realPoll == nullptr)
+        {
+            realPoll = (int (*)(struct pollfd*, nfds_t, int))dlsym(RTLD_NEXT, "poll");
+        }
+        checkBlockingCall();
+        return realPoll(fds, numFds, timeout);
+    }
+}
+#endif
+
+
+namespace RealtimeSafety
+{
+    ScopedRealtimeSection::ScopedRealtimeSection()
+    {
+        ++realtimeDepth;
+    }
+
+    ScopedRealtimeSection::~ScopedRealtimeSection()
+    {
+        --realtimeDepth;
+    }
+
+    bool isInRealtimeSection()
+    {
+        return realtimeDepth > 0;
+    }
+
+    bool isCheckerAvailable()
+    {
+        return DJ_REALTIME_INTERCEPTION != 0;
+    }
+
+    void setCheckingEnabled(bool shouldCheck)
+    {
+       #if DJ_REALTIME_INTERCEPTION
+        if (shouldCheck)
+        {
+            // the first backtrace() loads the unwinder, which allocates; get that out of the way here
+            void* frames[2];
+            backtrace(frames, 2);
+        }
+       #endif
+        checkingEnabled.store(shouldCheck);
+    }
+
+    juce::int64 getNumViolations(ViolationType type)
+    {
+        return violationCounts[type].load();
+    }
+
+    juce::int64 getTotalViolations()
+    {
+        juce::int64 total = 0;
+        for (auto& count : violationCounts)
+        {
+            total += count.load();
+        }
+        return total;
+    }
+
+    juce::int64 getNumUncontendedLocks()
+    {
+        return uncontendedLocks.load();
+    }
+
+    juce::int64 getNumHeapAllocations()
+    {
+        return heapAllocations.load();
+    }
+
+    juce::int64 getHeapBytesInUse()
+    {
+        return heapBytes.load();
+    }
+
+    void clearViolations()
+    {
+        for (auto& record : records)
+        {
+            record.ready.store(false);
+        }
+        numRecords.store(0);
+        for (auto& count : violationCounts)
+        {
+            count.store(0);
+        }
+        uncontendedLocks.store(0);
+    }
+
+    juce::String getReport()
+    {
+        juce::String report;
+        if (getTotalViolations() == 0)
+        {
+            return report;
+        }
+
+        for (int type = 0; type < numViolationTypes; ++type)
+        {
+            report << violationNames[type] << ": " << getNumViolations((ViolationType)type) << "\n";
+        }
+
+       #if DJ_REALTIME_INTERCEPTION
+        // the same violation usually repeats every block, so list each distinct stack once
+        struct DistinctViolation
+        {
+            const ViolationRecord* record;
+            int count;
+        };
+        juce::Array<DistinctViolation> distinct;
+
+        const int numStored = juce::jmin(numRecords.load(), maxRecordedViolations);
+        for (int i = 0; i < numStored; ++i)
+        {
+            const auto& record = records[i];
+            if (!record.ready.load(std::memory_order_acquire))
+            {
+                continue;
+            }
+
+            bool found = false;
+            for (auto& existing : distinct)
+            {
+                if (existing.record->type == record.type && existing.record->depth == record.depth
+                    && std::memcmp(existing.record->frames, record.frames, sizeof(void*) * (size_t)record.depth) == 0)
+                {
+                    ++existing.count;
+                    found = true;
+                    break;
+                }
+            }
+            if (!found)
+            {
+                distinct.add({ &record, 1 });
+            }
+        }
+
+        for (auto& violation : distinct)
+        {
+            report << "\n" << violationNames[violation.record->type] << " (seen " << violation.count << " times)\n";
+
+            // the first two frames are recordViolation() and the hook itself
+            if (char** symbols = backtrace_symbols(violation.record->frames, violation.record->depth))
+            {
+                for (int frame = 2; frame < violation.record->depth; ++frame)
+                {
+                    report << "    " << describeFrame(symbols[frame]) << "\n";
+                }
+                std::free(symbols);
+            }
+        }
+       #endif
+        return report;
+    }
+}
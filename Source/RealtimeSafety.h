@@ -0,0 +1,96 @@
+/*
+  ==============================================================================
+
+    RealtimeSafety.h
+    Created: 19 Oct 2026 5:40:53pm
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+
+/**
+ * Catches code that isn't safe to run on the audio thread.
+ *
+ * Audio code marks itself with a ScopedRealtimeSection. In debug Linux builds (or any
+ * build with DJ_REALTIME_CHECKS=1, like the benchmark's Checked configuration) malloc
+ * and free, contended mutex locks and blocking system calls are intercepted, and any
+ * made inside a marked section is recorded with its stack. Recording itself never allocates: violations go into a fixed table and
+ * are only turned into text when a report is asked for, off the audio thread.
+ *
+ * The same hooks count every heap allocation in the process, in or out of a marked
+ * section, so the benchmark can see what JUCE's malloc-based buffers take too.
+ *
+ * Uncontended lock acquisitions are counted but not treated as violations: JUCE's
+ * transport and resampler take their own callback locks every block, which only ever
+ * wait if another thread is inside them at the same moment.
+ *
+ * Everywhere else the checks compile to nothing and isCheckerAvailable() returns false.
+ */
+namespace RealtimeSafety
+{
+    /** What went wrong */
+    enum ViolationType
+    {
+        allocation = 0,
+        deallocation,
+        contendedLock,
+        blockingCall,
+        numViolationTypes
+    };
+
+    /** Marks the current thread as running audio code for as long as it exists */
+    class ScopedRealtimeSection
+    {
+    public:
+        ScopedRealtimeSection();
+        ~ScopedRealtimeSection();
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedRealtimeSection)
+    };
+
+    /** @returns: true if the current thread is inside a ScopedRealtimeSection */
+    bool isInRealtimeSection();
+
+    /** @returns: true if the interception was compiled into this build */
+    bool isCheckerAvailable();
+
+    /**
+     * Starts or stops recording violations. Call from a non-audio thread.
+     *
+     * @param shouldCheck: true to record violations made in realtime sections
+     */
+    void setCheckingEnabled(bool shouldCheck);
+
+    /** @returns: number of violations of a type since the last clear */
+    juce::int64 getNumViolations(ViolationType type);
+
+    /** @returns: total violations of every type since the last clear */
+    juce::int64 getTotalViolations();
+
+    /** @returns: number of uncontended lock acquisitions in realtime sections */
+    juce::int64 getNumUncontendedLocks();
+
+    /**
+     * @returns: number of blocks malloc and its relatives have handed out since the
+     *           program started, or 0 where the checker isn't compiled in
+     */
+    juce::int64 getNumHeapAllocations();
+
+    /** @returns: bytes in the heap blocks currently allocated, as malloc_usable_size() counts them */
+    juce::int64 getHeapBytesInUse();
+
+    /** Forgets all recorded violations. */
+    void clearViolations();
+
+    /**
+     * Describes every distinct violation recorded, with its stack. Allocates, so never
+     * call it from the audio thread.
+     *
+     * @returns: the report, empty if nothing was recorded
+     */
+    juce::String getReport();
+}
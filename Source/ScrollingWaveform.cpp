@@ -0,0 +1,156 @@
+/*
+  ==============================================================================
+
+    ScrollingWaveform.cpp
+    Created: 19 Oct 2026 9:34:08pm
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#include "ScrollingWaveform.h"
+#include <cmath>
+
+
+ScrollingWaveform::ScrollingWaveform(juce::AudioFormatManager& _formatManager)
+    : formatManager(_formatManager)
+{
+    setOpaque(true);
+}
+
+void ScrollingWaveform::loadURL(juce::URL audioURL)
+{
+    spectralWaveform.reset();
+    tiles.clear();
+    recentTiles.clear();
+    loadedURL = audioURL;
+    trackLoaded = audioURL.isLocalFile();
+    position = 0;
+
+    if (trackLoaded)
+    {
+        juce::Component::SafePointer<ScrollingWaveform> safeThis(this);
+        spectralCache->request(audioURL.getLocalFile(), formatManager,
+            [safeThis, audioURL](std::shared_ptr<const SpectralWaveform> waveform)
+            {
+                if (safeThis != nullptr && safeThis->loadedURL == audioURL)
+                {
+                    safeThis->spectralWaveform = waveform;
+                    safeThis->trackLoaded = waveform != nullptr;
+                    safeThis->repaint();
+                }
+            });
+    }
+    repaint();
+}
+
+void ScrollingWaveform::setPosition(double seconds)
+{
+    if (seconds == position)
+    {
+        return;
+    }
+
+    const double pixelsPerSecond = getPixelsPerSecond();
+    const bool moved = juce::roundToInt(seconds * pixelsPerSecond) != juce::roundToInt(position * pixelsPerSecond);
+    position = seconds;
+    if (moved)
+    {
+        repaint();
+    }
+}
+
+void ScrollingWaveform::paint(juce::Graphics& g)
+{
+    g.fillAll(getLookAndFeel().findColour(juce::ResizableWindow::backgroundColourId));
+
+    if (spectralWaveform != nullptr)
+    {
+        // the track pixel at the left edge, with the playhead's pixel in the middle
+        const int left = juce::roundToInt(position * getPixelsPerSecond()) - getWidth() / 2;
+        for (int index = (int)std::floor(left / (double)tileWidth); index * tileWidth < left + getWidth(); ++index)
+        {
+            if (index >= 0)
+            {
+                g.drawImageAt(getTile(index), index * tileWidth - left, 0);
+            }
+        }
+    }
+    else if (trackLoaded)
+    {
+        g.setColour(juce::Colours::coral);
+        g.setFont(14.0f);
+        g.drawText("Analysing...", getLocalBounds(), juce::Justification::centred, true);
+    }
+
+    g.setColour(juce::Colours::white);
+    g.fillRect(getWidth() / 2 - 1, 0, 2, getHeight());
+    g.setColour(juce::Colours::coral);
+    g.drawRect(getLocalBounds(), 1);
+}
+
+void ScrollingWaveform::resized()
+{
+    tiles.clear();
+    recentTiles.clear();
+}
+
+void ScrollingWaveform::mouseDown(const juce::MouseEvent& event)
+{
+    lastDragX = event.position.x;
+    if (onScratchStart != nullptr)
+    {
+        onScratchStart();
+    }
+}
+
+void ScrollingWaveform::mouseDrag(const juce::MouseEvent& event)
+{
+    // the track scrolls right to left, so dragging left moves it forward
+    const float dx = event.position.x - lastDragX;
+    lastDragX = event.position.x;
+    if (dx != 0 && onScratchMove != nullptr)
+    {
+        onScratchMove(-dx / getPixelsPerSecond());
+    }
+}
+
+void ScrollingWaveform::mouseUp(const juce::MouseEvent&)
+{
+    if (onScratchEnd != nullptr)
+    {
+        onScratchEnd();
+    }
+}
+
+double ScrollingWaveform::getPixelsPerSecond() const
+{
+    return getWidth() / visibleSeconds;
+}
+
+const juce::Image& ScrollingWaveform::getTile(int index)
+{
+    recentTiles.removeFirstMatchingValue(index);
+    recentTiles.add(index);
+
+    auto found = tiles.find(index);
+    if (found != tiles.end())
+    {
+        return found->second;
+    }
+
+    while (recentTiles.size() > maxCachedTiles)
+    {
+        tiles.erase(recentTiles.getFirst());
+        recentTiles.remove(0);
+    }
+
+    juce::Image tile(juce::Image::RGB, tileWidth, juce::jmax(1, getHeight()), false);
+    juce::Graphics g(tile);
+    g.fillAll(getLookAndFeel().findColour(juce::ResizableWindow::backgroundColourId));
+
+    const double pixelsPerSecond = getPixelsPerSecond();
+    spectralWaveform->draw(g, tile.getBounds(), index * tileWidth / pixelsPerSecond, (index + 1) * tileWidth / pixelsPerSecond);
+
+    return tiles[index] = tile;
+}
@@ -0,0 +1,100 @@
+/*
+  ==============================================================================
+
+    ScrollingWaveform.h
+    Created: 19 Oct 2026 9:34:08pm
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <functional>
+#include <map>
+#include "SpectralWaveform.h"
+
+
+/**
+ * Close-up colour waveform that scrolls past a fixed playhead in the middle.
+ *
+ * The track is cut into tiles at the current zoom, each drawn into an image the first
+ * time it comes into view, so a frame only blits two or three images at an offset.
+ *
+ * Dragging the waveform scratches it like a record under the hand.
+ */
+class ScrollingWaveform : public juce::Component
+{
+public:
+    /**
+     * Constructor
+     *
+     * @param _formatManager: to open tracks with for the analysis
+     */
+    ScrollingWaveform(juce::AudioFormatManager& _formatManager);
+
+    /**
+     * Shows a new track, once its analysis is ready.
+     *
+     * @param audioURL: the track
+     */
+    void loadURL(juce::URL audioURL);
+
+    /**
+     * Moves the track under the playhead. Repaints only if it moved by a pixel or more.
+     *
+     * @param seconds: the track position to centre on
+     */
+    void setPosition(double seconds);
+
+    /**
+     * Blits the visible tiles and draws the playhead.
+     *
+     * @param g: the graphics context to draw with
+     */
+    void paint(juce::Graphics& g) override;
+
+    /** Drops the tiles, which were drawn for the old size. */
+    void resized() override;
+
+    /** Puts the hand on the record */
+    void mouseDown(const juce::MouseEvent& event) override;
+
+    /** Moves the record by as much of the track as the mouse moved over */
+    void mouseDrag(const juce::MouseEvent& event) override;
+
+    /** Lets go of the record */
+    void mouseUp(const juce::MouseEvent& event) override;
+
+    /** Called when a scratch starts */
+    std::function<void()> onScratchStart;
+
+    /** Called as the record is dragged, with how far it moved in seconds, negative for backwards */
+    std::function<void(double)> onScratchMove;
+
+    /** Called when a scratch ends */
+    std::function<void()> onScratchEnd;
+
+private:
+    static constexpr double visibleSeconds = 8.0;
+    static constexpr int tileWidth = 256;
+    static constexpr int maxCachedTiles = 16;
+
+    juce::AudioFormatManager& formatManager;
+    juce::SharedResourcePointer<SpectralWaveformCache> spectralCache;
+    std::shared_ptr<const SpectralWaveform> spectralWaveform;
+    juce::URL loadedURL;
+    bool trackLoaded = false;
+    double position = 0;
+    float lastDragX = 0;
+
+    std::map<int, juce::Image> tiles;
+    juce::Array<int> recentTiles; // tile indexes, least recently drawn first
+
+    double getPixelsPerSecond() const;
+
+    /** @returns: a tile's image, drawing it if it isn't cached */
+    const juce::Image& getTile(int index);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ScrollingWaveform)
+};
@@ -0,0 +1,614 @@
+/*
+  ==============================================================================
+
+    SpectralWaveform.cpp
+    Created: 19 Oct 2026 8:52:34pm
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#include "SpectralWaveform.h"
+
+// band edges
+static const double lowCrossoverHz = 200.0;
+static const double midCentreHz = 1200.0;
+static const double highCrossoverHz = 4000.0;
+
+// columns decoded per read
+static const int columnsPerRead = 64;
+
+// tempos the beat is looked for in; anything outside is taken at half or double time
+static const double minBeatsPerMinute = 80.0;
+static const double maxBeatsPerMinute = 160.0;
+// how far the attacks must repeat above chance for the track to count as having a beat
+static const double minBeatStrength = 1.5;
+
+// saved analysis header
+static const int analysisMagic = 0x57534a44; // "DJSW"
+static const int analysisVersion = 1;
+
+
+/**
+ * Four filters run side by side, one per lane: low pass, band pass, high pass and the
+ * unfiltered signal. Each lane is two biquads in series for steeper band edges. With
+ * SIMD every sample goes through all four as a single register.
+ */
+class BandFilterBank
+{
+public:
+    enum Lane
+    {
+        lowLane = 0,
+        midLane,
+        highLane,
+        fullLane,
+        numLanes
+    };
+
+    explicit BandFilterBank(double sampleRate)
+    {
+        using Coefficients = juce::dsp::IIR::Coefficients<float>;
+        const Coefficients::Ptr filters[] = {
+            Coefficients::makeLowPass(sampleRate, lowCrossoverHz),
+            Coefficients::makeBandPass(sampleRate, midCentreHz, 0.5),
+            Coefficients::makeHighPass(sampleRate, highCrossoverHz)
+        };
+
+        for (int lane = 0; lane < numLanes; ++lane)
+        {
+            // the raw coefficients are b0, b1, b2, a1, a2, already divided by a0
+            const float passThrough[] = { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+            const float* raw = lane < fullLane ? filters[lane]->getRawCoefficients() : passThrough;
+            for (int i = 0; i < 5; ++i)
+            {
+                coefficients[i][lane] = raw[i];
+            }
+        }
+    }
+
+    /**
+     * Filters a column's worth of mono samples and measures every lane.
+     *
+     * @param sumOfSquares: receives the lanes' sums of squares
+     * @param peak: receives the lanes' largest magnitude
+     */
+    void process(const float* samples, int numSamples, float* sumOfSquares, float* peak)
+    {
+       #if JUCE_USE_SIMD
+        if (Register::size() == numLanes)
+        {
+            processRegisters(samples, numSamples, sumOfSquares, peak);
+            return;
+        }
+       #endif
+
+        for (int lane = 0; lane < numLanes; ++lane)
+        {
+            sumOfSquares[lane] = 0;
+            peak[lane] = 0;
+        }
+        for (int i = 0; i < numSamples; ++i)
+        {
+            for (int lane = 0; lane < numLanes; ++lane)
+            {
+                float value = samples[i];
+                for (int stage = 0; stage < numStages; ++stage)
+                {
+                    const float out = coefficients[0][lane] * value + state[stage][0][lane];
+                    state[stage][0][lane] = coefficients[1][lane] * value - coefficients[3][lane] * out + state[stage][1][lane];
+                    state[stage][1][lane] = coefficients[2][lane] * value - coefficients[4][lane] * out;
+                    value = out;
+                }
+                sumOfSquares[lane] += value * value;
+                peak[lane] = juce::jmax(peak[lane], std::abs(value));
+            }
+        }
+    }
+
+private:
+    static constexpr int numStages = 2;
+
+    alignas(16) float coefficients[5][numLanes] = {};
+    alignas(16) float state[numStages][2][numLanes] = {};
+
+   #if JUCE_USE_SIMD
+    using Register = juce::dsp::SIMDRegister<float>;
+
+    void processRegisters(const float* samples, int numSamples, float* sumOfSquares, float* peak)
+    {
+        const auto b0 = Register::fromRawArray(coefficients[0]);
+        const auto b1 = Register::fromRawArray(coefficients[1]);
+        const auto b2 = Register::fromRawArray(coefficients[2]);
+        const auto a1 = Register::fromRawArray(coefficients[3]);
+        const auto a2 = Register::fromRawArray(coefficients[4]);
+
+        Register z1[numStages], z2[numStages];
+        for (int stage = 0; stage < numStages; ++stage)
+        {
+            z1[stage] = Register::fromRawArray(state[stage][0]);
+            z2[stage] = Register::fromRawArray(state[stage][1]);
+        }
+
+        const auto zero = Register::expand(0.0f);
+        auto squares = zero;
+        auto largest = zero;
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto value = Register::expand(samples[i]);
+            for (int stage = 0; stage < numStages; ++stage)
+            {
+                const auto out = b0 * value + z1[stage];
+                z1[stage] = b1 * value - a1 * out + z2[stage];
+                z2[stage] = b2 * value - a2 * out;
+                value = out;
+            }
+            squares += value * value;
+            largest = Register::max(largest, Register::max(value, zero - value));
+        }
+
+        for (int stage = 0; stage < numStages; ++stage)
+        {
+            z1[stage].copyToRawArray(state[stage][0]);
+            z2[stage].copyToRawArray(state[stage][1]);
+        }
+        squares.copyToRawArray(sumOfSquares);
+        largest.copyToRawArray(peak);
+    }
+   #endif
+};
+
+
+bool SpectralWaveform::analyse(juce::AudioFormatReader& reader, const std::function<bool()>& shouldStop)
+{
+    if (reader.sampleRate <= 0 || reader.lengthInSamples <= 0)
+    {
+        return false;
+    }
+
+    const int samplesPerColumn = juce::jmax(1, juce::roundToInt(reader.sampleRate / columnsPerSecond));
+    const int numColumns = (int)((reader.lengthInSamples + samplesPerColumn - 1) / samplesPerColumn);
+
+    // band levels stay as floats until the loudest column of each band is known
+    std::vector<float> bandLevels((size_t)numColumns * 3);
+    std::vector<float> peaks((size_t)numColumns);
+
+    BandFilterBank filterBank(reader.sampleRate);
+    juce::AudioBuffer<float> block(2, samplesPerColumn * columnsPerRead);
+
+    alignas(16) float sumOfSquares[BandFilterBank::numLanes];
+    alignas(16) float peak[BandFilterBank::numLanes];
+
+    for (int column = 0; column < numColumns; column += columnsPerRead)
+    {
+        if (shouldStop())
+        {
+            return false;
+        }
+
+        const juce::int64 start = (juce::int64)column * samplesPerColumn;
+        const int numSamples = (int)juce::jmin((juce::int64)block.getNumSamples(), reader.lengthInSamples - start);
+        reader.read(&block, 0, numSamples, start, true, true);
+
+        // mono; the bands only need to know what's there, not where
+        block.addFrom(0, 0, block, 1, 0, numSamples);
+        block.applyGain(0, 0, numSamples, 0.5f);
+
+        const float* mono = block.getReadPointer(0);
+        for (int i = column; i < juce::jmin(numColumns, column + columnsPerRead); ++i)
+        {
+            const int offset = (i - column) * samplesPerColumn;
+            const int count = juce::jmin(samplesPerColumn, numSamples - offset);
+            filterBank.process(mono + offset, count, sumOfSquares, peak);
+
+            for (int band = 0; band < 3; ++band)
+            {
+                bandLevels[(size_t)i * 3 + band] = std::sqrt(sumOfSquares[band] / count);
+            }
+            peaks[(size_t)i] = peak[BandFilterBank::fullLane];
+        }
+    }
+
+    float loudest[3] = {};
+    for (int i = 0; i < numColumns; ++i)
+    {
+        for (int band = 0; band < 3; ++band)
+        {
+            loudest[band] = juce::jmax(loudest[band], bandLevels[(size_t)i * 3 + band]);
+        }
+    }
+
+    auto toByte = [](float proportion) { return (juce::uint8)juce::jlimit(0, 255, juce::roundToInt(proportion * 255.0f)); };
+
+    columns.resize((size_t)numColumns);
+    for (int i = 0; i < numColumns; ++i)
+    {
+        auto& c = columns[(size_t)i];
+        c.peak = toByte(peaks[(size_t)i]);
+        c.low = toByte(loudest[0] > 0 ? bandLevels[(size_t)i * 3] / loudest[0] : 0);
+        c.mid = toByte(loudest[1] > 0 ? bandLevels[(size_t)i * 3 + 1] / loudest[1] : 0);
+        c.high = toByte(loudest[2] > 0 ? bandLevels[(size_t)i * 3 + 2] / loudest[2] : 0);
+    }
+    lengthInSeconds = reader.lengthInSamples / reader.sampleRate;
+    findBeat(bandLevels, samplesPerColumn / reader.sampleRate);
+    return true;
+}
+
+void SpectralWaveform::findBeat(const std::vector<float>& bandLevels, double secondsPerColumn)
+{
+    beatsPerMinute = 0;
+    firstBeatSeconds = 0;
+
+    // attacks: how much the low and mid bands rose into each column
+    const int numColumns = (int)(bandLevels.size() / 3);
+    std::vector<float> attacks((size_t)numColumns, 0.0f);
+    for (int i = 1; i < numColumns; ++i)
+    {
+        const float low = bandLevels[(size_t)i * 3] - bandLevels[(size_t)(i - 1) * 3];
+        const float mid = bandLevels[(size_t)i * 3 + 1] - bandLevels[(size_t)(i - 1) * 3 + 1];
+        attacks[(size_t)i] = juce::jmax(0.0f, low) + 0.5f * juce::jmax(0.0f, mid);
+    }
+
+    const int minLag = (int)std::floor(60.0 / maxBeatsPerMinute / secondsPerColumn);
+    const int maxLag = (int)std::ceil(60.0 / minBeatsPerMinute / secondsPerColumn);
+    if (numColumns < maxLag * 8)
+    {
+        return;
+    }
+
+    // the tempo: the beat period whose attacks repeat the most, against the average over all periods
+    double bestCorrelation = 0;
+    double totalCorrelation = 0;
+    int bestLag = 0;
+    for (int lag = minLag; lag <= maxLag; ++lag)
+    {
+        double correlation = 0;
+        for (int i = lag; i < numColumns; ++i)
+        {
+            correlation += attacks[(size_t)i] * attacks[(size_t)(i - lag)];
+        }
+        totalCorrelation += correlation;
+        if (correlation > bestCorrelation)
+        {
+            bestCorrelation = correlation;
+            bestLag = lag;
+        }
+    }
+    if (bestLag == 0 || bestCorrelation < minBeatStrength * totalCorrelation / (maxLag - minLag + 1))
+    {
+        return;
+    }
+
+    // a column is too coarse to hold a beat over a whole mix, so the period and phase are
+    // refined together: whichever grid lands on the most attack over the whole track
+    auto attackAt = [&attacks, numColumns](double column)
+    {
+        const int whole = (int)column;
+        if (whole < 0 || whole + 1 >= numColumns)
+        {
+            return 0.0f;
+        }
+        const float fraction = (float)(column - whole);
+        return attacks[(size_t)whole] * (1.0f - fraction) + attacks[(size_t)whole + 1] * fraction;
+    };
+
+    double bestScore = -1;
+    double bestPeriod = bestLag;
+    double bestPhase = 0;
+    for (double period = bestLag - 1.0; period <= bestLag + 1.0; period += 0.02)
+    {
+        for (double phase = 0; phase < period; phase += 0.5)
+        {
+            double score = 0;
+            for (double column = phase; column < numColumns; column += period)
+            {
+                score += attackAt(column);
+            }
+            if (score > bestScore)
+            {
+                bestScore = score;
+                bestPeriod = period;
+                bestPhase = phase;
+            }
+        }
+    }
+
+    beatsPerMinute = 60.0 / (bestPeriod * secondsPerColumn);
+    firstBeatSeconds = bestPhase * secondsPerColumn;
+}
+
+int SpectralWaveform::getNumColumns() const
+{
+    return (int)columns.size();
+}
+
+const SpectralWaveform::Column& SpectralWaveform::getColumn(int index) const
+{
+    return columns[(size_t)index];
+}
+
+double SpectralWaveform::getLengthInSeconds() const
+{
+    return lengthInSeconds;
+}
+
+double SpectralWaveform::getBeatsPerMinute() const
+{
+    return beatsPerMinute;
+}
+
+double SpectralWaveform::getFirstBeatSeconds() const
+{
+    return firstBeatSeconds;
+}
+
+double SpectralWaveform::getNextBeat(double seconds) const
+{
+    if (beatsPerMinute <= 0)
+    {
+        return seconds;
+    }
+    const double beatSeconds = 60.0 / beatsPerMinute;
+    return firstBeatSeconds + juce::jmax(0.0, std::ceil((seconds - firstBeatSeconds) / beatSeconds - 1.0e-9)) * beatSeconds;
+}
+
+void SpectralWaveform::draw(juce::Graphics& g, juce::Rectangle<int> area, double startSecs, double endSecs) const
+{
+    if (columns.empty() || area.isEmpty() || endSecs <= startSecs)
+    {
+        return;
+    }
+
+    const double columnsPerPixel = (endSecs - startSecs) * columnsPerSecond / area.getWidth();
+    const float centre = (float)area.getCentreY();
+    const float halfHeight = area.getHeight() * 0.5f;
+
+    for (int x = 0; x < area.getWidth(); ++x)
+    {
+        // the loudest of the columns under this pixel
+        const int first = (int)std::floor(startSecs * columnsPerSecond + x * columnsPerPixel);
+        const int last = juce::jmax(first + 1, (int)std::floor(startSecs * columnsPerSecond + (x + 1) * columnsPerPixel));
+        if (last <= 0)
+        {
+            continue;
+        }
+        if (first >= (int)columns.size())
+        {
+            break;
+        }
+
+        Column c;
+        for (int i = juce::jmax(0, first); i < juce::jmin(last, (int)columns.size()); ++i)
+        {
+            c.peak = juce::jmax(c.peak, columns[(size_t)i].peak);
+            c.low = juce::jmax(c.low, columns[(size_t)i].low);
+            c.mid = juce::jmax(c.mid, columns[(size_t)i].mid);
+            c.high = juce::jmax(c.high, columns[(size_t)i].high);
+        }
+        if (c.peak == 0)
+        {
+            continue;
+        }
+
+        // the hue says which bands dominate, the brightness how loud they are
+        const float strongest = juce::jmax(1, (int)c.low, (int)c.mid, (int)c.high) / 255.0f;
+        const auto colour = juce::Colour::fromFloatRGBA(c.low / 255.0f / strongest, c.mid / 255.0f / strongest,
+            c.high / 255.0f / strongest, 1.0f).withMultipliedBrightness(0.4f + 0.6f * strongest);
+
+        const float height = halfHeight * c.peak / 255.0f;
+        g.setColour(colour);
+        g.drawVerticalLine(area.getX() + x, centre - height, centre + height);
+    }
+}
+
+
+std::shared_ptr<const SpectralWaveform> SpectralWaveform::loadOrAnalyse(const juce::File& track,
+    juce::AudioFormatManager& formatManager, const std::function<bool()>& shouldStop)
+{
+    const auto analysisFile = getAnalysisFileFor(track);
+    if (auto saved = load(analysisFile, track))
+    {
+        return saved;
+    }
+
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(track));
+    if (reader == nullptr)
+    {
+        return nullptr;
+    }
+
+    auto waveform = std::make_shared<SpectralWaveform>();
+    if (!waveform->analyse(*reader, shouldStop))
+    {
+        return nullptr;
+    }
+    if (!waveform->save(analysisFile, track))
+    {
+        DBG("Can't save the waveform analysis for " << track.getFullPathName());
+    }
+    return waveform;
+}
+
+std::unique_ptr<SpectralWaveform> SpectralWaveform::load(const juce::File& analysisFile, const juce::File& track)
+{
+    // the whole analysis in one read
+    juce::MemoryBlock data;
+    if (!analysisFile.existsAsFile() || !analysisFile.loadFileAsData(data))
+    {
+        return nullptr;
+    }
+
+    juce::MemoryInputStream input(data, false);
+    if (input.readInt() != analysisMagic || input.readInt() != analysisVersion
+        || input.readInt64() != track.getSize()
+        || input.readInt64() != track.getLastModificationTime().toMilliseconds())
+    {
+        return nullptr;
+    }
+
+    std::unique_ptr<SpectralWaveform> waveform(new SpectralWaveform());
+    waveform->lengthInSeconds = input.readDouble();
+    waveform->beatsPerMinute = input.readDouble();
+    waveform->firstBeatSeconds = input.readDouble();
+    const int numColumns = input.readInt();
+
+    if (waveform->lengthInSeconds <= 0 || numColumns <= 0
+        || input.getNumBytesRemaining() != (juce::int64)numColumns * 4)
+    {
+        return nullptr;
+    }
+
+    waveform->columns.resize((size_t)numColumns);
+    for (auto& column : waveform->columns)
+    {
+        column.peak = (juce::uint8)input.readByte();
+        column.low = (juce::uint8)input.readByte();
+        column.mid = (juce::uint8)input.readByte();
+        column.high = (juce::uint8)input.readByte();
+    }
+    return waveform;
+}
+
+bool SpectralWaveform::save(const juce::File& analysisFile, const juce::File& track) const
+{
+    if (!analysisFile.getParentDirectory().createDirectory())
+    {
+        return false;
+    }
+
+    // written aside and moved into place, so a half written analysis is never read
+    juce::TemporaryFile temporary(analysisFile);
+    {
+        juce::FileOutputStream output(temporary.getFile());
+        if (!output.openedOk())
+        {
+            return false;
+        }
+
+        output.writeInt(analysisMagic);
+        output.writeInt(analysisVersion);
+        output.writeInt64(track.getSize());
+        output.writeInt64(track.getLastModificationTime().toMilliseconds());
+        output.writeDouble(lengthInSeconds);
+        output.writeDouble(beatsPerMinute);
+        output.writeDouble(firstBeatSeconds);
+        output.writeInt((int)columns.size());
+        for (const auto& column : columns)
+        {
+            const juce::uint8 bytes[] = { column.peak, column.low, column.mid, column.high };
+            output.write(bytes, sizeof(bytes));
+        }
+        output.flush();
+        if (output.getStatus().failed())
+        {
+            return false;
+        }
+    }
+    return temporary.overwriteTargetFileWithTemporary();
+}
+
+juce::File SpectralWaveform::getAnalysisFileFor(const juce::File& track)
+{
+    const auto name = juce::String::toHexString(track.getFullPathName().hashCode64());
+    return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+        .getChildFile("DJApp").getChildFile("Waveforms").getChildFile(name + ".wave");
+}
+
+
+SpectralWaveformCache::SpectralWaveformCache()
+{
+}
+
+SpectralWaveformCache::~SpectralWaveformCache()
+{
+    // the analyses use the callers' format managers, so they mustn't outlive the cache
+    for (const auto& waiting : pending)
+    {
+        scheduler->cancel(getGroup(waiting.first), 5000);
+    }
+}
+
+void SpectralWaveformCache::request(const juce::File& file, juce::AudioFormatManager& formatManager, Callback onReady,
+    TaskScheduler::Priority priority)
+{
+    const auto key = getKey(file);
+    auto found = cache.find(key);
+    if (found != cache.end())
+    {
+        recentlyUsed.removeString(key);
+        recentlyUsed.add(key);
+        onReady(found->second);
+        return;
+    }
+
+    // several displays asking for the same track share one analysis
+    auto& waiting = pending[key];
+    waiting.push_back(std::move(onReady));
+    if (waiting.size() == 1)
+    {
+        startAnalysis(file, key, formatManager, priority);
+    }
+    else
+    {
+        scheduler->raisePriority(getGroup(key), priority);
+    }
+}
+
+void SpectralWaveformCache::startAnalysis(const juce::File& file, const juce::String& key,
+    juce::AudioFormatManager& formatManager, TaskScheduler::Priority priority)
+{
+    juce::WeakReference<SpectralWaveformCache> owner(this);
+    scheduler->submit(priority, getGroup(key),
+        [owner, file, key, &formatManager](const std::function<bool()>& shouldCancel)
+        {
+            auto waveform = SpectralWaveform::loadOrAnalyse(file, formatManager, shouldCancel);
+
+            if (shouldCancel())
+            {
+                return;
+            }
+
+            // hand the result over on the message thread, if the cache is still there to take it
+            juce::MessageManager::callAsync([owner, key, waveform]
+            {
+                if (owner != nullptr)
+                {
+                    owner->finished(key, waveform);
+                }
+            });
+        });
+}
+
+void SpectralWaveformCache::finished(const juce::String& key, std::shared_ptr<const SpectralWaveform> waveform)
+{
+    if (waveform != nullptr)
+    {
+        cache[key] = waveform;
+        recentlyUsed.removeString(key);
+        recentlyUsed.add(key);
+
+        while (recentlyUsed.size() > maxCachedTracks)
+        {
+            cache.erase(recentlyUsed[0]);
+            recentlyUsed.remove(0);
+        }
+    }
+
+    auto callbacks = std::move(pending[key]);
+    pending.erase(key);
+    for (auto& callback : callbacks)
+    {
+        callback(waveform);
+    }
+}
+
+juce::String SpectralWaveformCache::getKey(const juce::File& file)
+{
+    return file.getFullPathName() + "|" + juce::String(file.getLastModificationTime().toMilliseconds())
+        + "|" + juce::String(file.getSize());
+}
+
+juce::String SpectralWaveformCache::getGroup(const juce::String& key)
+{
+    return "waveform|" + key;
+}
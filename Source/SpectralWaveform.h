@@ -0,0 +1,192 @@
+/*
+  ==============================================================================
+
+    SpectralWaveform.h
+    Created: 19 Oct 2026 8:52:34pm
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+#include "TaskScheduler.h"
+
+
+/**
+ * Overview of a whole track for the colour waveform: per column, the peak and how much
+ * of the sound is in the low, mid and high bands, each squeezed into a byte.
+ *
+ * The bands come from one pass over the decoded file through a bank of filters that
+ * runs all the bands side by side in one SIMD register. The same pass finds the beat:
+ * the tempo from how the low and mid bands' attacks repeat, and the phase from where
+ * they line up best.
+ *
+ * Analyses are saved in the app's data folder, so a track is only analysed once, whether
+ * it was loaded on a deck or analysed ahead of time from the command line.
+ */
+class SpectralWaveform
+{
+public:
+    /** One slice of the track */
+    struct Column
+    {
+        juce::uint8 peak = 0;  // 0 to 255 for silence to full scale
+        juce::uint8 low = 0;   // band levels, 255 being the loudest that band gets in the track
+        juce::uint8 mid = 0;
+        juce::uint8 high = 0;
+    };
+
+    static constexpr int columnsPerSecond = 150;
+
+    /**
+     * Decodes and analyses a whole file. Called on a background thread.
+     *
+     * @param reader: the file to analyse
+     * @param shouldStop: polled between blocks; returning true abandons the analysis
+     * @returns: false if the analysis was abandoned or the file is empty
+     */
+    bool analyse(juce::AudioFormatReader& reader, const std::function<bool()>& shouldStop);
+
+    /**
+     * Reads the analysis saved for a track, or analyses the track and saves it. Called on
+     * a background thread.
+     *
+     * @param track: the track
+     * @param formatManager: to open the track with
+     * @param shouldStop: polled while analysing; returning true abandons the analysis
+     * @returns: the analysis, or nullptr if the file can't be read or the analysis was abandoned
+     */
+    static std::shared_ptr<const SpectralWaveform> loadOrAnalyse(const juce::File& track,
+        juce::AudioFormatManager& formatManager, const std::function<bool()>& shouldStop);
+
+    /**
+     * Reads a saved analysis.
+     *
+     * @param analysisFile: where it was saved
+     * @param track: the file it's for; an analysis saved before the file changed is ignored
+     * @returns: the analysis, or nullptr if there isn't a valid one
+     */
+    static std::unique_ptr<SpectralWaveform> load(const juce::File& analysisFile, const juce::File& track);
+
+    /**
+     * Saves the analysis.
+     *
+     * @param analysisFile: where to save it
+     * @param track: the file it's for
+     * @returns: false if it couldn't be written
+     */
+    bool save(const juce::File& analysisFile, const juce::File& track) const;
+
+    /** @returns: where a track's analysis is kept */
+    static juce::File getAnalysisFileFor(const juce::File& track);
+
+    /** @returns: number of columns across the track */
+    int getNumColumns() const;
+
+    /** @returns: one column, see columnsPerSecond */
+    const Column& getColumn(int index) const;
+
+    /** @returns: the length of the analysed track */
+    double getLengthInSeconds() const;
+
+    /** @returns: the track's tempo, or 0 if it has no steady beat */
+    double getBeatsPerMinute() const;
+
+    /** @returns: the time of the first beat, within one beat of the start */
+    double getFirstBeatSeconds() const;
+
+    /**
+     * @param seconds: a time in the track
+     * @returns: the time of the first beat at or after it, or the time itself without a beat
+     */
+    double getNextBeat(double seconds) const;
+
+    /**
+     * Draws part of the track as a colour waveform, one vertical line per pixel column:
+     * red for lows, green for mids and blue for highs.
+     *
+     * @param g: the graphics context to draw with
+     * @param area: where to draw
+     * @param startSecs: time at the left edge
+     * @param endSecs: time at the right edge
+     */
+    void draw(juce::Graphics& g, juce::Rectangle<int> area, double startSecs, double endSecs) const;
+
+private:
+    std::vector<Column> columns;
+    double lengthInSeconds = 0;
+    double beatsPerMinute = 0;
+    double firstBeatSeconds = 0;
+
+    /**
+     * Finds the tempo and phase from the attacks in the band levels.
+     *
+     * @param bandLevels: low, mid and high levels per column
+     * @param secondsPerColumn: the length of a column
+     */
+    void findBeat(const std::vector<float>& bandLevels, double secondsPerColumn);
+};
+
+
+/**
+ * Analyses tracks into SpectralWaveforms on the shared TaskScheduler, or reads their saved
+ * analyses there, and keeps the most recent ones, so loading a track on the other deck or
+ * loading it again is instant. Shared by the decks through a juce::SharedResourcePointer.
+ */
+class SpectralWaveformCache
+{
+public:
+    using Callback = std::function<void(std::shared_ptr<const SpectralWaveform>)>;
+
+    /** Constructor */
+    SpectralWaveformCache();
+
+    /** Destructor. Abandons any analysis still running. */
+    ~SpectralWaveformCache();
+
+    /**
+     * Gets the waveform of a file, from the cache or by analysing it in the background.
+     * Message thread only.
+     *
+     * @param file: the track
+     * @param formatManager: to open the file with; must outlive the analysis
+     * @param onReady: called on the message thread with the result, or nullptr if the
+     *                 file can't be read
+     * @param priority: how urgently it's needed; asking again more urgently hurries along
+     *                  an analysis already waiting
+     */
+    void request(const juce::File& file, juce::AudioFormatManager& formatManager, Callback onReady,
+        TaskScheduler::Priority priority = TaskScheduler::deckLoadPriority);
+
+private:
+    static constexpr int maxCachedTracks = 16;
+
+    juce::SharedResourcePointer<TaskScheduler> scheduler;
+    std::map<juce::String, std::shared_ptr<const SpectralWaveform>> cache;
+    juce::StringArray recentlyUsed; // cache keys, oldest first
+    std::map<juce::String, std::vector<Callback>> pending; // callbacks waiting on an analysis
+
+    /**
+     * Caches a finished analysis, dropping the least recently used one if the cache is full,
+     * and passes it to everyone waiting for it.
+     */
+    void finished(const juce::String& key, std::shared_ptr<const SpectralWaveform> waveform);
+
+    /** Decodes and analyses a file on the scheduler, then hands it to finished() */
+    void startAnalysis(const juce::File& file, const juce::String& key, juce::AudioFormatManager& formatManager,
+        TaskScheduler::Priority priority);
+
+    /** @returns: what a file is cached under; a changed file gets a new key */
+    static juce::String getKey(const juce::File& file);
+
+    /** @returns: the scheduler group a file's analysis runs in */
+    static juce::String getGroup(const juce::String& key);
+
+    JUCE_DECLARE_WEAK_REFERENCEABLE(SpectralWaveformCache)
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectralWaveformCache)
+};
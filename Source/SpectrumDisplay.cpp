@@ -0,0 +1,78 @@
+/*
+  ==============================================================================
+
+    SpectrumDisplay.cpp
+    Created: 19 Oct 2026 8:18:47pm
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#include "SpectrumDisplay.h"
+
+
+SpectrumDisplay::SpectrumDisplay(AudioMeter& _meter)
+    : meter(_meter)
+{
+    setInterceptsMouseClicks(false, false);
+}
+
+void SpectrumDisplay::paint(juce::Graphics& g)
+{
+    g.setColour(juce::Colours::black.withAlpha(0.35f));
+    g.fillRect(getLocalBounds());
+
+    g.setColour(juce::Colours::coral.withAlpha(0.5f));
+    g.fillPath(spectrumPath);
+    g.setColour(juce::Colours::coral);
+    g.strokePath(spectrumPath, juce::PathStrokeType(1.0f));
+}
+
+void SpectrumDisplay::resized()
+{
+    rebuildPath();
+}
+
+void SpectrumDisplay::update()
+{
+    if (isVisible() && meter.updateSpectrum())
+    {
+        rebuildPath();
+        repaint();
+    }
+}
+
+void SpectrumDisplay::rebuildPath()
+{
+    spectrumPath.clear();
+
+    const auto& spectrum = meter.getSpectrum();
+    const float width = (float)getWidth();
+    const float height = (float)getHeight();
+    if (spectrum.sampleRate <= 0 || width <= 0 || height <= 0)
+    {
+        return;
+    }
+
+    const float binWidth = (float)(spectrum.sampleRate / AudioMeter::fftSize);
+    const float logRange = std::log(highestFrequency / lowestFrequency);
+
+    // one point per pixel column, taking the loudest bin that falls in it
+    spectrumPath.startNewSubPath(0, height);
+    int bin = juce::jmax(1, (int)(lowestFrequency / binWidth));
+    for (int x = 0; x < (int)width && bin < AudioMeter::numSpectrumBins; ++x)
+    {
+        const float columnEnd = lowestFrequency * std::exp(logRange * (x + 1) / width);
+        float decibels = spectrum.decibels[bin];
+        while (bin < AudioMeter::numSpectrumBins && bin * binWidth < columnEnd)
+        {
+            decibels = juce::jmax(decibels, spectrum.decibels[bin]);
+            ++bin;
+        }
+
+        const float y = juce::jmap(juce::jlimit(minimumDb, maximumDb, decibels), minimumDb, maximumDb, height, 0.0f);
+        spectrumPath.lineTo((float)x, y);
+    }
+    spectrumPath.lineTo(width, height);
+    spectrumPath.closeSubPath();
+}
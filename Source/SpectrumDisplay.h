@@ -0,0 +1,59 @@
+/*
+  ==============================================================================
+
+    SpectrumDisplay.h
+    Created: 19 Oct 2026 8:18:47pm
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include "AudioMeter.h"
+
+
+/**
+ * Draws an AudioMeter's spectrum on a log frequency scale, see-through so it can sit on
+ * top of other components. Rebuilt in step with the display whenever the meter has
+ * published a new frame, and only while it is visible.
+ */
+class SpectrumDisplay : public juce::Component
+{
+public:
+    /**
+     * Constructor
+     *
+     * @param _meter: the meter to show; this component is its only spectrum reader
+     */
+    SpectrumDisplay(AudioMeter& _meter);
+
+    /**
+     * Draws the last spectrum path.
+     *
+     * @param g: the graphics context to draw with
+     */
+    void paint(juce::Graphics& g) override;
+
+    /** Rebuilds the path for the new size. */
+    void resized() override;
+
+private:
+    // axes
+    static constexpr float lowestFrequency = 20.0f;
+    static constexpr float highestFrequency = 20000.0f;
+    static constexpr float minimumDb = -90.0f;
+    static constexpr float maximumDb = 0.0f;
+
+    AudioMeter& meter;
+    juce::Path spectrumPath;
+    juce::VBlankAttachment vBlank{ this, [this] { update(); } };
+
+    /** Picks up a new spectrum, if there is one, and repaints */
+    void update();
+
+    /** Turns the current spectrum into a closed path across the component */
+    void rebuildPath();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectrumDisplay)
+};
@@ -0,0 +1,49 @@
+/*
+  ==============================================================================
+
+    StartupTrace.cpp
+    Created: 19 Oct 2026 9:58:41pm
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#include "StartupTrace.h"
+
+
+StartupTrace::StartupTrace(const juce::String& _name)
+    : name(_name),
+      startMs(juce::Time::getMillisecondCounterHiRes()),
+      lastMarkMs(startMs)
+{
+}
+
+void StartupTrace::mark(const juce::String& step)
+{
+    if (finished)
+    {
+        return;
+    }
+
+    const double nowMs = juce::Time::getMillisecondCounterHiRes();
+    steps.add(juce::String(nowMs - lastMarkMs, 1).paddedLeft(' ', 8) + " ms  " + step);
+    lastMarkMs = nowMs;
+}
+
+void StartupTrace::finish()
+{
+    if (finished)
+    {
+        return;
+    }
+    finished = true;
+
+    juce::String trace;
+    trace << name << " constructed in "
+          << juce::String(juce::Time::getMillisecondCounterHiRes() - startMs, 1) << " ms" << juce::newLine;
+    for (const auto& step : steps)
+    {
+        trace << step << juce::newLine;
+    }
+    juce::Logger::writeToLog(trace.trimEnd());
+}
@@ -0,0 +1,50 @@
+/*
+  ==============================================================================
+
+    StartupTrace.h
+    Created: 19 Oct 2026 9:58:41pm
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+
+/**
+ * Times the steps of building something slow to construct, such as the main component,
+ * and writes them to the log in one go when it's done.
+ *
+ * Declared as the first member of the class it times, it starts the clock before any
+ * other member is constructed.
+ */
+class StartupTrace
+{
+public:
+    /**
+     * Constructor. Starts the clock.
+     *
+     * @param _name: what is being timed, for the log
+     */
+    StartupTrace(const juce::String& _name);
+
+    /**
+     * Ends a step.
+     *
+     * @param step: what happened since the previous mark
+     */
+    void mark(const juce::String& step);
+
+    /** Writes the steps and the total to the log. Later marks are ignored. */
+    void finish();
+
+private:
+    juce::String name;
+    double startMs;
+    double lastMarkMs;
+    juce::StringArray steps;
+    bool finished = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(StartupTrace)
+};
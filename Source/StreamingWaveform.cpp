@@ -0,0 +1,151 @@
+/*
+  ==============================================================================
+
+    StreamingWaveform.cpp
+    Created: 20 Oct 2026 1:31:06am
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#include "StreamingWaveform.h"
+
+
+// whole peaks fit in a chunk, so no peak is split between two
+static_assert(StreamingWaveform::chunkSamples % StreamingWaveform::samplesPerPeak == 0,
+    "chunks must hold whole peaks");
+static const int peaksPerChunk = StreamingWaveform::chunkSamples / StreamingWaveform::samplesPerPeak;
+
+
+StreamingWaveform::StreamingWaveform()
+{
+}
+
+bool StreamingWaveform::decode(juce::AudioFormatReader& reader, const std::function<bool()>& shouldStop,
+    const std::function<void(juce::Range<double> seconds)>& onChunkDone)
+{
+    if (reader.sampleRate <= 0 || reader.lengthInSamples <= 0 || reader.numChannels <= 0)
+    {
+        return false;
+    }
+
+    sampleRate = reader.sampleRate;
+    lengthInSamples = reader.lengthInSamples;
+    numChunks = (int)((lengthInSamples + chunkSamples - 1) / chunkSamples);
+    peaks.resize((size_t)numChunks * peaksPerChunk);
+    chunksDone.reset(new std::atomic<bool>[(size_t)numChunks]);
+    for (int chunk = 0; chunk < numChunks; ++chunk)
+    {
+        chunksDone[(size_t)chunk] = false;
+    }
+    prepared = true;
+
+    juce::AudioBuffer<float> buffer((int)juce::jmin(reader.numChannels, 2u), chunkSamples);
+    for (int chunk = getNextChunk(); chunk != -1; chunk = getNextChunk())
+    {
+        if (shouldStop() || !decodeChunk(reader, buffer, chunk))
+        {
+            return false;
+        }
+        chunksDone[(size_t)chunk].store(true, std::memory_order_release);
+        ++numChunksDone;
+
+        const auto start = (juce::int64)chunk * chunkSamples;
+        onChunkDone({ start / sampleRate, juce::jmin(start + chunkSamples, lengthInSamples) / sampleRate });
+    }
+    return true;
+}
+
+void StreamingWaveform::setFocus(double seconds)
+{
+    focusSeconds = seconds;
+}
+
+bool StreamingWaveform::isPrepared() const
+{
+    return prepared.load(std::memory_order_acquire);
+}
+
+bool StreamingWaveform::isComplete() const
+{
+    return isPrepared() && numChunksDone == numChunks;
+}
+
+double StreamingWaveform::getLengthInSeconds() const
+{
+    return isPrepared() ? lengthInSamples / sampleRate : 0.0;
+}
+
+void StreamingWaveform::draw(juce::Graphics& g, juce::Rectangle<int> area, juce::Range<int> columns) const
+{
+    if (!isPrepared() || area.isEmpty())
+    {
+        return;
+    }
+
+    const double peaksPerColumn = (double)lengthInSamples / samplesPerPeak / area.getWidth();
+    const float halfHeight = area.getHeight() * 0.5f;
+    const float centre = area.getY() + halfHeight;
+    columns = columns.getIntersectionWith({ 0, area.getWidth() });
+
+    for (int x = columns.getStart(); x < columns.getEnd(); ++x)
+    {
+        const int firstPeak = (int)(x * peaksPerColumn);
+        const int endPeak = juce::jmax(firstPeak + 1, (int)((x + 1) * peaksPerColumn));
+        float low = 1.0f, high = -1.0f;
+        for (int peak = firstPeak; peak < endPeak && peak < (int)peaks.size(); ++peak)
+        {
+            if (chunksDone[(size_t)(peak / peaksPerChunk)].load(std::memory_order_acquire))
+            {
+                low = juce::jmin(low, peaks[(size_t)peak].min);
+                high = juce::jmax(high, peaks[(size_t)peak].max);
+            }
+        }
+
+        if (high >= low)
+        {
+            const float top = centre - juce::jlimit(-1.0f, 1.0f, high) * halfHeight;
+            const float bottom = centre - juce::jlimit(-1.0f, 1.0f, low) * halfHeight;
+            g.fillRect((float)(area.getX() + x), top, 1.0f, juce::jmax(1.0f, bottom - top));
+        }
+    }
+}
+
+int StreamingWaveform::getNextChunk() const
+{
+    const int focus = juce::jlimit(0, numChunks - 1, (int)(focusSeconds.load() * sampleRate / chunkSamples));
+    for (int distance = 0; distance < numChunks; ++distance)
+    {
+        for (int chunk : { focus + distance, focus - distance })
+        {
+            if (chunk >= 0 && chunk < numChunks && !chunksDone[(size_t)chunk].load(std::memory_order_relaxed))
+            {
+                return chunk;
+            }
+        }
+    }
+    return -1;
+}
+
+bool StreamingWaveform::decodeChunk(juce::AudioFormatReader& reader, juce::AudioBuffer<float>& buffer, int chunk)
+{
+    const auto start = (juce::int64)chunk * chunkSamples;
+    const int numSamples = (int)juce::jmin((juce::int64)chunkSamples, lengthInSamples - start);
+    if (!reader.read(&buffer, 0, numSamples, start, true, buffer.getNumChannels() > 1))
+    {
+        return false;
+    }
+
+    Peak* chunkPeaks = peaks.data() + (size_t)chunk * peaksPerChunk;
+    for (int offset = 0, peak = 0; offset < numSamples; offset += samplesPerPeak, ++peak)
+    {
+        const int length = juce::jmin(samplesPerPeak, numSamples - offset);
+        auto range = juce::FloatVectorOperations::findMinAndMax(buffer.getReadPointer(0, offset), length);
+        for (int channel = 1; channel < buffer.getNumChannels(); ++channel)
+        {
+            range = range.getUnionWith(juce::FloatVectorOperations::findMinAndMax(buffer.getReadPointer(channel, offset), length));
+        }
+        chunkPeaks[peak] = { range.getStart(), range.getEnd() };
+    }
+    return true;
+}
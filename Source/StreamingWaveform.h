@@ -0,0 +1,106 @@
+/*
+  ==============================================================================
+
+    StreamingWaveform.h
+    Created: 20 Oct 2026 1:31:06am
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+
+/**
+ * Peaks of a whole track for the overview, filled in chunk by chunk while it decodes,
+ * so it can be drawn long before the whole file is.
+ *
+ * The track is decoded in chunks of chunkSamples on a background thread. The chunk
+ * holding the focus, where the deck is cued, goes first; after each chunk comes the
+ * one nearest the focus that isn't done, looking ahead before behind, so moving the
+ * focus moves the decoding with it. A chunk's peaks are all written before it's marked
+ * done, so the message thread can draw every chunk marked done while the rest decode.
+ */
+class StreamingWaveform
+{
+public:
+    /** Lowest and highest sample over samplesPerPeak samples, across the channels */
+    struct Peak
+    {
+        float min = 0;
+        float max = 0;
+    };
+
+    static constexpr int samplesPerPeak = 256;
+    static constexpr int chunkSamples = 1 << 16;   // about a second and a half
+
+    /** Constructor */
+    StreamingWaveform();
+
+    /**
+     * Decodes the whole file, chunk by chunk. Called on a background thread.
+     *
+     * @param reader: the file to decode
+     * @param shouldStop: polled between chunks; returning true abandons the decoding
+     * @param onChunkDone: called on the same thread after each chunk with the time range it covers
+     * @returns: false if the decoding was abandoned or the file is empty
+     */
+    bool decode(juce::AudioFormatReader& reader, const std::function<bool()>& shouldStop,
+        const std::function<void(juce::Range<double> seconds)>& onChunkDone);
+
+    /**
+     * Moves where the decoding carries on from. Safe to call from any thread.
+     *
+     * @param seconds: a time in the track
+     */
+    void setFocus(double seconds);
+
+    /** @returns: true once the track's length is known, and it can be drawn */
+    bool isPrepared() const;
+
+    /** @returns: true once every chunk is done */
+    bool isComplete() const;
+
+    /** @returns: the length of the track, or 0 until it's prepared */
+    double getLengthInSeconds() const;
+
+    /**
+     * Draws the done part of some pixel columns of the overview, one vertical line per
+     * column from its lowest to its highest peak. Columns with nothing done are left alone.
+     *
+     * @param g: the graphics context to draw with, in its current colour
+     * @param area: where the whole track is drawn
+     * @param columns: the columns of area to draw, from its left edge
+     */
+    void draw(juce::Graphics& g, juce::Rectangle<int> area, juce::Range<int> columns) const;
+
+private:
+    // sized once, before prepared is set, and only read after it has been
+    std::vector<Peak> peaks;
+    std::unique_ptr<std::atomic<bool>[]> chunksDone;
+    int numChunks = 0;
+    double sampleRate = 0;
+    juce::int64 lengthInSamples = 0;
+
+    std::atomic<bool> prepared{ false };
+    std::atomic<int> numChunksDone{ 0 };
+    std::atomic<double> focusSeconds{ 0 };
+
+    /** @returns: the chunk to decode next, or -1 if they're all done */
+    int getNextChunk() const;
+
+    /**
+     * Decodes one chunk into its peaks.
+     *
+     * @param buffer: room for chunkSamples of every channel
+     * @returns: false if the reader failed
+     */
+    bool decodeChunk(juce::AudioFormatReader& reader, juce::AudioBuffer<float>& buffer, int chunk);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(StreamingWaveform)
+};
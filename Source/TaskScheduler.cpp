@@ -0,0 +1,348 @@
+/*
+  ==============================================================================
+
+    TaskScheduler.cpp
+    Created: 20 Oct 2026 12:24:47am
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#include "TaskScheduler.h"
+
+
+// audio loads above which playlist and library tasks wait
+static const double playlistLoadLimit = 0.85;
+static const double libraryLoadLimit = 0.6;
+// a load report older than this is from a device that stopped calling back
+static const juce::uint32 audioLoadTimeoutMs = 250;
+// how often an idle worker looks again, in case a held-back priority was let go
+static const int idleWaitMs = 50;
+// most workers the app starts, leaving the rest of a big machine to the audio and UI
+static const int maxAppWorkers = 8;
+
+static std::atomic<bool> allCoresWanted{ false };
+static std::atomic<int> numSchedulers{ 0 };
+
+
+TaskScheduler::Worker::Worker(TaskScheduler& _owner, int index)
+    : juce::Thread("Background tasks " + juce::String(index + 1)),
+      owner(_owner)
+{
+}
+
+void TaskScheduler::Worker::run()
+{
+    while (!threadShouldExit())
+    {
+        Task task;
+        if (owner.takeTask(*this, task))
+        {
+            owner.runTask(*this, task);
+        }
+        else
+        {
+            owner.workAvailable.wait(idleWaitMs);
+        }
+    }
+}
+
+
+TaskScheduler::TaskScheduler()
+{
+    for (auto& count : numWaiting)
+    {
+        count.store(0);
+    }
+
+    ++numSchedulers;
+
+    // at least two, so library tasks can always leave one free for a deck load
+    const int numCpus = juce::SystemStats::getNumCpus();
+    const int numWorkers = allCoresWanted.load() ? juce::jmax(2, numCpus)
+                                                 : juce::jlimit(2, maxAppWorkers, numCpus - 1);
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        workers.add(new Worker(*this, i))->startThread();
+    }
+}
+
+TaskScheduler::~TaskScheduler()
+{
+    --numSchedulers;
+    shuttingDown.store(true);
+    for (auto* worker : workers)
+    {
+        worker->signalThreadShouldExit();
+        workAvailable.signal();
+    }
+    for (auto* worker : workers)
+    {
+        worker->stopThread(5000);
+    }
+}
+
+void TaskScheduler::submit(Priority priority, const juce::String& group, Work work)
+{
+    Task task;
+    task.priority = priority;
+    task.group = group;
+    task.work = std::move(work);
+    task.cancelled = std::make_shared<std::atomic<bool>>(false);
+
+    // a task queued from a task stays with its worker; anything else is dealt out in turn
+    auto* worker = getCurrentWorker();
+    if (worker == nullptr)
+    {
+        worker = workers.getUnchecked((int)((unsigned int)nextWorker.fetch_add(1) % (unsigned int)workers.size()));
+    }
+    {
+        const juce::ScopedLock sl(worker->lock);
+        worker->queues[priority].push_back(std::move(task));
+    }
+    numWaiting[priority].fetch_add(1);
+    workAvailable.signal();
+}
+
+void TaskScheduler::cancel(const juce::String& group, int waitMs)
+{
+    cancelGroups([&group](const juce::String& taskGroup) { return taskGroup == group; }, waitMs);
+}
+
+void TaskScheduler::cancelAll(const juce::String& groupPrefix, int waitMs)
+{
+    cancelGroups([&groupPrefix](const juce::String& taskGroup) { return taskGroup.startsWith(groupPrefix); }, waitMs);
+}
+
+void TaskScheduler::cancelGroups(const std::function<bool(const juce::String&)>& isCancelled, int waitMs)
+{
+    {
+        const juce::ScopedLock running(runningLock);
+        for (auto* worker : workers)
+        {
+            const juce::ScopedLock sl(worker->lock);
+            for (int priority = 0; priority < numPriorities; ++priority)
+            {
+                auto& queue = worker->queues[priority];
+                for (auto task = queue.begin(); task != queue.end();)
+                {
+                    if (isCancelled(task->group))
+                    {
+                        task = queue.erase(task);
+                        numWaiting[priority].fetch_sub(1);
+                    }
+                    else
+                    {
+                        ++task;
+                    }
+                }
+            }
+            if (worker->runningCancelled != nullptr && isCancelled(worker->runningGroup))
+            {
+                worker->runningCancelled->store(true);
+            }
+        }
+    }
+
+    const auto deadline = juce::Time::getMillisecondCounter() + (juce::uint32)juce::jmax(0, waitMs);
+    while (waitMs > 0 && juce::Time::getMillisecondCounter() < deadline)
+    {
+        bool stillRunning = false;
+        {
+            const juce::ScopedLock running(runningLock);
+            for (auto* worker : workers)
+            {
+                stillRunning = stillRunning || (worker->runningCancelled != nullptr && isCancelled(worker->runningGroup));
+            }
+        }
+        if (!stillRunning)
+        {
+            break;
+        }
+        juce::Thread::sleep(1);
+    }
+}
+
+void TaskScheduler::raisePriority(const juce::String& group, Priority priority)
+{
+    bool moved = false;
+    for (auto* worker : workers)
+    {
+        const juce::ScopedLock sl(worker->lock);
+        for (int lower = priority + 1; lower < numPriorities; ++lower)
+        {
+            auto& queue = worker->queues[lower];
+            for (auto task = queue.begin(); task != queue.end();)
+            {
+                if (task->group == group)
+                {
+                    task->priority = priority;
+                    worker->queues[priority].push_back(std::move(*task));
+                    task = queue.erase(task);
+                    numWaiting[priority].fetch_add(1);
+                    numWaiting[lower].fetch_sub(1);
+                    moved = true;
+                }
+                else
+                {
+                    ++task;
+                }
+            }
+        }
+    }
+    if (moved)
+    {
+        workAvailable.signal();
+    }
+}
+
+void TaskScheduler::reportAudioLoad(double load)
+{
+    audioLoad.store(load, std::memory_order_relaxed);
+    audioLoadTime.store(juce::Time::getMillisecondCounter(), std::memory_order_relaxed);
+}
+
+bool TaskScheduler::waitUntilIdle(int timeoutMs)
+{
+    const auto start = juce::Time::getMillisecondCounter();
+    for (;;)
+    {
+        int outstanding = numRunning.load();
+        for (auto& count : numWaiting)
+        {
+            outstanding += count.load();
+        }
+        if (outstanding == 0)
+        {
+            return true;
+        }
+        if (timeoutMs >= 0 && juce::Time::getMillisecondCounter() - start >= (juce::uint32)timeoutMs)
+        {
+            return false;
+        }
+        juce::Thread::sleep(5);
+    }
+}
+
+int TaskScheduler::getNumWaiting(Priority priority) const
+{
+    return numWaiting[priority].load();
+}
+
+void TaskScheduler::useAllCores()
+{
+    // a scheduler that's already running keeps the workers it started with
+    jassert(numSchedulers.load() == 0);
+    allCoresWanted.store(true);
+}
+
+int TaskScheduler::getNumWorkers() const
+{
+    return workers.size();
+}
+
+bool TaskScheduler::takeTask(Worker& thief, Task& task)
+{
+    const int thiefIndex = workers.indexOf(&thief);
+    for (int priority = 0; priority < numPriorities; ++priority)
+    {
+        if (numWaiting[priority].load() <= 0)
+        {
+            continue;
+        }
+        // anything less urgent than a held-back priority is held back too
+        if (isHeldBack((Priority)priority))
+        {
+            return false;
+        }
+
+        // takes are one at a time, so the count of running library tasks holds until this one's added
+        const juce::ScopedLock running(runningLock);
+        if (priority == libraryPriority && numRunningLibrary.load() >= workers.size() - 1)
+        {
+            return false;
+        }
+
+        // its own queue first, then the others'
+        for (int i = 0; i < workers.size(); ++i)
+        {
+            auto* victim = workers.getUnchecked((thiefIndex + i) % workers.size());
+            const juce::ScopedLock sl(victim->lock);
+            auto& queue = victim->queues[priority];
+            if (!queue.empty())
+            {
+                task = std::move(queue.front());
+                queue.pop_front();
+
+                numRunning.fetch_add(1);
+                if (priority == libraryPriority)
+                {
+                    numRunningLibrary.fetch_add(1);
+                }
+                numWaiting[priority].fetch_sub(1);
+                thief.runningGroup = task.group;
+                thief.runningCancelled = task.cancelled;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool TaskScheduler::isHeldBack(Priority priority) const
+{
+    if (priority == deckLoadPriority
+        || juce::Time::getMillisecondCounter() - audioLoadTime.load(std::memory_order_relaxed) > audioLoadTimeoutMs)
+    {
+        return false;
+    }
+    const double load = audioLoad.load(std::memory_order_relaxed);
+    return load > (priority == playlistPriority ? playlistLoadLimit : libraryLoadLimit);
+}
+
+void TaskScheduler::runTask(Worker& worker, Task& task)
+{
+    // more waiting: wake another worker to take it
+    for (auto& count : numWaiting)
+    {
+        if (count.load() > 0)
+        {
+            workAvailable.signal();
+            break;
+        }
+    }
+
+    auto cancelled = task.cancelled;
+    const std::function<bool()> shouldCancel = [this, cancelled]
+    {
+        return cancelled->load(std::memory_order_relaxed) || shuttingDown.load(std::memory_order_relaxed);
+    };
+    if (!shouldCancel())
+    {
+        task.work(shouldCancel);
+    }
+
+    {
+        const juce::ScopedLock running(runningLock);
+        worker.runningGroup = {};
+        worker.runningCancelled.reset();
+    }
+    if (task.priority == libraryPriority)
+    {
+        numRunningLibrary.fetch_sub(1);
+    }
+    numRunning.fetch_sub(1);
+}
+
+TaskScheduler::Worker* TaskScheduler::getCurrentWorker() const
+{
+    auto* current = juce::Thread::getCurrentThread();
+    for (auto* worker : workers)
+    {
+        if (worker == current)
+        {
+            return worker;
+        }
+    }
+    return nullptr;
+}
@@ -0,0 +1,180 @@
+/*
+  ==============================================================================
+
+    TaskScheduler.h
+    Created: 20 Oct 2026 12:24:47am
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+
+
+/**
+ * Runs the app's background work, such as track analysis, seek indexing and duration
+ * probing, on one set of worker threads shared through a juce::SharedResourcePointer.
+ *
+ * Tasks come in three priorities, and a free worker always takes the most urgent task
+ * waiting. Each worker keeps its own queues, and a worker with nothing of a priority
+ * steals from the others. Library tasks never take the last worker, so a deck load
+ * always finds a worker free. While the audio callback is busy, library tasks are held
+ * back, and playlist tasks too when it's close to its deadline.
+ *
+ * Tasks are grouped, usually by track, so a removed track's work can be cancelled:
+ * waiting tasks are dropped, and running ones see shouldCancel() turn true.
+ */
+class TaskScheduler
+{
+public:
+    /** How urgent a task is, most urgent first */
+    enum Priority
+    {
+        deckLoadPriority = 0,   // a deck is waiting for it
+        playlistPriority,       // it's for a playlist row on screen
+        libraryPriority,        // analysing the library ahead of time
+        numPriorities
+    };
+
+    /** Work to run, given a function that turns true once it's cancelled */
+    using Work = std::function<void(const std::function<bool()>& shouldCancel)>;
+
+    /** Constructor. Starts the workers. */
+    TaskScheduler();
+
+    /**
+     * Makes schedulers created from now on start a worker on every core, with no cap.
+     * For headless work such as the library scan, where there's no audio or UI thread
+     * to leave a core for. Call before anything creates a scheduler.
+     */
+    static void useAllCores();
+
+    /** Destructor. Cancels everything and stops the workers. */
+    ~TaskScheduler();
+
+    /**
+     * Queues a task. Safe to call from any thread but the audio thread.
+     *
+     * @param priority: how urgent it is
+     * @param group: what it's for, to cancel or hurry it along by; usually a file path
+     * @param work: the task
+     */
+    void submit(Priority priority, const juce::String& group, Work work);
+
+    /**
+     * Drops a group's waiting tasks and tells its running ones to stop.
+     *
+     * @param group: the group
+     * @param waitMs: how long to wait for the running ones to return, 0 not to wait
+     */
+    void cancel(const juce::String& group, int waitMs = 0);
+
+    /**
+     * Cancels every group whose name starts with a prefix, in one pass over the queues.
+     *
+     * @param groupPrefix: the start of the groups' names
+     * @param waitMs: how long to wait for the running ones to return, 0 not to wait
+     */
+    void cancelAll(const juce::String& groupPrefix, int waitMs = 0);
+
+    /**
+     * Moves a group's waiting tasks up to a priority, if they're below it.
+     *
+     * @param group: the group
+     * @param priority: the priority they need now
+     */
+    void raisePriority(const juce::String& group, Priority priority);
+
+    /**
+     * Tells the scheduler how loaded the audio callback is. Called on the audio thread
+     * after each block; only stores two atomics. Reports stop counting once they stop
+     * coming, as when the device is closed.
+     *
+     * @param load: the block's processing time as a proportion of its buffer period
+     */
+    void reportAudioLoad(double load);
+
+    /**
+     * Waits until no task is waiting or running.
+     *
+     * @param timeoutMs: longest to wait, or -1 for as long as it takes
+     * @returns: false if it timed out
+     */
+    bool waitUntilIdle(int timeoutMs = -1);
+
+    /** @returns: how many tasks of a priority are waiting */
+    int getNumWaiting(Priority priority) const;
+
+    /** @returns: how many worker threads there are */
+    int getNumWorkers() const;
+
+private:
+    struct Task
+    {
+        Priority priority = libraryPriority;
+        juce::String group;
+        Work work;
+        std::shared_ptr<std::atomic<bool>> cancelled;
+    };
+
+    class Worker : public juce::Thread
+    {
+    public:
+        Worker(TaskScheduler& _owner, int index);
+        void run() override;
+
+        // the worker's own queues, one per priority; other workers steal from them
+        juce::CriticalSection lock;
+        std::deque<Task> queues[numPriorities];
+
+        // the task it's running, guarded by the scheduler's runningLock
+        juce::String runningGroup;
+        std::shared_ptr<std::atomic<bool>> runningCancelled;
+
+    private:
+        TaskScheduler& owner;
+    };
+
+    juce::OwnedArray<Worker> workers;
+    // taken around taking a task off a queue and marking it running, and by cancel(), so a
+    // cancel can't miss a task on its way between the two; always before a worker's lock
+    juce::CriticalSection runningLock;
+    juce::WaitableEvent workAvailable;
+    std::atomic<int> numWaiting[numPriorities];
+    std::atomic<int> numRunning{ 0 };
+    std::atomic<int> numRunningLibrary{ 0 };
+    std::atomic<int> nextWorker{ 0 };   // round robin for tasks submitted from outside the workers
+    std::atomic<bool> shuttingDown{ false };
+
+    std::atomic<double> audioLoad{ 0 };
+    std::atomic<juce::uint32> audioLoadTime{ 0 };
+
+    /**
+     * Takes the most urgent task the audio load allows, from a worker's own queues or
+     * else from another's.
+     *
+     * @param thief: the worker asking
+     * @param task: filled in with the task
+     * @returns: false if there's nothing it may run
+     */
+    bool takeTask(Worker& thief, Task& task);
+
+    /** Cancels the groups a test picks out; see cancel() */
+    void cancelGroups(const std::function<bool(const juce::String&)>& isCancelled, int waitMs);
+
+    /** @returns: true if tasks of a priority must wait for the audio load to drop */
+    bool isHeldBack(Priority priority) const;
+
+    /** Runs a task and clears it off its worker. Worker thread. */
+    void runTask(Worker& worker, Task& task);
+
+    /** @returns: the worker whose thread this is, or nullptr */
+    Worker* getCurrentWorker() const;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TaskScheduler)
+};
@@ -0,0 +1,287 @@
+/*
+  ==============================================================================
+
+    TrackStore.cpp
+    Created: 20 Oct 2026 12:52:18am
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#include "TrackStore.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+
+// shown, and saved, until a track's duration has been read
+static const juce::String pendingDuration{ "..." };
+
+
+TrackStore::TrackStore()
+{
+}
+
+TrackStore::TrackId TrackStore::add(const juce::File& file, float durationSeconds)
+{
+    const auto folder = file.getParentDirectory().getFullPathName();
+    if (!folderIndices.contains(folder))
+    {
+        folderIndices.set(folder, folders.size());
+        folders.add(folder);
+    }
+
+    // the name is stored as UTF-8 and only turned back into a juce::String to be shown
+    const auto fileName = file.getFileName();
+    const char* utf8 = fileName.toRawUTF8();
+    const size_t fileNameLength = juce::jmin(std::strlen(utf8), (size_t)std::numeric_limits<juce::uint16>::max());
+    const size_t nameLength = juce::jmin(std::strlen(file.getFileNameWithoutExtension().toRawUTF8()), fileNameLength);
+
+    ids.push_back(nextId);
+    rowFolders.push_back((juce::uint32)folderIndices[folder]);
+    nameOffsets.push_back((juce::uint32)nameBytes.size());
+    fileNameLengths.push_back((juce::uint16)fileNameLength);
+    nameLengths.push_back((juce::uint16)nameLength);
+    durations.push_back(durationSeconds);
+    nameBytes.insert(nameBytes.end(), utf8, utf8 + fileNameLength);
+
+    return nextId++;
+}
+
+void TrackStore::remove(int row)
+{
+    jassert(row >= 0 && row < size());
+    unusedNameBytes += fileNameLengths[(size_t)row];
+
+    ids.erase(ids.begin() + row);
+    rowFolders.erase(rowFolders.begin() + row);
+    nameOffsets.erase(nameOffsets.begin() + row);
+    fileNameLengths.erase(fileNameLengths.begin() + row);
+    nameLengths.erase(nameLengths.begin() + row);
+    durations.erase(durations.begin() + row);
+
+    if (unusedNameBytes > nameBytes.size() / 2)
+    {
+        compact();
+    }
+}
+
+void TrackStore::clear()
+{
+    folders.clear();
+    folderIndices.clear();
+    ids.clear();
+    rowFolders.clear();
+    nameOffsets.clear();
+    fileNameLengths.clear();
+    nameLengths.clear();
+    durations.clear();
+    nameBytes.clear();
+    unusedNameBytes = 0;
+}
+
+void TrackStore::reserve(int numTracks, int numNameBytes)
+{
+    ids.reserve((size_t)numTracks);
+    rowFolders.reserve((size_t)numTracks);
+    nameOffsets.reserve((size_t)numTracks);
+    fileNameLengths.reserve((size_t)numTracks);
+    nameLengths.reserve((size_t)numTracks);
+    durations.reserve((size_t)numTracks);
+    nameBytes.reserve((size_t)numNameBytes);
+}
+
+int TrackStore::size() const
+{
+    return (int)ids.size();
+}
+
+TrackStore::TrackId TrackStore::getId(int row) const
+{
+    return ids[(size_t)row];
+}
+
+int TrackStore::indexOf(TrackId id) const
+{
+    // rows keep the order they were added in, so the ids are sorted
+    const auto found = std::lower_bound(ids.begin(), ids.end(), id);
+    return (found != ids.end() && *found == id) ? (int)(found - ids.begin()) : -1;
+}
+
+juce::File TrackStore::getFile(int row) const
+{
+    return juce::File(folders[(int)rowFolders[(size_t)row]] + juce::File::getSeparatorString()
+        + juce::String::fromUTF8(getNameBytes(row), fileNameLengths[(size_t)row]));
+}
+
+juce::String TrackStore::getName(int row) const
+{
+    return juce::String::fromUTF8(getNameBytes(row), nameLengths[(size_t)row]);
+}
+
+float TrackStore::getDuration(int row) const
+{
+    return durations[(size_t)row];
+}
+
+void TrackStore::setDuration(int row, float seconds)
+{
+    durations[(size_t)row] = seconds;
+}
+
+bool TrackStore::containsName(const juce::String& name) const
+{
+    const char* utf8 = name.toRawUTF8();
+    const size_t length = std::strlen(utf8);
+    for (int row = 0; row < size(); ++row)
+    {
+        if (nameLengths[(size_t)row] == length && std::memcmp(getNameBytes(row), utf8, length) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+int TrackStore::findName(const juce::String& text, int startRow) const
+{
+    // UTF-8 keeps every character's bytes together, so matching bytes matches characters
+    const char* utf8 = text.toRawUTF8();
+    const char* utf8End = utf8 + std::strlen(utf8);
+    for (int row = juce::jmax(0, startRow); row < size(); ++row)
+    {
+        const char* name = getNameBytes(row);
+        const char* nameEnd = name + nameLengths[(size_t)row];
+        if (std::search(name, nameEnd, utf8, utf8End) != nameEnd || utf8 == utf8End)
+        {
+            return row;
+        }
+    }
+    return -1;
+}
+
+std::vector<int> TrackStore::getRowsSortedByName() const
+{
+    // comparing UTF-8 as unsigned bytes orders it by code point, as juce::String does
+    std::vector<int> rows((size_t)size());
+    for (int row = 0; row < size(); ++row)
+    {
+        rows[(size_t)row] = row;
+    }
+    std::sort(rows.begin(), rows.end(), [this](int a, int b)
+    {
+        const auto* nameA = reinterpret_cast<const unsigned char*>(getNameBytes(a));
+        const auto* nameB = reinterpret_cast<const unsigned char*>(getNameBytes(b));
+        return std::lexicographical_compare(nameA, nameA + nameLengths[(size_t)a], nameB, nameB + nameLengths[(size_t)b]);
+    });
+    return rows;
+}
+
+std::vector<int> TrackStore::getRowsSortedByDuration() const
+{
+    std::vector<int> rows((size_t)size());
+    for (int row = 0; row < size(); ++row)
+    {
+        rows[(size_t)row] = row;
+    }
+    std::stable_sort(rows.begin(), rows.end(), [this](int a, int b)
+    {
+        return durations[(size_t)a] < durations[(size_t)b];
+    });
+    return rows;
+}
+
+size_t TrackStore::getMemoryUsage() const
+{
+    size_t bytes = ids.capacity() * sizeof(TrackId)
+        + rowFolders.capacity() * sizeof(juce::uint32)
+        + nameOffsets.capacity() * sizeof(juce::uint32)
+        + fileNameLengths.capacity() * sizeof(juce::uint16)
+        + nameLengths.capacity() * sizeof(juce::uint16)
+        + durations.capacity() * sizeof(float)
+        + nameBytes.capacity();
+    for (const auto& folder : folders)
+    {
+        bytes += folder.getNumBytesAsUTF8() + 1;
+    }
+    return bytes;
+}
+
+bool TrackStore::loadPlaylist(const juce::File& playlistFile)
+{
+    if (!playlistFile.existsAsFile())
+    {
+        return false;
+    }
+
+    clear();
+    juce::StringArray lines;
+    playlistFile.readLines(lines);
+    reserve(lines.size(), (int)playlistFile.getSize());
+    for (const auto& line : lines)
+    {
+        // the duration never has a comma in it, the path might
+        const int comma = line.lastIndexOfChar(',');
+        if (comma > 0)
+        {
+            add(juce::File(line.substring(0, comma)), parseDuration(line.substring(comma + 1).trim()));
+        }
+    }
+    return true;
+}
+
+bool TrackStore::savePlaylist(const juce::File& playlistFile) const
+{
+    juce::MemoryOutputStream text;
+    for (int row = 0; row < size(); ++row)
+    {
+        text << getFile(row).getFullPathName() << "," << formatDuration(getDuration(row)) << "\n";
+    }
+    return playlistFile.replaceWithText(text.toString(), false, false, "\n");
+}
+
+juce::File TrackStore::getPlaylistFile()
+{
+    return juce::File::getCurrentWorkingDirectory().getChildFile("playlist.csv");
+}
+
+juce::String TrackStore::formatDuration(float seconds)
+{
+    if (seconds == unknownDuration)
+    {
+        return pendingDuration;
+    }
+
+    // find seconds and minutes and make into string
+    const int secondsRounded = juce::roundToInt(seconds);
+    return juce::String(secondsRounded / 60) + ":" + juce::String(secondsRounded % 60).paddedLeft('0', 2);
+}
+
+float TrackStore::parseDuration(const juce::String& text)
+{
+    if (!text.containsChar(':'))
+    {
+        return unknownDuration;
+    }
+    return (float)(text.upToFirstOccurrenceOf(":", false, false).getIntValue() * 60
+        + text.fromFirstOccurrenceOf(":", false, false).getIntValue());
+}
+
+const char* TrackStore::getNameBytes(int row) const
+{
+    return nameBytes.data() + nameOffsets[(size_t)row];
+}
+
+void TrackStore::compact()
+{
+    std::vector<char> packed;
+    packed.reserve(nameBytes.size() - unusedNameBytes);
+    for (int row = 0; row < size(); ++row)
+    {
+        const char* name = getNameBytes(row);
+        nameOffsets[(size_t)row] = (juce::uint32)packed.size();
+        packed.insert(packed.end(), name, name + fileNameLengths[(size_t)row]);
+    }
+    nameBytes.swap(packed);
+    unusedNameBytes = 0;
+}
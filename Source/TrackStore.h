@@ -0,0 +1,174 @@
+/*
+  ==============================================================================
+
+    TrackStore.h
+    Created: 20 Oct 2026 12:52:18am
+    Author:  ventafri
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <vector>
+
+
+/**
+ * The playlist's tracks, kept column by column instead of as one object per track.
+ *
+ * Each folder's path is stored once and tracks refer to it by index, with the file names
+ * packed back to back in one UTF-8 buffer. Durations are plain numbers, formatted only
+ * when they're shown. A track costs a few 32-bit columns plus its file name, against a
+ * Song's separate copies of the path, its URL, its name and its duration text. Searching
+ * and sorting walk contiguous arrays without building any juce::Strings.
+ *
+ * Rows stay in the order tracks were added. Each track also gets a 32-bit id that stays
+ * the same while rows before it are removed, for work that finishes after the playlist
+ * may have changed.
+ *
+ * The store is saved as the playlist file, one "path,m:ss" line per track, which the app
+ * and the command line library scan both read and write.
+ */
+class TrackStore
+{
+public:
+    using TrackId = juce::uint32;
+
+    /** Duration of a track that hasn't been read yet */
+    static constexpr float unknownDuration = -1.0f;
+
+    /** Constructor */
+    TrackStore();
+
+    /**
+     * Adds a track after the last row.
+     *
+     * @param file: the track's file
+     * @param durationSeconds: its duration, or unknownDuration
+     * @returns: the track's id
+     */
+    TrackId add(const juce::File& file, float durationSeconds = unknownDuration);
+
+    /**
+     * Removes a track, moving the rows after it up by one.
+     *
+     * @param row: the track's row
+     */
+    void remove(int row);
+
+    /** Removes every track */
+    void clear();
+
+    /**
+     * Makes room ahead of a big import.
+     *
+     * @param numTracks: tracks to make room for, in all
+     * @param numNameBytes: bytes of file names to make room for, in all
+     */
+    void reserve(int numTracks, int numNameBytes);
+
+    /** @returns: the number of tracks */
+    int size() const;
+
+    /** @returns: a row's id */
+    TrackId getId(int row) const;
+
+    /** @returns: the row of a track, or -1 if it has been removed */
+    int indexOf(TrackId id) const;
+
+    /** @returns: a row's file */
+    juce::File getFile(int row) const;
+
+    /** @returns: a row's name: its file name without the extension */
+    juce::String getName(int row) const;
+
+    /** @returns: a row's duration in seconds, or unknownDuration */
+    float getDuration(int row) const;
+
+    /**
+     * Sets a row's duration.
+     *
+     * @param row: the track's row
+     * @param seconds: its duration
+     */
+    void setDuration(int row, float seconds);
+
+    /** @returns: true if a track has exactly this name */
+    bool containsName(const juce::String& name) const;
+
+    /**
+     * Finds the first track whose name contains some text, case-sensitively.
+     *
+     * @param text: the text to look for
+     * @param startRow: the row to start looking from
+     * @returns: the row, or -1 if none has it
+     */
+    int findName(const juce::String& text, int startRow = 0) const;
+
+    /** @returns: the rows in order of their names, by Unicode code point */
+    std::vector<int> getRowsSortedByName() const;
+
+    /** @returns: the rows from shortest to longest */
+    std::vector<int> getRowsSortedByDuration() const;
+
+    /** @returns: bytes the store holds on the heap, counting what it has reserved */
+    size_t getMemoryUsage() const;
+
+    /**
+     * Replaces the tracks with those in a playlist file.
+     *
+     * @param playlistFile: the file, as written by savePlaylist()
+     * @returns: false if there's no file to read
+     */
+    bool loadPlaylist(const juce::File& playlistFile);
+
+    /**
+     * Writes the tracks to a playlist file.
+     *
+     * @param playlistFile: the file, replaced as a whole
+     * @returns: false if it couldn't be written
+     */
+    bool savePlaylist(const juce::File& playlistFile) const;
+
+    /** @returns: the playlist file the app keeps, in the working directory */
+    static juce::File getPlaylistFile();
+
+    /**
+     * @param seconds: a duration, or unknownDuration
+     * @returns: the duration as minutes:seconds, or "..." if it isn't known
+     */
+    static juce::String formatDuration(float seconds);
+
+    /**
+     * @param text: a duration as formatted by formatDuration()
+     * @returns: the duration in seconds, or unknownDuration if it wasn't known
+     */
+    static float parseDuration(const juce::String& text);
+
+private:
+    // one entry per folder, looked up by path when adding
+    juce::StringArray folders;
+    juce::HashMap<juce::String, int> folderIndices;
+
+    // one entry per row
+    std::vector<TrackId> ids;
+    std::vector<juce::uint32> rowFolders;
+    std::vector<juce::uint32> nameOffsets;
+    std::vector<juce::uint16> fileNameLengths;
+    std::vector<juce::uint16> nameLengths;   // the file name up to its extension
+    std::vector<float> durations;
+
+    // every row's file name, UTF-8, back to back; removed rows leave holes until compact()
+    std::vector<char> nameBytes;
+    size_t unusedNameBytes = 0;
+
+    TrackId nextId = 1;
+
+    /** @returns: a row's name bytes */
+    const char* getNameBytes(int row) const;
+
+    /** Packs the file names again without the holes removed rows left */
+    void compact();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TrackStore)
+};
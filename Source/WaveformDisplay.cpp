@@ -10,94 +10,218 @@
 
 #include "WaveformDisplay.h"
 #include <JuceHeader.h>
+#include "Mp3SeekIndex.h"
 
 
-WaveformDisplay::WaveformDisplay(juce::AudioFormatManager& formatManagerToUse,
-    juce::AudioThumbnailCache& cacheToUse) :  
-    audioThumb(1000, formatManagerToUse, cacheToUse), // 1000 points to build waveplot aka downsampling
+WaveformDisplay::WaveformDisplay(juce::AudioFormatManager& formatManagerToUse) :
+    formatManager(formatManagerToUse),
     fileLoaded(false),
     position(0)
 {
-    audioThumb.addChangeListener(this);
+    setOpaque(true);
 }
 
 WaveformDisplay::~WaveformDisplay()
 {
+    // the decoding reads through the format manager, so it mustn't outlive the deck
+    scheduler->cancel(getStreamingGroup(), 5000);
 }
 
 void WaveformDisplay::paint(juce::Graphics& g)
 {
-    g.fillAll(getLookAndFeel().findColour(juce::ResizableWindow::backgroundColourId));   // clear the background
-
-    g.setColour(juce::Colours::coral); //colour of the wave
-    g.drawRect(getLocalBounds(), 1);   // draw an outline around the component
-    g.setColour(juce::Colours::coral); // colour of box outline
+    // everything but the playhead comes from the cached image, and usually only the
+    // playhead's old and new strips need repainting
+    if (waveformImage.isValid()) {
+        g.drawImageAt(waveformImage, 0, 0);
+    }
+    else {
+        g.fillAll(getLookAndFeel().findColour(juce::ResizableWindow::backgroundColourId));
+    }
 
     if (fileLoaded) {
-        audioThumb.drawChannel(g,   //graphics
-            getLocalBounds(),  //size where to draw
-            0,   // start time
-            audioThumb.getTotalLength(),  //end time
-            0,  // channel
-            1.0f);  //vertical zoom factor 
-
         g.setColour(juce::Colours::coral);
-        if (position > 0 && getWidth() > 0) {
-            g.drawRect(position * getWidth(), 0, getWidth() / 20, getHeight());
-            //check for this to avoid errors
-            DBG("Nothing negative in WaveformDisplay::paint");
-        }
-        else if (position < 0 && getWidth() > 0) {
-
-            DBG("position is negative  in WaveformDisplay::paint ");
-        }
-        else if (position > 0 && getWidth() < 0) {
-            DBG("getWidth() is negative  in WaveformDisplay::paint");
-        }
-        else {
-            //avoid exception
-            g.drawRect(0, 0, getWidth() / 20, getHeight());
-            DBG("both are negative  in WaveformDisplay::paint");
-        }
-    }
-    else {
-        g.setFont(20.0f);
-        g.drawText("Add a track!", getLocalBounds(),
-            juce::Justification::centred, true);   // draw some placeholder text
+        g.drawRect(getPlayheadBounds(), 1);
     }
 }
 
 void WaveformDisplay::resized()
 {
-    // Nothing to add here.
+    renderWaveformImage();
 }
 
 void WaveformDisplay::loadURL(juce::URL audioURL)
 {
-    audioThumb.clear(); //clear previous audio
-    //check if the new audio file is loaded successfully
-    fileLoaded = audioThumb.setSource(new juce::URLInputSource(audioURL));
+    // stop decoding the previous track's peaks; what it already decoded goes with it
+    scheduler->cancel(getStreamingGroup());
+    streamingWaveform.reset();
+    fileLoaded = !audioURL.isEmpty();
+
+    spectralWaveform.reset();
+    loadedURL = audioURL;
+    if (fileLoaded)
+    {
+        startStreaming();
+    }
+    if (fileLoaded && audioURL.isLocalFile())
+    {
+        juce::Component::SafePointer<WaveformDisplay> safeThis(this);
+        spectralCache->request(audioURL.getLocalFile(), formatManager,
+            [safeThis, audioURL](std::shared_ptr<const SpectralWaveform> waveform)
+            {
+                // a different track may have been loaded in the meantime
+                if (safeThis != nullptr && safeThis->loadedURL == audioURL && waveform != nullptr)
+                {
+                    safeThis->spectralWaveform = waveform;
+                    // the peaks are no longer shown, so there's no point decoding the rest
+                    safeThis->scheduler->cancel(safeThis->getStreamingGroup());
+                    safeThis->streamingWaveform.reset();
+                    safeThis->renderWaveformImage();
+                    safeThis->repaint();
+                }
+            });
+    }
+
+    renderWaveformImage();
+    repaint();
 
     if (fileLoaded) {
         DBG("File was loaded successfully");
-        // paint waveform 
-        repaint();
     }
     else {
         DBG("File was not loaded");
     }
 }
 
-void WaveformDisplay::changeListenerCallback(juce::ChangeBroadcaster* source)
+void WaveformDisplay::renderWaveformImage()
 {
-    repaint();
+    if (getWidth() <= 0 || getHeight() <= 0)
+    {
+        waveformImage = {};
+        return;
+    }
+
+    waveformImage = juce::Image(juce::Image::RGB, getWidth(), getHeight(), false);
+    juce::Graphics g(waveformImage);
+    g.fillAll(getLookAndFeel().findColour(juce::ResizableWindow::backgroundColourId));   // clear the background
+    g.setColour(juce::Colours::coral);
+
+    if (spectralWaveform != nullptr)
+    {
+        spectralWaveform->draw(g, getLocalBounds(), 0, spectralWaveform->getLengthInSeconds());
+    }
+    else if (fileLoaded)
+    {
+        if (streamingWaveform != nullptr)
+        {
+            streamingWaveform->draw(g, getLocalBounds(), { 0, getWidth() });   // whatever has been decoded so far
+        }
+    }
+    else
+    {
+        g.setFont(20.0f);
+        g.drawText("Add a track!", getLocalBounds(),
+            juce::Justification::centred, true);   // draw some placeholder text
+    }
+
+    g.setColour(juce::Colours::coral);
+    g.drawRect(getLocalBounds(), 1);   // draw an outline around the component
+}
+
+juce::Rectangle<int> WaveformDisplay::getPlayheadBounds() const
+{
+    return { juce::roundToInt(juce::jmax(0.0, position) * getWidth()), 0, getWidth() / 20, getHeight() };
+}
+
+void WaveformDisplay::renderColumns(juce::Range<int> columns)
+{
+    if (!waveformImage.isValid() || streamingWaveform == nullptr || columns.isEmpty())
+    {
+        return;
+    }
+
+    juce::Graphics g(waveformImage);
+    g.reduceClipRegion(columns.getStart(), 0, columns.getLength(), getHeight());
+    g.fillAll(getLookAndFeel().findColour(juce::ResizableWindow::backgroundColourId));
+    g.setColour(juce::Colours::coral);
+    streamingWaveform->draw(g, getLocalBounds(), columns);
+    g.drawRect(getLocalBounds(), 1);
+}
+
+void WaveformDisplay::startStreaming()
+{
+    auto waveform = std::make_shared<StreamingWaveform>();
+    streamingWaveform = waveform;
+
+    juce::Component::SafePointer<WaveformDisplay> safeThis(this);
+    juce::AudioFormatManager& formats = formatManager;
+    const juce::URL audioURL = loadedURL;
+    scheduler->submit(TaskScheduler::deckLoadPriority, getStreamingGroup(),
+        [safeThis, waveform, audioURL, &formats](const std::function<bool()>& shouldCancel)
+        {
+            // an MP3 is read through its seek index, as the deck reads it, so starting
+            // from the playhead costs no more than starting from the top
+            std::unique_ptr<juce::AudioFormatReader> reader;
+            if (audioURL.isLocalFile())
+            {
+                reader.reset(IndexedMp3Reader::create(audioURL.getLocalFile(), formats));
+            }
+            if (reader == nullptr)
+            {
+                reader.reset(formats.createReaderFor(audioURL.createInputStream(false)));
+            }
+            if (reader == nullptr)
+            {
+                return;
+            }
+
+            waveform->decode(*reader, shouldCancel, [safeThis, waveform](juce::Range<double> seconds)
+            {
+                juce::MessageManager::callAsync([safeThis, waveform, seconds]
+                {
+                    if (safeThis != nullptr)
+                    {
+                        safeThis->chunkDecoded(waveform, seconds);
+                    }
+                });
+            });
+        });
+}
+
+void WaveformDisplay::chunkDecoded(const std::shared_ptr<StreamingWaveform>& waveform, juce::Range<double> seconds)
+{
+    // a different track may have been loaded since, and the colour waveform replaces the peaks
+    const double length = waveform->getLengthInSeconds();
+    if (waveform != streamingWaveform || spectralWaveform != nullptr || length <= 0)
+    {
+        return;
+    }
+
+    // only the pixel columns the chunk covers are drawn again, and only they are repainted
+    const int start = (int)std::floor(seconds.getStart() / length * getWidth());
+    const int end = juce::jmin(getWidth(), (int)std::ceil(seconds.getEnd() / length * getWidth()));
+    const juce::Range<int> columns(start, juce::jmax(start, end));
+    renderColumns(columns);
+    repaint(columns.getStart(), 0, columns.getLength(), getHeight());
+}
+
+juce::String WaveformDisplay::getStreamingGroup() const
+{
+    return "overview|" + juce::String::toHexString((juce::pointer_sized_int)this);
 }
 
 void WaveformDisplay::setPositionRelative(double pos)
 {
-    //only repaint if the position has changed
+    //only repaint if the playhead has moved, and only where it was and where it is now
     if (pos != position) {
+        const auto oldBounds = getPlayheadBounds();
         position = pos; 
-        repaint();
+        if (streamingWaveform != nullptr && !streamingWaveform->isComplete()) {
+            streamingWaveform->setFocus(pos * streamingWaveform->getLengthInSeconds());
+        }
+        const auto newBounds = getPlayheadBounds();
+        if (newBounds != oldBounds) {
+            repaint(oldBounds);
+            repaint(newBounds);
+        }
     }
 }
\ No newline at end of file
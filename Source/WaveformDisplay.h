@@ -10,60 +10,94 @@
 
 #pragma once
 #include <JuceHeader.h>
+#include "SpectralWaveform.h"
+#include "StreamingWaveform.h"
+#include "TaskScheduler.h"
 
 
-class WaveformDisplay : public juce::Component,
-    public juce::ChangeListener
+class WaveformDisplay : public juce::Component
 {
 public:
     /**
      * Constructor. draws a waveform based on the audio file's properties.
      *
      * @param formatManagerToUse: An instance of the juce::AudioFormatManager to use for this
-     * @param cacheToUse: The current cache loaded from the audio file
      */
-    WaveformDisplay(juce::AudioFormatManager& formatManagerToUse,
-        juce::AudioThumbnailCache& cacheToUse);
+    WaveformDisplay(juce::AudioFormatManager& formatManagerToUse);
 
     /**
-     * Destructor.
+     * Destructor. Stops decoding the track's peaks.
      */
     ~WaveformDisplay() override;
 
     /**
-     * Paints colours, fonts, background. Evrything that can be done with the Graphics class.
+     * Paints the cached waveform image and the playhead over it.
      */
     void paint(juce::Graphics&) override;
 
     /**
-     * Sets the bounds and sizes of each component inside PlaylistComponent.
+     * Redraws the cached waveform image at the new size.
      */
     void resized() override;
 
-    /**
-     * Repaints.
-     * 
-     * @param source: Holds a list of ChangeListeners, and sends messages to them when instructed. 
-     */
-    void changeListenerCallback(juce::ChangeBroadcaster* source) override;
-
     /**
      * Loads the URL that is passed to this function and uses it to paint the waveform.
+     * The peaks fill in as they decode, from the start of the track or wherever the
+     * playhead is moved to meanwhile.
+     *
      * @param audioURL of the file to display waveform of
      */
     void loadURL(juce::URL audioURL);
 
     /**
      * Changes the relative position of the playhead, i.e. the waveform rectangle which tracks the position of current song.
+     * Peaks still decoding are decoded from there on first.
      *
      * @param pos: the relative position
      */
     void setPositionRelative(double pos);
 
 private:
-    juce::AudioThumbnail audioThumb;
+    juce::AudioFormatManager& formatManager;
     bool fileLoaded;
     double position;
 
+    // colour waveform, analysed in the background; the plain peaks are shown until it's ready,
+    // each part as soon as it's decoded. Either is drawn into waveformImage, so moving the
+    // playhead only blits it
+    juce::SharedResourcePointer<SpectralWaveformCache> spectralCache;
+    juce::SharedResourcePointer<TaskScheduler> scheduler;
+    std::shared_ptr<const SpectralWaveform> spectralWaveform;
+    std::shared_ptr<StreamingWaveform> streamingWaveform;
+    juce::URL loadedURL;
+    juce::Image waveformImage;
+
+    /** Starts decoding the loaded track's peaks on the scheduler */
+    void startStreaming();
+
+    /**
+     * Draws the newly decoded part of the peaks into waveformImage and repaints it.
+     *
+     * @param waveform: the peaks it was decoded into
+     * @param seconds: the part of the track just decoded
+     */
+    void chunkDecoded(const std::shared_ptr<StreamingWaveform>& waveform, juce::Range<double> seconds);
+
+    /** Draws everything but the playhead into waveformImage at the component's size */
+    void renderWaveformImage();
+
+    /**
+     * Draws some columns of waveformImage again.
+     *
+     * @param columns: the columns, from the left edge
+     */
+    void renderColumns(juce::Range<int> columns);
+
+    /** @returns: the scheduler group this display's peaks decode in */
+    juce::String getStreamingGroup() const;
+
+    /** @returns: the area the playhead covers at the current position */
+    juce::Rectangle<int> getPlayheadBounds() const;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WaveformDisplay)
 };
\ No newline at end of file